@@ -1,42 +1,75 @@
 #include "cartridge.h"
 #include <gameboy.h>
+#include <cstdlib>
+#include <cstring>
 
 Cartridge::~Cartridge()
 {
     delete mbc;
 }
 
-bool Cartridge::load_rom(const std::string& path)
+RomImage::RomImage() : data(static_cast<uint8_t*>(calloc(ROM_SPACE, 1)))
 {
-    memset(data, 0, sizeof(data));
-    memset(memory, 0, sizeof(memory));
+}
+
+RomImage::~RomImage()
+{
+    free(data);
+}
 
+std::shared_ptr<RomImage> RomImage::load(const std::string& path)
+{
     FILE* in = fopen(path.c_str(), "rb");
-    fread(data, 1, 0x200000, in);
+    if (!in) return nullptr;
+
+    auto image = std::make_shared<RomImage>();
+    if (!image->data) { // Out of memory for ROM_SPACE
+        fclose(in);
+        return nullptr;
+    }
+
+    image->size = TU32(fread(image->data, 1, ROM_SPACE, in));
     fclose(in);
 
-    Logger& log = mmu->gb->logger;
+    return image;
+}
+
+bool Cartridge::load_rom(std::shared_ptr<RomImage> image)
+{
+    memset(memory, 0, sizeof(memory));
+
+    rom = std::move(image);
+    data = rom->data;
+    rom_size = rom->size;
+
+    rom_hash = 0xCBF29CE484222325ull;
+    for (uint32_t i = 0; i < rom_size; i++) {
+        rom_hash ^= data[i];
+        rom_hash *= 0x100000001B3ull;
+    }
+
+    GameBoy* gb = mmu->gb;
 
     char title[16]; std::copy(data + 0x0134, data + 0x0144, title);
-    log.log("%s: %s\n", "Rom Title", title);
+    gb->log("%s: %s\n", "Rom Title", title);
 
     uint8_t banking_type = data[0x147];
     if (banking_type == 0) banking = Banking::None;
     else if (banking_type == 1 || banking_type == 2 || banking_type == 3) banking = Banking::MBC1;
 
-    log.log("%s: %d\n", "Banking Type", banking_type);
+    gb->log("%s: %d\n", "Banking Type", banking_type);
 
     uint8_t ram_type = data[0x149];
     if (ram_type == 0) ram_size = 0;
     else if (ram_type == 1) ram_size = 2048;
     else if (ram_type == 2) ram_size = 8192;
 
-    log.log("%s: %d\n", "Ram Size", ram_size);
+    gb->log("%s: %d\n", "Ram Size", ram_size);
 
     const char* region = "Japan";
     if (data[0x014A]) region = "Global";
 
-    log.log("%s: %s\n", "Region", region);
+    gb->log("%s: %s\n", "Region", region);
 
     if (banking == Banking::None) {
         mbc = new MBCNone(this);
@@ -89,8 +122,10 @@ uint8_t& Cartridge::get(uint16_t addr)
 
 void Cartridge::write(uint16_t addr, uint8_t data)
 {
-    if (addr < 0x8000)    
-        mbc->handle_banking(addr, data);   
+    if (addr < 0x8000) {
+        mbc->handle_banking(addr, data);
+        mmu->map_pages();
+    }
     else if (addr >= 0xA000 && addr < 0xC000) {
         if (memory_enabled) {
             uint32_t address = addr - 0xA000;
@@ -1,6 +1,4 @@
 #pragma once
-#include <iostream>
-#include <fstream>
 #include <string>
 #include <vector>
 #include <memory>
@@ -13,6 +11,19 @@ using std::vector;
 #define CAST(to, source) static_cast<to>(source)
 #define RCAST(to, source) reinterpret_cast<to>(source)
 
+#define ROM_SPACE 0x200000 // Largest rom the MBCs can address
+
+// Contents of a rom file, shared by every cartridge running it and never written once loaded
+struct RomImage {
+	RomImage();
+	~RomImage();
+
+	static std::shared_ptr<RomImage> load(const std::string& path); // nullptr when the file cannot be read or the image allocated
+
+	uint8_t* data; // ROM_SPACE bytes or nullptr when calloc failed, zero past the file. Pages the file does not reach are never touched
+	uint32_t size = 0;
+};
+
 enum class Banking{
 	MBC1, 
 	MBC2,
@@ -25,7 +36,7 @@ public:
 	Cartridge(MMU* _mmu) : mmu(_mmu) {}
 	~Cartridge();
 
-	bool load_rom(const std::string& file);
+	bool load_rom(std::shared_ptr<RomImage> image);
 	bool has_ram() { return ram_size != 0; }
 
 	uint8_t read(uint16_t addr);
@@ -42,9 +53,11 @@ public:
 	
 	uint32_t rom_size = 0;
 	uint32_t ram_size = 0;
+	uint64_t rom_hash = 0; // FNV-1a over the rom as read from the file, tells revisions apart
 
-	uint8_t data[0x200000];
-	uint8_t memory[0x8000];
+	std::shared_ptr<RomImage> rom;
+	uint8_t* data = nullptr; // rom->data
+	uint8_t memory[0x8000] = {};
 
 	bool loaded = false;
 	bool memory_enabled = false;
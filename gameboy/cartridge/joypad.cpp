@@ -5,6 +5,10 @@
 void Joypad::init(MMU* _mmu)
 {
 	mmu = _mmu;
+
+	mmu->register_io(JOYPAD, [this](uint16_t) { return read(); }, [this](uint16_t address, uint8_t data) {
+		mmu->memory[address] = data & 0x30; // Only the select lines are writable
+	});
 }
 
 void Joypad::key_pressed(Key key)
@@ -51,6 +55,16 @@ void Joypad::key_released(Key key)
 	else joypad_buttons = joypad;
 }
 
+void Joypad::apply(const State& state)
+{
+	for (int key = Key_A; key <= Key_Right; key++) {
+		uint8_t keys = key >= Key_Up ? state.arrows : state.buttons;
+
+		if (CPU::get_bit(keys, get_key(Key(key)))) key_released(Key(key));
+		else key_pressed(Key(key));
+	}
+}
+
 int Joypad::get_key(Key key)
 {
 	if (key == Key_Down || key == Key_Start)
@@ -1,6 +1,5 @@
 #pragma once
 #include <cstdint>
-#include <SFML/Window/Keyboard.hpp>
 
 #define JOYPAD 0xFF00
 
@@ -29,6 +28,14 @@ public:
 	int get_key(Key key);
 	uint8_t read() const;
 
+	struct State {
+		uint8_t arrows, buttons;
+	};
+
+	State save_state() const { return { joypad_arrows, joypad_buttons }; }
+	void load_state(const State& state) { joypad_arrows = state.arrows; joypad_buttons = state.buttons; }
+	void apply(const State& state); // Presses and releases whatever differs, interupts included
+
 protected:
 	MMU* mmu;
 
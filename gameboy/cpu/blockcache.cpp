@@ -0,0 +1,225 @@
+#include "blockcache.h"
+#include <cpu/mmu.h>
+#include <cartridge/cartridge.h>
+#include <algorithm>
+
+static constexpr size_t MAX_BLOCKS = 0x4000; // Everything is dropped past this, invalidated blocks pile up otherwise
+static constexpr size_t MAX_BLOCK_INSTRUCTIONS = 64;
+
+// Bytes taken by each base opcode, including the immediates
+const uint8_t BlockCache::opcode_length[256] = {
+    1, 3, 1, 1, 1, 1, 2, 1, 3, 1, 1, 1, 1, 1, 2, 1,
+    1, 3, 1, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 2, 1,
+    2, 3, 1, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 2, 1,
+    2, 3, 1, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 2, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 3, 3, 3, 1, 2, 1, 1, 1, 3, 2, 3, 3, 2, 1,
+    1, 1, 3, 1, 3, 1, 2, 1, 1, 1, 3, 1, 3, 1, 2, 1,
+    2, 1, 1, 1, 1, 1, 2, 1, 2, 1, 3, 1, 1, 1, 2, 1,
+    2, 1, 1, 1, 1, 1, 2, 1, 2, 1, 3, 1, 1, 1, 2, 1
+};
+
+// Jumps, calls, returns, HALT/STOP and EI/DI end a block
+bool BlockCache::ends_block(uint8_t op)
+{
+    switch (op) {
+    case 0x10: case 0x18: case 0x20: case 0x28: case 0x30: case 0x38: case 0x76:
+    case 0xC0: case 0xC2: case 0xC3: case 0xC4: case 0xC7: case 0xC8: case 0xC9:
+    case 0xCA: case 0xCC: case 0xCD: case 0xCF: case 0xD0: case 0xD2: case 0xD4:
+    case 0xD7: case 0xD8: case 0xD9: case 0xDA: case 0xDC: case 0xDF: case 0xE7:
+    case 0xE9: case 0xEF: case 0xF3: case 0xF7: case 0xFB: case 0xFF:
+        return true;
+    default:
+        return false;
+    }
+}
+
+
+BlockCache::BlockCache(CPU* _cpu) : cpu(_cpu)
+{
+    rom0 = std::make_unique<DecodedBlock*[]>(0x4000);
+    wram = std::make_unique<DecodedBlock*[]>(0x2000);
+    hram = std::make_unique<DecodedBlock*[]>(0x7F);
+    romx.resize(256);
+
+    // Any cartridge write may be a bank switch
+    std::fill(code_pages, code_pages + 0x80, 1);
+}
+
+const DecodedInstruction* BlockCache::next(uint16_t pc)
+{
+    if (block && block->valid) {
+        if (index < block->instructions.size()) {
+            const DecodedInstruction& instr = block->instructions[index];
+
+            if (instr.pc == pc) {
+                index++;
+                return &instr;
+            }
+        }
+        else {
+            for (DecodedBlock* successor : block->successors) {
+                if (successor && successor->valid && successor->instructions[0].pc == pc && successor->bank == bank_of(pc)) {
+                    block = successor;
+                    index = 1;
+
+                    return &block->instructions[0];
+                }
+            }
+        }
+    }
+
+    if (!enabled || !cpu->mmu->memory[BOOTING]) {
+        block = nullptr;
+        return nullptr;
+    }
+
+    if (blocks.size() >= MAX_BLOCKS)
+        flush();
+
+    // Chain the block that just ran to whatever comes next
+    DecodedBlock* previous = block && block->valid && index == block->instructions.size() ? block : nullptr;
+
+    DecodedBlock** entry = slot(pc);
+    if (entry && !*entry) *entry = decode(pc);
+
+    block = entry ? *entry : nullptr;
+    if (!block) return nullptr;
+
+    if (previous) {
+        previous->successors[1] = previous->successors[0];
+        previous->successors[0] = block;
+    }
+
+    index = 1;
+    return &block->instructions[0];
+}
+
+void BlockCache::flush()
+{
+    std::fill(rom0.get(), rom0.get() + 0x4000, nullptr);
+    std::fill(wram.get(), wram.get() + 0x2000, nullptr);
+    std::fill(hram.get(), hram.get() + 0x7F, nullptr);
+
+    for (auto& table : romx)
+        table.reset();
+
+    blocks.clear();
+    block = nullptr;
+
+    std::fill(code_pages + 0x80, code_pages + 0x100, 0);
+    cpu->mmu->map_pages();
+}
+
+void BlockCache::on_write(uint16_t addr)
+{
+    if (addr < 0x8000) { // MBC register, look the next block up again in case the bank changed
+        block = nullptr;
+        return;
+    }
+
+    if (addr >= 0xFF00 && (addr < 0xFF80 || addr == 0xFFFF))
+        return; // I/O registers share the page with HRAM
+
+    uint16_t page = addr & 0xFF00;
+    for (uint32_t a = page; a < page + 0x100u; a++) {
+        DecodedBlock** entry = slot(TU16(a));
+
+        if (entry && *entry) {
+            (*entry)->valid = false;
+            *entry = nullptr;
+        }
+    }
+
+    code_pages[addr >> 8] = 0;
+    cpu->mmu->map_page(addr >> 8);
+}
+
+DecodedBlock** BlockCache::slot(uint16_t addr)
+{
+    if (addr < 0x4000)
+        return &rom0[addr];
+
+    if (addr < 0x8000) {
+        auto& table = romx[cpu->mmu->cartridge->current_rom_bank];
+        if (!table) table = std::make_unique<DecodedBlock*[]>(0x4000);
+
+        return &table[addr - 0x4000];
+    }
+
+    if (addr >= 0xC000 && addr < 0xE000)
+        return &wram[addr - 0xC000];
+    if (addr >= 0xFF80 && addr < 0xFFFF)
+        return &hram[addr - 0xFF80];
+
+    return nullptr;
+}
+
+uint8_t BlockCache::bank_of(uint16_t addr)
+{
+    return addr >= 0x4000 && addr < 0x8000 ? cpu->mmu->cartridge->current_rom_bank : 0;
+}
+
+DecodedBlock* BlockCache::decode(uint16_t addr)
+{
+    // Blocks never cross a bank or, in RAM, a page so invalidation stays per page
+    uint32_t limit = 0;
+    if (addr < 0x4000) limit = 0x4000;
+    else if (addr < 0x8000) limit = 0x8000;
+    else if (addr >= 0xFF80) limit = 0xFFFF;
+    else limit = (addr & 0xFF00) + 0x100;
+
+    auto decoded = std::make_unique<DecodedBlock>();
+    decoded->bank = bank_of(addr);
+
+    uint32_t current = addr;
+    while (decoded->instructions.size() < MAX_BLOCK_INSTRUCTIONS) {
+        uint8_t op = cpu->mmu->read(TU16(current));
+
+        uint32_t length = opcode_length[op];
+        if (current + length > limit) break;
+
+        DecodedInstruction instr;
+        instr.pc = TU16(current);
+
+        if (op == 0xCB) {
+            uint8_t code = cpu->mmu->read(TU16(current + 1));
+
+            instr.exec = cpu->cb_lookup[code].exec;
+            instr.cycles = cpu->cb_lookup[code].cycles;
+            instr.opcode = CPU::combine(code, 0xCB);
+            instr.prefix = 2;
+        }
+        else {
+            instr.exec = cpu->lookup[op].exec;
+            instr.cycles = cpu->lookup[op].cycles;
+            instr.opcode = op;
+
+            for (uint32_t i = 1; i < length; i++)
+                instr.operands[i - 1] = cpu->mmu->read(TU16(current + i));
+        }
+
+        decoded->instructions.push_back(instr);
+        current += length;
+
+        if (ends_block(op)) break;
+    }
+
+    if (decoded->instructions.empty())
+        return nullptr;
+
+    if (addr >= 0x8000) {
+        code_pages[addr >> 8] = 1;
+        cpu->mmu->map_page(addr >> 8); // Writes to it have to come through on_write
+    }
+
+    blocks.push_back(std::move(decoded));
+    return blocks.back().get();
+}
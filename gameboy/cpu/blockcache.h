@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class CPU;
+using Opcode = int (CPU::*)();
+
+// Guest instruction decoded once, the handler takes its operands from here instead of the MMU
+struct DecodedInstruction {
+	Opcode exec = nullptr;
+	uint16_t pc = 0, opcode = 0;
+	uint8_t cycles = 0;
+	uint8_t prefix = 1; // Opcode bytes, 2 for CB
+	uint8_t operands[2] = {};
+};
+
+struct DecodedBlock {
+	std::vector<DecodedInstruction> instructions;
+	DecodedBlock* successors[2] = {}; // Blocks that followed this one, most recent first
+	uint8_t bank = 0;
+	bool valid = true;
+};
+
+class BlockCache {
+public:
+	BlockCache(CPU* _cpu);
+
+	const DecodedInstruction* next(uint16_t pc); // nullptr when pc is outside the cacheable regions
+	void flush();
+
+	void on_write(uint16_t addr); // Writes into pages flagged in code_pages
+
+	static const uint8_t opcode_length[256];
+	static bool ends_block(uint8_t op);
+
+private:
+	DecodedBlock** slot(uint16_t addr);
+	DecodedBlock* decode(uint16_t addr);
+	uint8_t bank_of(uint16_t addr);
+
+public:
+	bool enabled = true;
+
+	// One flag per 256 byte page, set for the cartridge and for RAM pages that hold decoded code
+	uint8_t code_pages[256] = {};
+
+private:
+	CPU* cpu;
+
+	// Direct mapped block tables: rom bank 0, one table per switchable bank, WRAM and HRAM
+	std::unique_ptr<DecodedBlock*[]> rom0, wram, hram;
+	std::vector<std::unique_ptr<DecodedBlock*[]>> romx;
+	std::vector<std::unique_ptr<DecodedBlock>> blocks;
+
+	DecodedBlock* block = nullptr; // Block being executed, index is its next instruction
+	size_t index = 0;
+};
@@ -1,6 +1,9 @@
 #include "cpu.h"
-#include <SFML/Window/Keyboard.hpp>
 #include <cpu/mmu.h>
+#include <gameboy.h>
+#include <iomanip>
+#include <sstream>
+#include <utility>
 
 #pragma warning(disable : 26812)
 #pragma warning(disable : 26495)
@@ -98,15 +101,12 @@ inline uint16_t Register::get()
 }
 
 CPU::CPU(MMU* _mmu) : mmu(_mmu),
-   cpu_timer(_mmu)
+   cpu_timer(_mmu), block_cache(this), dynarec(this)
 {
-    std::cout.sync_with_stdio(false);
-
     af.h = 0; bc.h = 0; de.h = 0; hl.h = 0;
     af.l = 0; bc.l = 0; de.l = 0; hl.l = 0;
 
     this->register_opcodes();
-    out.open("log.txt", std::ofstream::out | std::ofstream::app);
 }
 
 void CPU::set_bit(uint8_t& num, int b, bool v)
@@ -145,6 +145,8 @@ uint8_t CPU::get_low_byte(uint16_t& val)
 
 void CPU::set_flag(Flag f, bool val)
 {
+    resolve_flags();
+
     uint8_t flags = af.l;
     set_bit(flags, f, val);
     af.l = flags;
@@ -152,10 +154,118 @@ void CPU::set_flag(Flag f, bool val)
 
 bool CPU::get_flag(Flag f)
 {
+    resolve_flags();
+
     uint8_t flags = af.l;
     return (flags & (1 << f));
 }
 
+// Cheaper than get_flag(Z) for conditional jumps, leaves the other flags pending
+bool CPU::zero_flag()
+{
+    if (lazy_flags.pending)
+        return (lazy_flags.result & 0xFF) == 0;
+
+    return get_bit(af.l, Z);
+}
+
+// Same for C, also used as the carry in of ADC/SBC and the carry kept by INC/DEC
+bool CPU::carry_flag()
+{
+    if (lazy_flags.pending)
+        return lazy_flags.result & 0x100;
+
+    return get_bit(af.l, C);
+}
+
+void CPU::set_flags(bool z, bool n, bool h, bool c)
+{
+    lazy_flags.pending = false; // All four are overwritten, nothing to resolve
+    af.l = (af.l & 0x0F) | (z << Z) | (n << N) | (h << H) | (c << C);
+}
+
+void CPU::defer_flags(uint16_t result, uint8_t operands, bool subtract)
+{
+    lazy_flags = { true, subtract, operands, result };
+
+#if !LAZY_FLAGS
+    resolve_flags();
+#endif
+}
+
+void CPU::resolve_flags()
+{
+    if (lazy_flags.pending)
+        materialise_flags();
+}
+
+void CPU::materialise_flags()
+{
+    const LazyFlags& lf = lazy_flags;
+
+    bool z = (lf.result & 0xFF) == 0;
+    bool h = (lf.operands ^ lf.result) & 0x10;
+    bool c = lf.result & 0x100;
+
+    set_flags(z, lf.subtract, h, c);
+}
+
+void CPU::alu_add(uint8_t value, bool carry)
+{
+    uint16_t result = af.h + value + carry;
+
+    defer_flags(result, af.h ^ value, false);
+    af.h = TU8(result);
+}
+
+void CPU::alu_sub(uint8_t value, bool carry)
+{
+    uint16_t result = af.h - value - carry; // A borrow wraps around and sets bit 8
+
+    defer_flags(result, af.h ^ value, true);
+    af.h = TU8(result);
+}
+
+void CPU::alu_cp(uint8_t value)
+{
+    uint16_t result = af.h - value;
+    defer_flags(result, af.h ^ value, true);
+}
+
+void CPU::alu_and(uint8_t value)
+{
+    af.h &= value;
+    defer_flags(af.h, af.h ^ 0x10, false); // H is always set
+}
+
+void CPU::alu_or(uint8_t value)
+{
+    af.h |= value;
+    defer_flags(af.h, af.h, false);
+}
+
+void CPU::alu_xor(uint8_t value)
+{
+    af.h ^= value;
+    defer_flags(af.h, af.h, false);
+}
+
+uint8_t CPU::alu_inc(uint8_t value)
+{
+    uint8_t result = value + 1;
+
+    defer_flags(result | (carry_flag() << 8), value ^ 1, false); // C is left untouched
+    return result;
+}
+
+uint8_t CPU::alu_dec(uint8_t value)
+{
+    uint8_t result = value - 1;
+
+    defer_flags(result | (carry_flag() << 8), value ^ 1, true);
+    return result;
+}
+
 void CPU::reset()
 {
     af = 0x0000;
@@ -167,37 +277,70 @@ void CPU::reset()
 
     opcode = 0x0000;
     cycles = 0;
+
+    lazy_flags = LazyFlags();
 }
 
-uint32_t CPU::tick()
-{    
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::L)) {
-        out << to_hex(pc) << " | " << get_flag(Z) << ' ' << get_flag(N);
-        out << ' ' << get_flag(H) << ' ' << get_flag(C) << " AF: ";
-        out << to_hex(af.get()) << " BC: " << to_hex(bc.get());
-        out << " DE: " << to_hex(de.get()) << " HL: " << to_hex(hl.get()) << ' ' << (int)mmu->read(LY) <<'\n';
+void CPU::trace(bool interrupt)
+{
+    resolve_flags();
+
+    uint16_t cycle = TU16(mmu->gb->scheduler.now & 0x7FFF);
+    if (interrupt) cycle |= TRACE_INTERRUPT;
+
+    tracer.record({ pc, af.get(), bc.get(), de.get(), hl.get(), sp, mmu->read(pc), mmu->memory[LY], cycle });
+}
+
+void CPU::set_tracing(bool enabled)
+{
+    if (enabled == tracing) return;
+
+    if (enabled) tracing = tracer.start("trace.bin", mmu->gb->scheduler.now);
+    else {
+        tracing = false;
+        tracer.stop();
     }
+}
+
+uint32_t CPU::tick()
+{
+    if (tracing) trace();
 
     if (halted) return 1;
     if (pc == 0x00FA) pc = 0x00FC; // Bypass nintendo check
 
+    if (const DecodedInstruction* decoded = block_cache.next(pc)) { // Cached, skips fetch and decode
+        opcode = decoded->opcode;
+        operand = decoded->operands;
+        pc += decoded->prefix;
+
+        cycles = decoded->cycles;
+        cycles += (this->*decoded->exec)();
+
+        operand = nullptr;
+        return cycles;
+    }
+
     opcode = mmu->read(pc++);  // Fetch
+    const Instruction* instr = &lookup[opcode]; // Decode
 
     if (opcode == 0xCB) {  // Handle 0xCB prefix
-        opcode = combine(mmu->read(pc++), 0xCB);
-    }        
+        uint8_t code = mmu->read(pc++);
 
-    Instruction instr = lookup[opcode]; // Decode
+        opcode = combine(code, 0xCB);
+        instr = &cb_lookup[code];
+    }
 
-    cycles = instr.cycles; // Cycles required
-    cycles += instr.exec(); // Execute (may require extra cycles for instructions like jp with condition)    
+    cycles = instr->cycles; // Cycles required
+    cycles += (this->*instr->exec)(); // Execute (may require extra cycles for instructions like jp with condition)
 
     return cycles;
 }
 
-void CPU::update_timers(uint32_t cycle)
+uint8_t CPU::fetch()
 {
-    cpu_timer.update(cycle);
+    uint16_t address = pc++;
+    return operand ? *operand++ : mmu->read(address);
 }
 
 void CPU::interupt(uint32_t id)
@@ -212,10 +355,10 @@ void CPU::interupt(uint32_t id)
 void CPU::handle_interupts()
 {   
     if (interupts_enabled) { // Is IME enabled?
-        uint8_t req = mmu->read(INTERUPT_FLAG);
-        uint8_t enabled = mmu->read(INTERUPT_ENABLE);
+        uint8_t req = mmu->memory[INTERUPT_FLAG];
+        uint8_t enabled = mmu->memory[INTERUPT_ENABLE];
 
-        if (req > 0) { // If there are any pending interupts            
+        if (req & enabled & 0x1F) { // If there are any pending interupts            
             for (int i = 0; i < 5; i++) { // Handle them in the order of priority
                 if (get_bit(req, i) && get_bit(enabled, i)) { // If the interupt is enabled and is requested
                     interupts_enabled = false; // Clear IME flag
@@ -234,7 +377,7 @@ void CPU::handle_interupts()
                     else if (i == 3) pc = 0x58;
                     else if (i == 4) pc = 0x60;
 
-                    out << "Interput!: " << to_hex(pc) << '\n';
+                    if (tracing) trace(true);
                 }
             }
         }
@@ -249,8 +392,8 @@ int CPU::opcode00()
 
 int CPU::opcode01()
 {
-    uint8_t low = mmu->read(pc++);
-    uint8_t high = mmu->read(pc++);
+    uint8_t low = fetch();
+    uint8_t high = fetch();
 
     bc = combine(low, high);
     return 0;
@@ -270,31 +413,19 @@ int CPU::opcode03()
 
 int CPU::opcode04()
 {
-    bc.h++;
-    bool half_carry = (bc.h & 0x0F) == 0x00;
-
-    set_flag(Z, bc.h == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-
+    bc.h = alu_inc(bc.h);
     return 0;
 }
 
 int CPU::opcode05()
 {
-    bc.h--;
-    bool half_carry = (bc.h & 0x0F) == 0x0F;
-    
-    set_flag(Z, bc.h == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-
+    bc.h = alu_dec(bc.h);
     return 0;
 }
 
 int CPU::opcode06()
 {
-    uint8_t data = mmu->read(pc++);
+    uint8_t data = fetch();
     bc.h = data;
 
     return 0;
@@ -316,8 +447,8 @@ int CPU::opcode07()
 
 int CPU::opcode08()
 {
-    uint8_t low = mmu->read(pc++);
-    uint8_t high = mmu->read(pc++);
+    uint8_t low = fetch();
+    uint8_t high = fetch();
 
     uint16_t addr = combine(low, high);
     mmu->write(addr, get_low_byte(sp));
@@ -355,31 +486,19 @@ int CPU::opcode0B()
 
 int CPU::opcode0C()
 {
-    bc.l++;
-    bool half_carry = (bc.l & 0x0F) == 0x00;
-    
-    set_flag(Z, bc.l == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-
+    bc.l = alu_inc(bc.l);
     return 0;
 }
 
 int CPU::opcode0D()
 {
-    bc.l--;
-    bool half_carry = (bc.l & 0x0F) == 0x0F;
-
-    set_flag(Z, bc.l == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-
+    bc.l = alu_dec(bc.l);
     return 0;
 }
 
 int CPU::opcode0E()
 {
-    uint8_t data = mmu->read(pc++);
+    uint8_t data = fetch();
     bc.l = data;
     
     return 0;
@@ -408,8 +527,8 @@ int CPU::opcode10()
 
 int CPU::opcode11()
 {
-    uint8_t low = mmu->read(pc++);
-    uint8_t high = mmu->read(pc++);
+    uint8_t low = fetch();
+    uint8_t high = fetch();
 
     de = combine(low, high);
     return 0;
@@ -429,31 +548,19 @@ int CPU::opcode13()
 
 int CPU::opcode14()
 {
-    de.h++;
-    bool half_carry = (de.h & 0x0F) == 0x00;
-
-    set_flag(Z, de.h == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-
+    de.h = alu_inc(de.h);
     return 0;
 }
 
 int CPU::opcode15()
 {
-    de.h--;
-    bool half_carry = (de.h & 0x0F) == 0x0F;
-
-    set_flag(Z, de.h == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-
+    de.h = alu_dec(de.h);
     return 0;
 }
 
 int CPU::opcode16()
 {
-    uint8_t data = mmu->read(pc++);
+    uint8_t data = fetch();
     
     de.h = data;
     return 0;
@@ -476,7 +583,7 @@ int CPU::opcode17()
 
 int CPU::opcode18()
 {
-    int8_t offset = T8(mmu->read(pc++));
+    int8_t offset = T8(fetch());
     pc += offset;
 
     return 0;
@@ -511,31 +618,19 @@ int CPU::opcode1B()
 
 int CPU::opcode1C()
 {
-    de.l++;
-    bool half_carry = (de.l & 0x0F) == 0x00;
-
-    set_flag(Z, de.l == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-
+    de.l = alu_inc(de.l);
     return 0;
 }
 
 int CPU::opcode1D()
 {
-    de.l--;
-    bool half_carry = (de.l & 0x0F) == 0x0F;
-
-    set_flag(Z, de.l == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-
+    de.l = alu_dec(de.l);
     return 0;
 }
 
 int CPU::opcode1E()
 {
-    uint8_t data = mmu->read(pc++);
+    uint8_t data = fetch();
     de.l = data;
 
     return 0;
@@ -558,8 +653,8 @@ int CPU::opcode1F()
 
 int CPU::opcode20()
 {
-    if (!get_flag(Z)) {
-        int8_t offset = T8(mmu->read(pc++));
+    if (!zero_flag()) {
+        int8_t offset = T8(fetch());
         pc += offset;
         
         return 1;
@@ -570,8 +665,8 @@ int CPU::opcode20()
 
 int CPU::opcode21()
 {
-    uint8_t low = mmu->read(pc++);
-    uint8_t high = mmu->read(pc++);
+    uint8_t low = fetch();
+    uint8_t high = fetch();
 
     hl = combine(low, high);
     return 0;
@@ -591,34 +686,19 @@ int CPU::opcode23()
 
 int CPU::opcode24()
 {
-    uint8_t h = hl.h;
-
-    uint8_t result = h + 1;
-    bool half_carry = ((h ^ 1 ^ result) & 0x10) == 0x10;
-
-    set_flag(Z, (result == 0));
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-
-    hl.h = result;
+    hl.h = alu_inc(hl.h);
     return 0;
 }
 
 int CPU::opcode25()
 {
-    hl.h--;
-    bool half_carry = (hl.h & 0x0F) == 0x0F;
-
-    set_flag(Z, hl.h == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-
+    hl.h = alu_dec(hl.h);
     return 0;
 }
 
 int CPU::opcode26()
 {
-    uint8_t data = mmu->read(pc++);
+    uint8_t data = fetch();
 
     hl.h = data;
     return 0;
@@ -655,8 +735,8 @@ int CPU::opcode27()
 
 int CPU::opcode28()
 {
-    if (get_flag(Z)) {
-        int8_t r8 = T8(mmu->read(pc++));
+    if (zero_flag()) {
+        int8_t r8 = T8(fetch());
         pc += r8;
         return 1;
     }
@@ -693,31 +773,19 @@ int CPU::opcode2B()
 
 int CPU::opcode2C()
 {
-    hl.l++;
-    bool half_carry = (hl.l & 0x0F) == 0x00;
-
-    set_flag(Z, hl.l == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-
+    hl.l = alu_inc(hl.l);
     return 0;
 }
 
 int CPU::opcode2D()
 {
-    hl.l--;
-    bool half_carry = (hl.l & 0x0F) == 0x0F;
-
-    set_flag(Z, hl.l == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-
+    hl.l = alu_dec(hl.l);
     return 0;
 }
 
 int CPU::opcode2E()
 {
-    uint8_t data = mmu->read(pc++);
+    uint8_t data = fetch();
     hl.l = data;
 
     return 0;
@@ -735,8 +803,8 @@ int CPU::opcode2F()
 
 int CPU::opcode30()
 {
-    if (!get_flag(C)) {
-        int8_t offset = T8(mmu->read(pc++));
+    if (!carry_flag()) {
+        int8_t offset = T8(fetch());
         pc += offset;
 
         return 1;
@@ -747,8 +815,8 @@ int CPU::opcode30()
 
 int CPU::opcode31()
 {
-    uint8_t low = mmu->read(pc++);
-    uint8_t high = mmu->read(pc++);
+    uint8_t low = fetch();
+    uint8_t high = fetch();
 
     sp = combine(low, high);
     return 0;
@@ -769,33 +837,22 @@ int CPU::opcode33()
 int CPU::opcode34()
 {
     uint8_t value = mmu->read(hl.get());
-    uint8_t result = TU8(value + 1);
-    
-    mmu->write(hl.get(), result);
+    mmu->write(hl.get(), alu_inc(value));
 
-    set_flag(Z, result == 0);
-    set_flag(N, 0);
-    set_flag(H, (result & 0x0F) == 0x00);
     return 0;
 }
 
 int CPU::opcode35()
 {
     uint8_t value = mmu->read(hl.get());
-    uint8_t result = TU8(value - 1);
-    
-    mmu->write(hl.get(), result);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(H, (result & 0x0F) == 0x0F);
+    mmu->write(hl.get(), alu_dec(value));
 
     return 0;
 }
 
 int CPU::opcode36()
 {
-    uint8_t data = mmu->read(pc++);
+    uint8_t data = fetch();
     
     mmu->write(hl.get(), data);
     return 0;
@@ -812,8 +869,8 @@ int CPU::opcode37()
 
 int CPU::opcode38()
 {
-    if (get_flag(C)) {
-        int8_t r8 = T8(mmu->read(pc++));
+    if (carry_flag()) {
+        int8_t r8 = T8(fetch());
         pc += r8;
 
         return 1;
@@ -851,31 +908,19 @@ int CPU::opcode3B()
 
 int CPU::opcode3C()
 {
-    af.h++;
-    bool half_carry = (af.h & 0x0F) == 0x00;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-
+    af.h = alu_inc(af.h);
     return 0;
 }
 
 int CPU::opcode3D()
 {
-    af.h--;
-    bool half_carry = (af.h & 0x0F) == 0x0F;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-
+    af.h = alu_dec(af.h);
     return 0;
 }
 
 int CPU::opcode3E()
 {
-    uint8_t data = mmu->read(pc++);
+    uint8_t data = fetch();
     af.h = data;
 
     return 0;
@@ -1269,879 +1314,391 @@ int CPU::opcode7F()
 
 int CPU::opcode80()
 {
-    uint32_t result = af.h + bc.h;
-    bool half_carry = (af.h & 0xf) + (bc.h & 0xf) > 0xf;
-    af.h = TU8(result);
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-    set_flag(C, (result & 0x100) != 0);
-    
+    alu_add(bc.h);
     return 0;
 }
 
 int CPU::opcode81()
 {
-    uint32_t result = af.h + bc.l;
-    bool half_carry = (af.h & 0xf) + (bc.l & 0xf) > 0xf;
-    af.h = TU8(result);
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-    set_flag(C, (result & 0x100) != 0);
-
+    alu_add(bc.l);
     return 0;
 }
 
 int CPU::opcode82()
 {
-    uint32_t result = af.h + de.h;
-    bool half_carry = (af.h & 0xf) + (de.h & 0xf) > 0xf;
-    af.h = TU8(result);
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-    set_flag(C, (result & 0x100) != 0);
-
+    alu_add(de.h);
     return 0;
 }
 
 int CPU::opcode83()
 {
-    uint32_t result = af.h + de.l;
-    bool half_carry = (af.h & 0xf) + (de.l & 0xf) > 0xf;
-    af.h = TU8(result);
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-    set_flag(C, (result & 0x100) != 0);
-
+    alu_add(de.l);
     return 0;
 }
 
 int CPU::opcode84()
 {
-    uint32_t result = af.h + hl.h;
-    bool half_carry = (af.h & 0xf) + (hl.h & 0xf) > 0xf;
-    af.h = TU8(result);
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-    set_flag(C, (result & 0x100) != 0);
-
+    alu_add(hl.h);
     return 0;
 }
 
 int CPU::opcode85()
 {
-    uint32_t result = af.h + hl.l;
-    bool half_carry = (af.h & 0xf) + (hl.l & 0xf) > 0xf;
-    af.h = TU8(result);
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-    set_flag(C, (result & 0x100) != 0);
-
+    alu_add(hl.l);
     return 0;
 }
 
 int CPU::opcode86()
 {
-    uint8_t value = mmu->read(hl.get());
-    uint32_t result = af.h + value;
-    bool half_carry = (af.h & 0xf) + (value & 0xf) > 0xf;
-    af.h = TU8(result);
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-    set_flag(C, (result & 0x100) != 0);
-
+    alu_add(mmu->read(hl.get()));
     return 0;
 }
 
 int CPU::opcode87()
 {
-    uint32_t result = af.h + af.h;
-    bool half_carry = (af.h & 0xf) + (af.h & 0xf) > 0xf;
-    af.h = TU8(result);
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-    set_flag(C, (result & 0x100) != 0);
-
+    alu_add(af.h);
     return 0;
 }
 
 int CPU::opcode88()
 {
-    uint8_t carry = get_flag(C);
-    uint32_t result32 = af.h + bc.h + carry;
-    uint8_t result = TU8(result32);
-    bool half_carry = ((af.h & 0xf) + (bc.h & 0xf) + carry) > 0xf;
-
-    set_flag(Z, result == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-    set_flag(C, result32 > 0xff);
-
-    af.h = result;
+    alu_add(bc.h, carry_flag());
     return 0;
 }
 
 int CPU::opcode89()
 {
-    uint8_t carry = get_flag(C);
-    uint32_t result32 = af.h + bc.l + carry;
-    uint8_t result = TU8(result32);
-    bool half_carry = ((af.h & 0xf) + (bc.l & 0xf) + carry) > 0xf;
-
-    set_flag(Z, result == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-    set_flag(C, result32 > 0xff);
-
-    af.h = result;
+    alu_add(bc.l, carry_flag());
     return 0;
 }
 
 int CPU::opcode8A()
 {
-    uint8_t carry = get_flag(C);
-    uint32_t result32 = af.h + de.h + carry;
-    uint8_t result = TU8(result32);
-    bool half_carry = ((af.h & 0xf) + (de.h & 0xf) + carry) > 0xf;
-
-    set_flag(Z, result == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-    set_flag(C, result32 > 0xff);
-
-    af.h = result;
+    alu_add(de.h, carry_flag());
     return 0;
 }
 
 int CPU::opcode8B()
 {
-    uint8_t carry = get_flag(C);
-    uint32_t result32 = af.h + de.l + carry;
-    uint8_t result = TU8(result32);
-    bool half_carry = ((af.h & 0xf) + (de.l & 0xf) + carry) > 0xf;
-
-    set_flag(Z, result == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-    set_flag(C, result32 > 0xff);
-
-    af.h = result;
+    alu_add(de.l, carry_flag());
     return 0;
 }
 
 int CPU::opcode8C()
 {
-    uint8_t carry = get_flag(C);
-    uint32_t result32 = af.h + hl.h + carry;
-    uint8_t result = TU8(result32);
-    bool half_carry = ((af.h & 0xf) + (hl.h & 0xf) + carry) > 0xf;
-
-    set_flag(Z, result == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-    set_flag(C, result32 > 0xff);
-
-    af.h = result;
+    alu_add(hl.h, carry_flag());
     return 0;
 }
 
 int CPU::opcode8D()
 {
-    uint8_t carry = get_flag(C);
-    uint32_t result32 = af.h + hl.l + carry;
-    uint8_t result = TU8(result32);
-    bool half_carry = ((af.h & 0xf) + (hl.l & 0xf) + carry) > 0xf;
-
-    set_flag(Z, result == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-    set_flag(C, result32 > 0xff);
-
-    af.h = result;
+    alu_add(hl.l, carry_flag());
     return 0;
 }
 
 int CPU::opcode8E()
 {
-    uint8_t value = mmu->read(hl.get());
-    uint8_t carry = get_flag(C);
-    uint32_t result32 = af.h + value + carry;
-    uint8_t result = TU8(result32);
-    bool half_carry = ((af.h & 0xf) + (value & 0xf) + carry) > 0xf;
-
-    set_flag(Z, result == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-    set_flag(C, result32 > 0xff);
-
-    af.h = result;
+    alu_add(mmu->read(hl.get()), carry_flag());
     return 0;
 }
 
 int CPU::opcode8F()
 {
-    uint8_t carry = get_flag(C);
-    uint32_t result32 = af.h + af.h + carry;
-    uint8_t result = TU8(result32);
-    bool half_carry = ((af.h & 0xf) + (af.h & 0xf) + carry) > 0xf;
-
-    set_flag(Z, result == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-    set_flag(C, result32 > 0xff);
-
-    af.h = result;
+    alu_add(af.h, carry_flag());
     return 0;
 }
 
 int CPU::opcode90()
 {
-    uint16_t result = af.h - bc.h;
-    bool half_carry = (af.h & 0xF) < (bc.h & 0xF);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-    set_flag(C, bc.h > af.h);
-
-    af.h = TU8(result);
+    alu_sub(bc.h);
     return 0;
 }
 
 int CPU::opcode91()
 {
-    uint16_t result = af.h - bc.l;
-    bool half_carry = (af.h & 0xF) < (bc.l & 0xF);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-    set_flag(C, bc.l > af.h);
-
-    af.h = TU8(result);
+    alu_sub(bc.l);
     return 0;
 }
 
 int CPU::opcode92()
 {
-    uint16_t result = af.h - de.h;
-    bool half_carry = (af.h & 0xF) < (de.h & 0xF);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-    set_flag(C, de.h > af.h);
-
-    af.h = TU8(result);
+    alu_sub(de.h);
     return 0;
 }
 
 int CPU::opcode93()
 {
-    uint16_t result = af.h - de.l;
-    bool half_carry = (af.h & 0xF) < (de.l & 0xF);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-    set_flag(C, de.l > af.h);
-
-    af.h = TU8(result);
+    alu_sub(de.l);
     return 0;
 }
 
 int CPU::opcode94()
 {
-    uint16_t result = af.h - hl.h;
-    bool half_carry = (af.h & 0xF) < (hl.h & 0xF);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-    set_flag(C, hl.h > af.h);
-
-    af.h = TU8(result);
+    alu_sub(hl.h);
     return 0;
 }
 
 int CPU::opcode95()
 {
-    uint16_t result = af.h - hl.l;
-    bool half_carry = (af.h & 0xF) < (hl.l & 0xF);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-    set_flag(C, hl.l > af.h);
-
-    af.h = TU8(result);
+    alu_sub(hl.l);
     return 0;
 }
 
 int CPU::opcode96()
 {
-    uint8_t value = mmu->read(hl.get());
-    uint16_t result = af.h - value;
-    bool half_carry = (af.h & 0xF) < (value & 0xF);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-    set_flag(C, value > af.h);
-
-    af.h = TU8(result);
-    return 0;
-}
+    alu_sub(mmu->read(hl.get()));
+    return 0;
+}
 
 int CPU::opcode97()
 {
-    af.h = 0;
-    
-    set_flag(Z, 1);
-    set_flag(N, 1);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
+    alu_sub(af.h);
     return 0;
 }
 
 int CPU::opcode98()
 {
-    uint8_t carry = get_flag(C);
-    int32_t result32 = af.h - bc.h - carry;
-    uint8_t result = TU8(result32);
-    bool half_carry = ((af.h & 0xf) - (bc.h & 0xf) - carry) < 0;
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(C, result32 < 0);
-    set_flag(H, half_carry);
-
-    af.h = result;
+    alu_sub(bc.h, carry_flag());
     return 0;
 }
 
 int CPU::opcode99()
 {
-    uint8_t carry = get_flag(C);
-    int32_t result32 = af.h - bc.l - carry;
-    uint8_t result = TU8(result32);
-    bool half_carry = ((af.h & 0xf) - (bc.l & 0xf) - carry) < 0;
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(C, result32 < 0);
-    set_flag(H, half_carry);
-
-    af.h = result;
+    alu_sub(bc.l, carry_flag());
     return 0;
 }
 
 int CPU::opcode9A()
 {
-    uint8_t carry = get_flag(C);
-    int32_t result32 = af.h - de.h - carry;
-    uint8_t result = TU8(result32);
-    bool half_carry = ((af.h & 0xf) - (de.h & 0xf) - carry) < 0;
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(C, result32 < 0);
-    set_flag(H, half_carry);
-
-    af.h = result;
+    alu_sub(de.h, carry_flag());
     return 0;
 }
 
 int CPU::opcode9B()
 {
-    uint8_t carry = get_flag(C);
-    int32_t result32 = af.h - de.l - carry;
-    uint8_t result = TU8(result32);
-    bool half_carry = ((af.h & 0xf) - (de.l & 0xf) - carry) < 0;
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(C, result32 < 0);
-    set_flag(H, half_carry);
-
-    af.h = result;
+    alu_sub(de.l, carry_flag());
     return 0;
 }
 
 int CPU::opcode9C()
 {
-    uint8_t carry = get_flag(C);
-    int32_t result32 = af.h - hl.h - carry;
-    uint8_t result = TU8(result32);
-    bool half_carry = ((af.h & 0xf) - (hl.h & 0xf) - carry) < 0;
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(C, result32 < 0);
-    set_flag(H, half_carry);
-
-    af.h = result;
+    alu_sub(hl.h, carry_flag());
     return 0;
 }
 
 int CPU::opcode9D()
 {
-    uint8_t carry = get_flag(C);
-    int32_t result32 = af.h - hl.l - carry;
-    uint8_t result = TU8(result32);
-    bool half_carry = ((af.h & 0xf) - (hl.l & 0xf) - carry) < 0;
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(C, result32 < 0);
-    set_flag(H, half_carry);
-
-    af.h = result;
+    alu_sub(hl.l, carry_flag());
     return 0;
 }
 
 int CPU::opcode9E()
 {
-    uint8_t carry = get_flag(C);
-    uint8_t value = mmu->read(hl.get());
-    int32_t result32 = af.h - value - carry;
-    uint8_t result = TU8(result32);
-    bool half_carry = ((af.h & 0xf) - (value & 0xf) - carry) < 0;
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(C, result32 < 0);
-    set_flag(H, half_carry);
-
-    af.h = result;
+    alu_sub(mmu->read(hl.get()), carry_flag());
     return 0;
 }
 
 int CPU::opcode9F()
 {
-    uint8_t carry = get_flag(C);
-    int32_t result32 = af.h - af.h - carry;
-    uint8_t result = TU8(result32);
-    bool half_carry = ((af.h & 0xf) - (af.h & 0xf) - carry) < 0;
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(C, result32 < 0);
-    set_flag(H, half_carry);
-
-    af.h = result;
+    alu_sub(af.h, carry_flag());
     return 0;
 }
 
 int CPU::opcodeA0()
 {
-    af.h &= bc.h;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 1);
-    set_flag(C, 0);
-
+    alu_and(bc.h);
     return 0;
 }
 
 int CPU::opcodeA1()
 {
-    af.h &= bc.l;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 1);
-    set_flag(C, 0);
-
+    alu_and(bc.l);
     return 0;
 }
 
 int CPU::opcodeA2()
 {
-    af.h &= de.h;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 1);
-    set_flag(C, 0);
-
+    alu_and(de.h);
     return 0;
 }
 
 int CPU::opcodeA3()
 {
-    af.h &= de.l;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 1);
-    set_flag(C, 0);
-
+    alu_and(de.l);
     return 0;
 }
 
 int CPU::opcodeA4()
 {
-    af.h &= hl.h;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 1);
-    set_flag(C, 0);
-
+    alu_and(hl.h);
     return 0;
 }
 
 int CPU::opcodeA5()
 {
-    af.h &= hl.l;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 1);
-    set_flag(C, 0);
-
+    alu_and(hl.l);
     return 0;
 }
 
 int CPU::opcodeA6()
 {
-    af.h &= mmu->read(hl.get());
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 1);
-    set_flag(C, 0);
-
+    alu_and(mmu->read(hl.get()));
     return 0;
 }
 
 int CPU::opcodeA7()
 {
-    af.h &= af.h;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 1);
-    set_flag(C, 0);
-
+    alu_and(af.h);
     return 0;
 }
 
 int CPU::opcodeA8()
 {
-    af.h ^= bc.h;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
+    alu_xor(bc.h);
     return 0;
 }
 
 int CPU::opcodeA9()
 {
-    af.h ^= bc.l;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
+    alu_xor(bc.l);
     return 0;
 }
 
 int CPU::opcodeAA()
 {
-    af.h ^= de.h;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
+    alu_xor(de.h);
     return 0;
 }
 
 int CPU::opcodeAB()
 {
-    af.h ^= de.l;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
+    alu_xor(de.l);
     return 0;
 }
 
 int CPU::opcodeAC()
 {
-    af.h ^= hl.h;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
+    alu_xor(hl.h);
     return 0;
 }
 
 int CPU::opcodeAD()
 {
-    af.h ^= hl.l;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
+    alu_xor(hl.l);
     return 0;
 }
 
 int CPU::opcodeAE()
 {
-    af.h ^= mmu->read(hl.get());
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
+    alu_xor(mmu->read(hl.get()));
     return 0;
 }
 
 int CPU::opcodeAF()
 {
-    af.h = 0;
-
-    set_flag(Z, 1);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
+    alu_xor(af.h);
     return 0;
 }
 
 int CPU::opcodeB0()
 {
-    af.h |= bc.h;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
+    alu_or(bc.h);
     return 0;
 }
 
 int CPU::opcodeB1()
 {
-    af.h |= bc.l;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
+    alu_or(bc.l);
     return 0;
 }
 
 int CPU::opcodeB2()
 {
-    af.h |= de.h;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
+    alu_or(de.h);
     return 0;
 }
 
 int CPU::opcodeB3()
 {
-    af.h |= de.l;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
+    alu_or(de.l);
     return 0;
 }
 
 int CPU::opcodeB4()
 {
-    af.h |= hl.h;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
+    alu_or(hl.h);
     return 0;
 }
 
 int CPU::opcodeB5()
 {
-    af.h |= hl.l;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
+    alu_or(hl.l);
     return 0;
 }
 
 int CPU::opcodeB6()
 {
-    af.h |= mmu->read(hl.get());
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
+    alu_or(mmu->read(hl.get()));
     return 0;
 }
 
 int CPU::opcodeB7()
 {
-    af.h |= af.h;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
+    alu_or(af.h);
     return 0;
 }
 
 int CPU::opcodeB8()
 {
-    uint8_t result = af.h - bc.h;
-    bool half_carry = (af.h & 0xF) < (bc.h & 0xF);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-    set_flag(C, bc.h > af.h);
-
+    alu_cp(bc.h);
     return 0;
 }
 
 int CPU::opcodeB9()
 {
-    uint8_t result = af.h - bc.l;
-    bool half_carry = (af.h & 0xF) < (bc.l & 0xF);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-    set_flag(C, bc.l > af.h);
-
+    alu_cp(bc.l);
     return 0;
 }
 
 int CPU::opcodeBA()
 {
-    uint8_t result = af.h - de.h;
-    bool half_carry = (af.h & 0xF) < (de.h & 0xF);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-    set_flag(C, de.h > af.h);
-
+    alu_cp(de.h);
     return 0;
 }
 
 int CPU::opcodeBB()
 {
-    uint8_t result = af.h - de.l;
-    bool half_carry = (af.h & 0xF) < (de.l & 0xF);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-    set_flag(C, de.l > af.h);
-
+    alu_cp(de.l);
     return 0;
 }
 
 int CPU::opcodeBC()
 {
-    uint8_t result = af.h - hl.h;
-    bool half_carry = (af.h & 0xF) < (hl.h & 0xF);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-    set_flag(C, hl.h > af.h);
-
+    alu_cp(hl.h);
     return 0;
 }
 
 int CPU::opcodeBD()
 {
-    uint8_t result = af.h - hl.l;
-    bool half_carry = (af.h & 0xF) < (hl.l & 0xF);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-    set_flag(C, hl.l > af.h);
-
+    alu_cp(hl.l);
     return 0;
 }
 
 int CPU::opcodeBE()
 {
-    uint8_t value = mmu->read(hl.get());
-    uint8_t result = af.h - value;
-    bool half_carry = (af.h & 0xF) < (value & 0xF);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-    set_flag(C, value > af.h);
-
+    alu_cp(mmu->read(hl.get()));
     return 0;
 }
 
 int CPU::opcodeBF()
 {
-    set_flag(Z, 1);
-    set_flag(N, 1);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
+    alu_cp(af.h);
     return 0;
 }
 
 int CPU::opcodeC0()
 {
-    if (!get_flag(Z)) {
+    if (!zero_flag()) {
         uint8_t low = mmu->read(sp++);
         uint8_t high = mmu->read(sp++);
 
@@ -2164,9 +1721,9 @@ int CPU::opcodeC1()
 
 int CPU::opcodeC2()
 {
-    if (!get_flag(Z)) {
-        uint8_t low = mmu->read(pc++);
-        uint8_t high = mmu->read(pc++);
+    if (!zero_flag()) {
+        uint8_t low = fetch();
+        uint8_t high = fetch();
 
         uint16_t addr = combine(low, high);
         pc = addr;
@@ -2179,8 +1736,8 @@ int CPU::opcodeC2()
 
 int CPU::opcodeC3()
 {
-    uint8_t low = mmu->read(pc++);
-    uint8_t high = mmu->read(pc++);
+    uint8_t low = fetch();
+    uint8_t high = fetch();
 
     uint16_t addr = combine(low, high);
     pc = addr;
@@ -2190,9 +1747,9 @@ int CPU::opcodeC3()
 
 int CPU::opcodeC4()
 {
-    if (!get_flag(Z)) {
-        uint8_t low = mmu->read(pc++);
-        uint8_t high = mmu->read(pc++);
+    if (!zero_flag()) {
+        uint8_t low = fetch();
+        uint8_t high = fetch();
 
         uint16_t addr = combine(low, high);
         
@@ -2217,17 +1774,7 @@ int CPU::opcodeC5()
 
 int CPU::opcodeC6()
 {
-    uint8_t value = mmu->read(pc++);
-    uint32_t result = af.h + value;
-
-    bool half_carry = (af.h & 0xF) + (value & 0xF) > 0xF;
-    af.h = TU8(result);
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-    set_flag(C, (result & 0x100) != 0);
-
+    alu_add(fetch());
     return 0;
 }
 
@@ -2242,7 +1789,7 @@ int CPU::opcodeC7()
 
 int CPU::opcodeC8()
 {
-    if (get_flag(Z)) {
+    if (zero_flag()) {
         uint8_t low = mmu->read(sp++);
         uint8_t high = mmu->read(sp++);
 
@@ -2264,9 +1811,9 @@ int CPU::opcodeC9()
 
 int CPU::opcodeCA()
 {
-    if (get_flag(Z)) {
-        uint8_t low = mmu->read(pc++);
-        uint8_t high = mmu->read(pc++);
+    if (zero_flag()) {
+        uint8_t low = fetch();
+        uint8_t high = fetch();
 
         uint16_t addr = combine(low, high);
         pc = addr;
@@ -2285,9 +1832,9 @@ int CPU::opcodeCB()
 
 int CPU::opcodeCC()
 {
-    if (get_flag(Z)) {
-        uint8_t low = mmu->read(pc++);
-        uint8_t high = mmu->read(pc++);
+    if (zero_flag()) {
+        uint8_t low = fetch();
+        uint8_t high = fetch();
 
         uint16_t addr = combine(low, high);
 
@@ -2304,8 +1851,8 @@ int CPU::opcodeCC()
 
 int CPU::opcodeCD()
 {
-    uint8_t low = mmu->read(pc++);
-    uint8_t high = mmu->read(pc++);
+    uint8_t low = fetch();
+    uint8_t high = fetch();
 
     uint16_t addr = combine(low, high);
 
@@ -2319,18 +1866,7 @@ int CPU::opcodeCD()
 
 int CPU::opcodeCE()
 {
-    uint8_t value = mmu->read(pc++);
-    uint8_t carry = get_flag(C);
-
-    uint32_t result = af.h + value + carry;
-    bool half_carry = ((af.h & 0xF) + (value & 0xF) + carry) > 0xF;
-    af.h = TU8(result);
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, half_carry);
-    set_flag(C, result > 0xff);
-
+    alu_add(fetch(), carry_flag());
     return 0;
 }
 
@@ -2345,7 +1881,7 @@ int CPU::opcodeCF()
 
 int CPU::opcodeD0()
 {
-    if (!get_flag(C)) {
+    if (!carry_flag()) {
         uint8_t low = mmu->read(sp++);
         uint8_t high = mmu->read(sp++);
 
@@ -2368,9 +1904,9 @@ int CPU::opcodeD1()
 
 int CPU::opcodeD2()
 {
-    if (!get_flag(C)) {
-        uint8_t low = mmu->read(pc++);
-        uint8_t high = mmu->read(pc++);
+    if (!carry_flag()) {
+        uint8_t low = fetch();
+        uint8_t high = fetch();
 
         uint16_t addr = combine(low, high);
         pc = addr;
@@ -2388,9 +1924,9 @@ int CPU::opcodeD3()
 
 int CPU::opcodeD4()
 {
-    if (!get_flag(C)) {
-        uint8_t low = mmu->read(pc++);
-        uint8_t high = mmu->read(pc++);
+    if (!carry_flag()) {
+        uint8_t low = fetch();
+        uint8_t high = fetch();
 
         uint16_t addr = combine(low, high);
 
@@ -2415,16 +1951,7 @@ int CPU::opcodeD5()
 
 int CPU::opcodeD6()
 {
-    uint8_t val = mmu->read(pc++);
-    uint8_t result = af.h - val;
-    bool half_carry = (af.h & 0xF) < (val & 0xF);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-    set_flag(C, val > af.h);
-
-    af.h = result;
+    alu_sub(fetch());
     return 0;
 }
 
@@ -2439,7 +1966,7 @@ int CPU::opcodeD7()
 
 int CPU::opcodeD8()
 {
-    if (get_flag(C)) {
+    if (carry_flag()) {
         uint8_t low = mmu->read(sp++);
         uint8_t high = mmu->read(sp++);
 
@@ -2462,9 +1989,9 @@ int CPU::opcodeD9()
 
 int CPU::opcodeDA()
 {
-    if (get_flag(C)) {
-        uint8_t low = mmu->read(pc++);
-        uint8_t high = mmu->read(pc++);
+    if (carry_flag()) {
+        uint8_t low = fetch();
+        uint8_t high = fetch();
 
         uint16_t addr = combine(low, high);
         pc = addr;
@@ -2482,9 +2009,9 @@ int CPU::opcodeDB()
 
 int CPU::opcodeDC()
 {
-    if (get_flag(C)) {
-        uint8_t low = mmu->read(pc++);
-        uint8_t high = mmu->read(pc++);
+    if (carry_flag()) {
+        uint8_t low = fetch();
+        uint8_t high = fetch();
 
         uint16_t addr = combine(low, high);
 
@@ -2506,17 +2033,7 @@ int CPU::opcodeDD()
 
 int CPU::opcodeDE()
 {
-    bool carry = get_flag(C);
-    uint8_t value = mmu->read(pc++);
-    uint8_t result = af.h - value - carry;
-    bool half_carry = (af.h & 0xf) < (value & 0xf) + carry;
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-    set_flag(C, af.h < value + carry);
-
-    af.h = result;
+    alu_sub(fetch(), carry_flag());
     return 0;
 }
 
@@ -2531,7 +2048,7 @@ int CPU::opcodeDF()
 
 int CPU::opcodeE0()
 {
-    uint8_t offset = mmu->read(pc++);
+    uint8_t offset = fetch();
     uint16_t addr = 0xFF00 + offset;
 
     mmu->write(addr, af.h);
@@ -2577,14 +2094,7 @@ int CPU::opcodeE5()
 
 int CPU::opcodeE6()
 {
-    uint8_t val = mmu->read(pc++);
-    af.h &= val;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 1);
-    set_flag(C, 0);
-
+    alu_and(fetch());
     return 0;
 }
 
@@ -2599,7 +2109,7 @@ int CPU::opcodeE7()
 
 int CPU::opcodeE8()
 {
-    int8_t data = T8(mmu->read(pc++));
+    int8_t data = T8(fetch());
     uint16_t result = sp + data;
     
     bool half_carry = (result & 0xF) < (sp & 0xF);
@@ -2622,8 +2132,8 @@ int CPU::opcodeE9()
 
 int CPU::opcodeEA()
 {
-    uint8_t low = mmu->read(pc++);
-    uint8_t high = mmu->read(pc++);
+    uint8_t low = fetch();
+    uint8_t high = fetch();
 
     uint16_t addr = combine(low, high);
     mmu->write(addr, af.h);
@@ -2648,14 +2158,7 @@ int CPU::opcodeED()
 
 int CPU::opcodeEE()
 {
-    uint8_t val = mmu->read(pc++);
-    
-    af.h ^= val;
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
+    alu_xor(fetch());
     return 0;
 }
 
@@ -2670,7 +2173,7 @@ int CPU::opcodeEF()
 
 int CPU::opcodeF0()
 {
-    uint8_t offset = mmu->read(pc++);
+    uint8_t offset = fetch();
     uint16_t addr = 0xFF00 + offset; 
     af.h = mmu->read(addr);
 
@@ -2682,6 +2185,8 @@ int CPU::opcodeF1()
     uint8_t low = mmu->read(sp++);
     uint8_t high = mmu->read(sp++);
 
+    lazy_flags.pending = false; // F is overwritten, drop the pending flags
+
     af = combine(low, high);
     af.l &= 0xF0;
     
@@ -2709,6 +2214,8 @@ int CPU::opcodeF4()
 
 int CPU::opcodeF5()
 {
+    resolve_flags();
+
     sp--; mmu->write(sp, af.h);
     sp--; mmu->write(sp, af.l);
 
@@ -2717,14 +2224,7 @@ int CPU::opcodeF5()
 
 int CPU::opcodeF6()
 {
-    uint8_t val = mmu->read(pc++);
-    af.h |= val;
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
+    alu_or(fetch());
     return 0;
 }
 
@@ -2739,7 +2239,7 @@ int CPU::opcodeF7()
 
 int CPU::opcodeF8()
 {
-    int8_t value = T8(mmu->read(pc++));
+    int8_t value = T8(fetch());
     uint16_t check = sp ^ value ^ ((sp + value) & 0xFFFF);
     hl = sp + value;
 
@@ -2759,8 +2259,8 @@ int CPU::opcodeF9()
 
 int CPU::opcodeFA()
 {
-    uint8_t low = mmu->read(pc++);
-    uint8_t high = mmu->read(pc++);
+    uint8_t low = fetch();
+    uint8_t high = fetch();
 
     uint16_t addr = combine(low, high);
     af.h = mmu->read(addr);
@@ -2786,15 +2286,7 @@ int CPU::opcodeFD()
 
 int CPU::opcodeFE()
 {
-    uint8_t val = mmu->read(pc++);
-    uint8_t result = af.h - val;
-    bool half_carry = (af.h & 0xf) < (val & 0xf);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 1);
-    set_flag(H, half_carry);
-    set_flag(C, af.h < val);
-
+    alu_cp(fetch());
     return 0;
 }
 
@@ -2807,3167 +2299,104 @@ int CPU::opcodeFF()
     return 0;
 }
 
-int CPU::opcodeCB00()
+template <uint8_t Operand>
+uint8_t& CPU::cb_register()
 {
-    bool carry = get_bit(bc.h, 7);
-    bc.h <<= 1; set_bit(bc.h, 0, carry);
+    static_assert(Operand != 6, "(HL) is accessed through the MMU");
 
-    set_flag(Z, bc.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, carry);
-    
-    return 0;
+    if constexpr (Operand == 0) return bc.h;
+    else if constexpr (Operand == 1) return bc.l;
+    else if constexpr (Operand == 2) return de.h;
+    else if constexpr (Operand == 3) return de.l;
+    else if constexpr (Operand == 4) return hl.h;
+    else if constexpr (Operand == 5) return hl.l;
+    else return af.h;
 }
 
-int CPU::opcodeCB01()
+// The CB opcode is laid out as [group:2][bit or operation:3][operand:3]
+template <uint8_t Code>
+int CPU::cb_opcode()
 {
-    bool carry = get_bit(bc.l, 7);
-    bc.l <<= 1; set_bit(bc.l, 0, carry);
+    constexpr uint8_t operand = Code & 0x07;
+    constexpr uint8_t bit = (Code >> 3) & 0x07;
+    constexpr uint8_t group = Code >> 6;
 
-    set_flag(Z, bc.l == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, carry);
+    uint8_t value = 0;
+    if constexpr (operand == 6) value = mmu->read(hl.get());
+    else value = cb_register<operand>();
 
-    return 0;
-}
+    if constexpr (group == 1) { // BIT
+        set_flag(Z, !get_bit(value, bit));
+        set_flag(N, 0);
+        set_flag(H, 1);
 
-int CPU::opcodeCB02()
-{
-    bool carry = get_bit(de.h, 7);
-    de.h <<= 1; set_bit(de.h, 0, carry);
+        return 0;
+    }
 
-    set_flag(Z, de.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, carry);
+    uint8_t result = value;
 
-    return 0;
-}
+    if constexpr (group == 2) { // RES
+        result &= ~(1 << bit);
+    }
+    else if constexpr (group == 3) { // SET
+        result |= (1 << bit);
+    }
+    else { // Rotates and shifts, the bit field selects the operation
+        bool carry = false;
 
-int CPU::opcodeCB03()
-{
-    bool carry = get_bit(de.l, 7);
-    de.l <<= 1; set_bit(de.l, 0, carry);
+        if constexpr (bit == 0) { // RLC
+            carry = value >> 7;
+            result = TU8(value << 1) | carry;
+        }
+        else if constexpr (bit == 1) { // RRC
+            carry = value & 0x01;
+            result = (value >> 1) | (carry << 7);
+        }
+        else if constexpr (bit == 2) { // RL
+            carry = value >> 7;
+            result = TU8(value << 1) | carry_flag();
+        }
+        else if constexpr (bit == 3) { // RR
+            carry = value & 0x01;
+            result = (value >> 1) | (carry_flag() << 7);
+        }
+        else if constexpr (bit == 4) { // SLA
+            carry = value >> 7;
+            result = TU8(value << 1);
+        }
+        else if constexpr (bit == 5) { // SRA
+            carry = value & 0x01;
+            result = (value >> 1) | (value & 0x80);
+        }
+        else if constexpr (bit == 6) { // SWAP
+            result = combine_nibbles(value >> 4, value & 0x0F);
+        }
+        else { // SRL
+            carry = value & 0x01;
+            result = value >> 1;
+        }
 
-    set_flag(Z, de.l == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, carry);
+        set_flags(result == 0, 0, 0, carry);
+    }
+
+    if constexpr (operand == 6) mmu->write(hl.get(), result);
+    else cb_register<operand>() = result;
 
     return 0;
 }
 
-int CPU::opcodeCB04()
+template <size_t... Codes>
+static constexpr std::array<Opcode, 256> make_cb_handlers(std::index_sequence<Codes...>)
 {
-    bool carry = get_bit(hl.h, 7);
-    hl.h <<= 1; set_bit(hl.h, 0, carry);
+    return { &CPU::cb_opcode<Codes>... };
+}
 
-    set_flag(Z, hl.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, carry);
-
-    return 0;
-}
-
-int CPU::opcodeCB05()
-{
-    bool carry = get_bit(hl.l, 7);
-    hl.l <<= 1; set_bit(hl.l, 0, carry);
-
-    set_flag(Z, hl.l == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, carry);
-
-    return 0;
-}
-
-int CPU::opcodeCB06()
-{
-    uint8_t value = mmu->read(hl.get());
-    bool carry = get_bit(value, 7);
-    value <<= 1; set_bit(value, 0, carry);
-
-    set_flag(Z, value == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, carry);
-
-    mmu->write(hl.get(), value);
-    return 0;
-}
-
-int CPU::opcodeCB07()
-{
-    bool carry = get_bit(af.h, 7);
-    af.h <<= 1; set_bit(af.h, 0, carry);
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, carry);
-
-    return 0;
-}
-
-int CPU::opcodeCB08()
-{
-    uint8_t carry = get_bit(bc.h, 0);
-    bc.h >>= 1; set_bit(bc.h, 7, carry);
-
-    set_flag(C, carry);
-    set_flag(Z, bc.h == 0);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    return 0;
-}
-
-int CPU::opcodeCB09()
-{
-    uint8_t carry = get_bit(bc.l, 0);
-    bc.l >>= 1; set_bit(bc.l, 7, carry);
-
-    set_flag(C, carry);
-    set_flag(Z, bc.l == 0);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    return 0;
-}
-
-int CPU::opcodeCB0A()
-{
-    uint8_t carry = get_bit(de.h, 0);
-    de.h >>= 1; set_bit(de.h, 7, carry);
-
-    set_flag(C, carry);
-    set_flag(Z, de.h == 0);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    return 0;
-}
-
-int CPU::opcodeCB0B()
-{
-    uint8_t carry = get_bit(de.l, 0);
-    de.l >>= 1; set_bit(de.l, 7, carry);
-
-    set_flag(C, carry);
-    set_flag(Z, de.l == 0);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    return 0;
-}
-
-int CPU::opcodeCB0C()
-{
-    uint8_t carry = get_bit(hl.h, 0);
-    hl.h >>= 1; set_bit(hl.h, 7, carry);
-
-    set_flag(C, carry);
-    set_flag(Z, hl.h == 0);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    return 0;
-}
-
-int CPU::opcodeCB0D()
-{
-    uint8_t carry = get_bit(hl.l, 0);
-    hl.l >>= 1; set_bit(hl.l, 7, carry);
-
-    set_flag(C, carry);
-    set_flag(Z, hl.l == 0);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    return 0;
-}
-
-int CPU::opcodeCB0E()
-{
-    uint8_t value = mmu->read(hl.get());
-    uint8_t carry = get_bit(value, 0);
-    value >>= 1; set_bit(value, 7, carry);
-
-    set_flag(C, carry);
-    set_flag(Z, value == 0);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    mmu->write(hl.get(), value);
-    return 0;
-}
-
-int CPU::opcodeCB0F()
-{
-    uint8_t carry = get_bit(af.h, 0);
-    af.h >>= 1; set_bit(af.h, 7, carry);
-
-    set_flag(C, carry);
-    set_flag(Z, af.h == 0);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    return 0;
-}
-
-int CPU::opcodeCB10()
-{
-    uint8_t carry = get_flag(C);
-    set_flag(C, get_bit(bc.h, 7));
-
-    bc.h <<= 1; set_bit(bc.h, 0, carry);
-
-    set_flag(Z, bc.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-
-    return 0;
-}
-
-int CPU::opcodeCB11()
-{
-    uint8_t carry = get_flag(C);
-    set_flag(C, get_bit(bc.l, 7));
-
-    bc.l <<= 1; set_bit(bc.l, 0, carry);
-
-    set_flag(Z, bc.l == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-
-    return 0;
-}
-
-int CPU::opcodeCB12()
-{
-    uint8_t carry = get_flag(C);
-    set_flag(C, get_bit(de.h, 7));
-
-    de.h <<= 1; set_bit(de.h, 0, carry);
-
-    set_flag(Z, de.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-
-    return 0;
-}
-
-int CPU::opcodeCB13()
-{
-    uint8_t carry = get_flag(C);
-    set_flag(C, get_bit(de.l, 7));
-
-    de.l <<= 1; set_bit(de.l, 0, carry);
-
-    set_flag(Z, de.l == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-
-    return 0;
-}
-
-int CPU::opcodeCB14()
-{
-    uint8_t carry = get_flag(C);
-    set_flag(C, get_bit(hl.h, 7));
-
-    hl.h <<= 1; set_bit(hl.h, 0, carry);
-
-    set_flag(Z, hl.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-
-    return 0;
-}
-
-int CPU::opcodeCB15()
-{
-    uint8_t carry = get_flag(C);
-    set_flag(C, get_bit(hl.l, 7));
-
-    hl.l <<= 1; set_bit(hl.l, 0, carry);
-
-    set_flag(Z, hl.l == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-
-    return 0;
-}
-
-int CPU::opcodeCB16()
-{
-    uint8_t value = mmu->read(hl.get());
-    uint8_t carry = get_flag(C);
-    set_flag(C, get_bit(value, 7));
-
-    value <<= 1; set_bit(value, 0, carry);
-
-    set_flag(Z, value == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-
-    mmu->write(hl.get(), value);
-    return 0;
-}
-
-int CPU::opcodeCB17()
-{
-    uint8_t carry = get_flag(C);
-    set_flag(C, get_bit(af.h, 7));
-
-    af.h <<= 1; set_bit(af.h, 0, carry);
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-
-    return 0;
-}
-
-int CPU::opcodeCB18()
-{
-    uint8_t carry = get_flag(C);
-    set_flag(C, get_bit(bc.h, 0));
-
-    bc.h >>= 1; set_bit(bc.h, 7, carry);
-
-    set_flag(Z, bc.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-
-    return 0;
-}
-
-int CPU::opcodeCB19()
-{
-    uint8_t carry = get_flag(C);
-    set_flag(C, get_bit(bc.l, 0));
-
-    bc.l >>= 1; set_bit(bc.l, 7, carry);
-
-    set_flag(Z, bc.l == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-
-    return 0;
-}
-
-int CPU::opcodeCB1A()
-{
-    uint8_t carry = get_flag(C);
-    set_flag(C, get_bit(de.h, 0));
-
-    de.h >>= 1; set_bit(de.h, 7, carry);
-
-    set_flag(Z, de.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-
-    return 0;
-}
-
-int CPU::opcodeCB1B()
-{
-    uint8_t carry = get_flag(C);
-    set_flag(C, get_bit(de.l, 0));
-
-    de.l >>= 1; set_bit(de.l, 7, carry);
-
-    set_flag(Z, de.l == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-
-    return 0;
-}
-
-int CPU::opcodeCB1C()
-{
-    uint8_t carry = get_flag(C);
-    set_flag(C, get_bit(hl.h, 0));
-
-    hl.h >>= 1; set_bit(hl.h, 7, carry);
-
-    set_flag(Z, hl.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-
-    return 0;
-}
-
-int CPU::opcodeCB1D()
-{
-    uint8_t carry = get_flag(C);
-    set_flag(C, get_bit(hl.l, 0));
-
-    hl.l >>= 1; set_bit(hl.l, 7, carry);
-
-    set_flag(Z, hl.l == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-
-    return 0;
-}
-
-int CPU::opcodeCB1E()
-{
-    uint8_t value = mmu->read(hl.get());
-    uint8_t carry = get_flag(C);
-    set_flag(C, get_bit(value, 0));
-
-    value >>= 1; set_bit(value, 7, carry);
-
-    set_flag(Z, value == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-
-    mmu->write(hl.get(), value);
-    return 0;
-}
-
-int CPU::opcodeCB1F()
-{
-    uint8_t carry = get_flag(C);
-    set_flag(C, get_bit(af.h, 0));
-
-    af.h >>= 1; set_bit(af.h, 7, carry);
-
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-
-    return 0;
-}
-
-int CPU::opcodeCB20()
-{
-    uint8_t reg = bc.h;
-    uint8_t carry_bit = get_bit(reg, 7);
-
-    uint8_t result = TU8(reg << 1);
-
-    set_flag(Z, result == 0);
-    set_flag(C, carry_bit);
-    set_flag(H, 0);
-    set_flag(N, 0);
-    
-    bc.h = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB21()
-{
-    uint8_t reg = bc.l;
-    uint8_t carry_bit = get_bit(reg, 7);
-
-    uint8_t result = TU8(reg << 1);
-
-    set_flag(Z, result == 0);
-    set_flag(C, carry_bit);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    bc.l = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB22()
-{
-    uint8_t reg = de.h;
-    uint8_t carry_bit = get_bit(reg, 7);
-
-    uint8_t result = TU8(reg << 1);
-
-    set_flag(Z, result == 0);
-    set_flag(C, carry_bit);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    de.h = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB23()
-{
-    uint8_t reg = de.l;
-    uint8_t carry_bit = get_bit(reg, 7);
-
-    uint8_t result = TU8(reg << 1);
-
-    set_flag(Z, result == 0);
-    set_flag(C, carry_bit);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    de.l = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB24()
-{
-    uint8_t reg = hl.h;
-    uint8_t carry_bit = get_bit(reg, 7);
-
-    uint8_t result = TU8(reg << 1);
-
-    set_flag(Z, result == 0);
-    set_flag(C, carry_bit);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    hl.h = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB25()
-{
-    uint8_t reg = hl.l;
-    uint8_t carry_bit = get_bit(reg, 7);
-
-    uint8_t result = TU8(reg << 1);
-
-    set_flag(Z, result == 0);
-    set_flag(C, carry_bit);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    hl.l = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB26()
-{
-    uint8_t reg = mmu->read(hl.get());
-    uint8_t carry_bit = get_bit(reg, 7);
-
-    uint8_t result = TU8(reg << 1);
-
-    set_flag(Z, result == 0);
-    set_flag(C, carry_bit);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    mmu->write(hl.get(), result);
-
-    return 0;
-}
-
-int CPU::opcodeCB27()
-{
-    uint8_t reg = af.h;
-    uint8_t carry_bit = get_bit(reg, 7);
-
-    uint8_t result = TU8(reg << 1);
-
-    set_flag(Z, result == 0);
-    set_flag(C, carry_bit);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    af.h = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB28()
-{
-    uint8_t reg = bc.h;
-    uint8_t carry_bit = get_bit(reg, 0);
-    uint8_t top_bit = get_bit(reg, 7);
-
-    uint8_t result = TU8(reg >> 1);
-    set_bit(result, 7, top_bit);
-
-    set_flag(Z, result == 0);
-    set_flag(C, carry_bit);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    bc.h = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB29()
-{
-    uint8_t reg = bc.l;
-    uint8_t carry_bit = get_bit(reg, 0);
-    uint8_t top_bit = get_bit(reg, 7);
-
-    uint8_t result = TU8(reg >> 1);
-    set_bit(result, 7, top_bit);
-
-    set_flag(Z, result == 0);
-    set_flag(C, carry_bit);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    bc.l = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB2A()
-{
-    uint8_t reg = de.h;
-    uint8_t carry_bit = get_bit(reg, 0);
-    uint8_t top_bit = get_bit(reg, 7);
-
-    uint8_t result = TU8(reg >> 1);
-    set_bit(result, 7, top_bit);
-
-    set_flag(Z, result == 0);
-    set_flag(C, carry_bit);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    de.h = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB2B()
-{
-    uint8_t reg = de.l;
-    uint8_t carry_bit = get_bit(reg, 0);
-    uint8_t top_bit = get_bit(reg, 7);
-
-    uint8_t result = TU8(reg >> 1);
-    set_bit(result, 7, top_bit);
-
-    set_flag(Z, result == 0);
-    set_flag(C, carry_bit);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    de.l = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB2C()
-{
-    uint8_t reg = hl.h;
-    uint8_t carry_bit = get_bit(reg, 0);
-    uint8_t top_bit = get_bit(reg, 7);
-
-    uint8_t result = TU8(reg >> 1);
-    set_bit(result, 7, top_bit);
-
-    set_flag(Z, result == 0);
-    set_flag(C, carry_bit);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    hl.h = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB2D()
-{
-    uint8_t reg = hl.l;
-    uint8_t carry_bit = get_bit(reg, 0);
-    uint8_t top_bit = get_bit(reg, 7);
-
-    uint8_t result = TU8(reg >> 1);
-    set_bit(result, 7, top_bit);
-
-    set_flag(Z, result == 0);
-    set_flag(C, carry_bit);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    hl.l = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB2E()
-{
-    uint8_t reg = mmu->read(hl.get());
-    uint8_t carry_bit = get_bit(reg, 0);
-    uint8_t top_bit = get_bit(reg, 7);
-
-    uint8_t result = TU8(reg >> 1);
-    set_bit(result, 7, top_bit);
-
-    set_flag(Z, result == 0);
-    set_flag(C, carry_bit);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    mmu->write(hl.get(), result);
-
-    return 0;
-}
-
-int CPU::opcodeCB2F()
-{
-    uint8_t reg = af.h;
-    uint8_t carry_bit = get_bit(reg, 0);
-    uint8_t top_bit = get_bit(reg, 7);
-
-    uint8_t result = TU8(reg >> 1);
-    set_bit(result, 7, top_bit);
-
-    set_flag(Z, result == 0);
-    set_flag(C, carry_bit);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    af.h = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB30()
-{
-    uint8_t reg = bc.h;
-    uint8_t lower_nibble = reg & 0x0F;
-    uint8_t upper_nibble = (reg & 0xF0) >> 4;
-
-    uint8_t result = combine_nibbles(upper_nibble, lower_nibble);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-    
-    bc.h = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB31()
-{
-    uint8_t reg = bc.l;
-    uint8_t lower_nibble = reg & 0x0F;
-    uint8_t upper_nibble = (reg & 0xF0) >> 4;
-
-    uint8_t result = combine_nibbles(upper_nibble, lower_nibble);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
-    bc.l = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB32()
-{
-    uint8_t reg = de.h;
-    uint8_t lower_nibble = reg & 0x0F;
-    uint8_t upper_nibble = (reg & 0xF0) >> 4;
-
-    uint8_t result = combine_nibbles(upper_nibble, lower_nibble);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
-    de.h = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB33()
-{
-    uint8_t reg = de.l;
-    uint8_t lower_nibble = reg & 0x0F;
-    uint8_t upper_nibble = (reg & 0xF0) >> 4;
-
-    uint8_t result = combine_nibbles(upper_nibble, lower_nibble);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
-    de.l = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB34()
-{
-    uint8_t reg = hl.h;
-    uint8_t lower_nibble = reg & 0x0F;
-    uint8_t upper_nibble = (reg & 0xF0) >> 4;
-
-    uint8_t result = combine_nibbles(upper_nibble, lower_nibble);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
-    hl.h = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB35()
-{
-    uint8_t reg = hl.l;
-    uint8_t lower_nibble = reg & 0x0F;
-    uint8_t upper_nibble = (reg & 0xF0) >> 4;
-
-    uint8_t result = combine_nibbles(upper_nibble, lower_nibble);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
-    hl.l = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB36()
-{
-    uint8_t reg = mmu->read(hl.get());
-    uint8_t lower_nibble = reg & 0x0F;
-    uint8_t upper_nibble = (reg & 0xF0) >> 4;
-
-    uint8_t result = combine_nibbles(upper_nibble, lower_nibble);
-
-    set_flag(Z, result == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
-    mmu->write(hl.get(), result);
-
-    return 0;
-}
-
-int CPU::opcodeCB37()
-{
-    af.h = (af.h << 4) | (af.h >> 4);
-    
-    set_flag(Z, af.h == 0);
-    set_flag(N, 0);
-    set_flag(H, 0);
-    set_flag(C, 0);
-
-    return 0;
-}
-
-int CPU::opcodeCB38()
-{
-    uint8_t reg = bc.h;
-    bool least_bit_set = get_bit(reg, 0);
-
-    uint8_t result = (reg >> 1);
-    
-    set_flag(C, least_bit_set);
-    set_flag(Z, result == 0);
-    set_flag(H, 0);
-    set_flag(N, 0);
-    
-    bc.h = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB39()
-{
-    uint8_t reg = bc.l;
-    bool least_bit_set = get_bit(reg, 0);
-
-    uint8_t result = (reg >> 1);
-
-    set_flag(C, least_bit_set);
-    set_flag(Z, result == 0);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    bc.l = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB3A()
-{
-    uint8_t reg = de.h;
-    bool least_bit_set = get_bit(reg, 0);
-
-    uint8_t result = (reg >> 1);
-
-    set_flag(C, least_bit_set);
-    set_flag(Z, result == 0);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    de.h = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB3B()
-{
-    uint8_t reg = de.l;
-    bool least_bit_set = get_bit(reg, 0);
-
-    uint8_t result = (reg >> 1);
-
-    set_flag(C, least_bit_set);
-    set_flag(Z, result == 0);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    de.l = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB3C()
-{
-    uint8_t reg = hl.h;
-    bool least_bit_set = get_bit(reg, 0);
-
-    uint8_t result = (reg >> 1);
-
-    set_flag(C, least_bit_set);
-    set_flag(Z, result == 0);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    hl.h = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB3D()
-{
-    uint8_t reg = hl.l;
-    bool least_bit_set = get_bit(reg, 0);
-
-    uint8_t result = (reg >> 1);
-
-    set_flag(C, least_bit_set);
-    set_flag(Z, result == 0);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    hl.l = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB3E()
-{
-    uint8_t reg = mmu->read(hl.get());
-    bool least_bit_set = get_bit(reg, 0);
-
-    uint8_t result = (reg >> 1);
-
-    set_flag(C, least_bit_set);
-    set_flag(Z, result == 0);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    mmu->write(hl.get(), result);
-
-    return 0;
-}
-
-int CPU::opcodeCB3F()
-{
-    uint8_t reg = af.h;
-    bool least_bit_set = get_bit(reg, 0);
-
-    uint8_t result = (reg >> 1);
-
-    set_flag(C, least_bit_set);
-    set_flag(Z, result == 0);
-    set_flag(H, 0);
-    set_flag(N, 0);
-
-    af.h = result;
-
-    return 0;
-}
-
-int CPU::opcodeCB40()
-{
-    uint8_t reg = bc.h;
-    bool bit = get_bit(reg, 0);
-    
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB41()
-{
-    uint8_t reg = bc.l;
-    bool bit = get_bit(reg, 0);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB42()
-{
-    uint8_t reg = de.h;
-    bool bit = get_bit(reg, 0);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB43()
-{
-    uint8_t reg = de.l;
-    bool bit = get_bit(reg, 0);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB44()
-{
-    uint8_t reg = hl.h;
-    bool bit = get_bit(reg, 0);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB45()
-{
-    uint8_t reg = hl.l;
-    bool bit = get_bit(reg, 0);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB46()
-{
-    uint8_t reg = mmu->read(hl.get());
-    bool bit = get_bit(reg, 0);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB47()
-{
-    uint8_t reg = af.h;
-    bool bit = get_bit(reg, 0);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB48()
-{
-    uint8_t reg = bc.h;
-    bool bit = get_bit(reg, 1);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB49()
-{
-    uint8_t reg = bc.l;
-    bool bit = get_bit(reg, 1);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB4A()
-{
-    uint8_t reg = de.h;
-    bool bit = get_bit(reg, 1);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB4B()
-{
-    uint8_t reg = de.l;
-    bool bit = get_bit(reg, 1);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB4C()
-{
-    uint8_t reg = hl.h;
-    bool bit = get_bit(reg, 1);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB4D()
-{
-    uint8_t reg = hl.l;
-    bool bit = get_bit(reg, 1);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB4E()
-{
-    uint8_t reg = mmu->read(hl.get());
-    bool bit = get_bit(reg, 1);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB4F()
-{
-    uint8_t reg = af.h;
-    bool bit = get_bit(reg, 1);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB50()
-{
-    uint8_t reg = bc.h;
-    bool bit = get_bit(reg, 2);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB51()
-{
-    uint8_t reg = bc.l;
-    bool bit = get_bit(reg, 2);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB52()
-{
-    uint8_t reg = de.h;
-    bool bit = get_bit(reg, 2);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB53()
-{
-    uint8_t reg = de.l;
-    bool bit = get_bit(reg, 2);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB54()
-{
-    uint8_t reg = hl.h;
-    bool bit = get_bit(reg, 2);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB55()
-{
-    uint8_t reg = hl.l;
-    bool bit = get_bit(reg, 2);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB56()
-{
-    uint8_t reg = mmu->read(hl.get());
-    bool bit = get_bit(reg, 2);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB57()
-{
-    uint8_t reg = af.h;
-    bool bit = get_bit(reg, 2);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB58()
-{
-    uint8_t reg = bc.h;
-    bool bit = get_bit(reg, 3);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB59()
-{
-    uint8_t reg = bc.l;
-    bool bit = get_bit(reg, 3);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB5A()
-{
-    uint8_t reg = de.h;
-    bool bit = get_bit(reg, 3);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB5B()
-{
-    uint8_t reg = de.l;
-    bool bit = get_bit(reg, 3);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB5C()
-{
-    uint8_t reg = hl.h;
-    bool bit = get_bit(reg, 3);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB5D()
-{
-    uint8_t reg = hl.l;
-    bool bit = get_bit(reg, 3);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB5E()
-{
-    uint8_t reg = mmu->read(hl.get());
-    bool bit = get_bit(reg, 3);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB5F()
-{
-    uint8_t reg = af.h;
-    bool bit = get_bit(reg, 3);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB60()
-{
-    uint8_t reg = bc.h;
-    bool bit = get_bit(reg, 4);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB61()
-{
-    uint8_t reg = bc.l;
-    bool bit = get_bit(reg, 4);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB62()
-{
-    uint8_t reg = de.h;
-    bool bit = get_bit(reg, 4);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB63()
-{
-    uint8_t reg = de.l;
-    bool bit = get_bit(reg, 4);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB64()
-{
-    uint8_t reg = hl.h;
-    bool bit = get_bit(reg, 4);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB65()
-{
-    uint8_t reg = hl.l;
-    bool bit = get_bit(reg, 4);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB66()
-{
-    uint8_t reg = mmu->read(hl.get());
-    bool bit = get_bit(reg, 4);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB67()
-{
-    uint8_t reg = af.h;
-    bool bit = get_bit(reg, 4);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB68()
-{
-    uint8_t reg = bc.h;
-    bool bit = get_bit(reg, 5);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB69()
-{
-    uint8_t reg = bc.l;
-    bool bit = get_bit(reg, 5);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB6A()
-{
-    uint8_t reg = de.h;
-    bool bit = get_bit(reg, 5);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB6B()
-{
-    uint8_t reg = de.l;
-    bool bit = get_bit(reg, 5);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB6C()
-{
-    uint8_t reg = hl.h;
-    bool bit = get_bit(reg, 5);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB6D()
-{
-    uint8_t reg = hl.l;
-    bool bit = get_bit(reg, 5);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB6E()
-{
-    uint8_t reg = mmu->read(hl.get());
-    bool bit = get_bit(reg, 5);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB6F()
-{
-    uint8_t reg = af.h;
-    bool bit = get_bit(reg, 5);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB70()
-{
-    uint8_t reg = bc.h;
-    bool bit = get_bit(reg, 6);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB71()
-{
-    uint8_t reg = bc.l;
-    bool bit = get_bit(reg, 6);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB72()
-{
-    uint8_t reg = de.h;
-    bool bit = get_bit(reg, 6);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB73()
-{
-    uint8_t reg = de.l;
-    bool bit = get_bit(reg, 6);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB74()
-{
-    uint8_t reg = hl.h;
-    bool bit = get_bit(reg, 6);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB75()
-{
-    uint8_t reg = hl.l;
-    bool bit = get_bit(reg, 6);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB76()
-{
-    uint8_t reg = mmu->read(hl.get());
-    bool bit = get_bit(reg, 6);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB77()
-{
-    uint8_t reg = af.h;
-    bool bit = get_bit(reg, 6);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB78()
-{
-    uint8_t reg = bc.h;
-    bool bit = get_bit(reg, 7);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB79()
-{
-    uint8_t reg = bc.l;
-    bool bit = get_bit(reg, 7);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB7A()
-{
-    uint8_t reg = de.h;
-    bool bit = get_bit(reg, 7);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB7B()
-{
-    uint8_t reg = de.l;
-    bool bit = get_bit(reg, 7);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB7C()
-{
-    bool bit = get_bit(hl.h, 7);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-    
-    return 0;
-}
-
-int CPU::opcodeCB7D()
-{
-    uint8_t reg = hl.l;
-    bool bit = get_bit(reg, 7);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB7E()
-{
-    uint8_t reg = mmu->read(hl.get());
-    bool bit = get_bit(reg, 7);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB7F()
-{
-    uint8_t reg = af.h;
-    bool bit = get_bit(reg, 7);
-
-    set_flag(Z, !bit);
-    set_flag(N, 0);
-    set_flag(H, 1);
-
-    return 0;
-}
-
-int CPU::opcodeCB80()
-{
-    uint8_t reg = bc.h;
-    int bit = 0;
-    set_bit(reg, bit, 0);
-    
-    bc.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB81()
-{
-    uint8_t reg = bc.l;
-    int bit = 0;
-    set_bit(reg, bit, 0);
-
-    bc.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB82()
-{
-    uint8_t reg = de.h;
-    int bit = 0;
-    set_bit(reg, bit, 0);
-
-    de.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB83()
-{
-    uint8_t reg = de.l;
-    int bit = 0;
-    set_bit(reg, bit, 0);
-
-    de.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB84()
-{
-    uint8_t reg = hl.h;
-    int bit = 0;
-    set_bit(reg, bit, 0);
-
-    hl.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB85()
-{
-    uint8_t reg = hl.l;
-    int bit = 0;
-    set_bit(reg, bit, 0);
-
-    hl.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB86()
-{
-    uint8_t reg = mmu->read(hl.get());
-    int bit = 0;
-    set_bit(reg, bit, 0);
-
-    mmu->write(hl.get(), reg);
-
-    return 0;
-}
-
-int CPU::opcodeCB87()
-{
-    uint8_t reg = af.h;
-    int bit = 0;
-    set_bit(reg, bit, 0);
-
-    af.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB88()
-{
-    uint8_t reg = bc.h;
-    int bit = 1;
-    set_bit(reg, bit, 0);
-
-    bc.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB89()
-{
-    uint8_t reg = bc.l;
-    int bit = 1;
-    set_bit(reg, bit, 0);
-
-    bc.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB8A()
-{
-    uint8_t reg = de.h;
-    int bit = 1;
-    set_bit(reg, bit, 0);
-
-    de.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB8B()
-{
-    uint8_t reg = de.l;
-    int bit = 1;
-    set_bit(reg, bit, 0);
-
-    de.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB8C()
-{
-    uint8_t reg = hl.h;
-    int bit = 1;
-    set_bit(reg, bit, 0);
-    
-    hl.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB8D()
-{
-    set_bit(hl.l, 1, 0);
-    return 0;
-}
-
-int CPU::opcodeCB8E()
-{
-    uint8_t reg = mmu->read(hl.get());
-    set_bit(reg, 1, 0);
-
-    mmu->write(hl.get(), reg);
-    return 0;
-}
-
-int CPU::opcodeCB8F()
-{
-    set_bit(af.h, 1, 0);
-    return 0;
-}
-
-int CPU::opcodeCB90()
-{
-    uint8_t reg = bc.h;
-    int bit = 2;
-    set_bit(reg, bit, 0);
-
-    bc.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB91()
-{
-    uint8_t reg = bc.l;
-    int bit = 2;
-    set_bit(reg, bit, 0);
-
-    bc.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB92()
-{
-    uint8_t reg = de.h;
-    int bit = 2;
-    set_bit(reg, bit, 0);
-
-    de.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB93()
-{
-    uint8_t reg = de.l;
-    int bit = 2;
-    set_bit(reg, bit, 0);
-
-    de.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB94()
-{
-    uint8_t reg = hl.h;
-    int bit = 2;
-    set_bit(reg, bit, 0);
-
-    hl.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB95()
-{
-    uint8_t reg = hl.l;
-    int bit = 2;
-    set_bit(reg, bit, 0);
-
-    hl.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB96()
-{
-    uint8_t reg = mmu->read(hl.get());
-    int bit = 2;
-    set_bit(reg, bit, 0);
-
-    mmu->write(hl.get(), reg);
-
-    return 0;
-}
-
-int CPU::opcodeCB97()
-{
-    uint8_t reg = af.h;
-    int bit = 2;
-    set_bit(reg, bit, 0);
-
-    af.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB98()
-{
-    uint8_t reg = bc.h;
-    int bit = 3;
-    set_bit(reg, bit, 0);
-
-    bc.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB99()
-{
-    uint8_t reg = bc.l;
-    int bit = 3;
-    set_bit(reg, bit, 0);
-
-    bc.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB9A()
-{
-    uint8_t reg = de.h;
-    int bit = 3;
-    set_bit(reg, bit, 0);
-
-    de.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB9B()
-{
-    uint8_t reg = de.l;
-    int bit = 3;
-    set_bit(reg, bit, 0);
-
-    de.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB9C()
-{
-    uint8_t reg = hl.h;
-    int bit = 3;
-    set_bit(reg, bit, 0);
-
-    hl.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB9D()
-{
-    uint8_t reg = hl.l;
-    int bit = 3;
-    set_bit(reg, bit, 0);
-
-    hl.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCB9E()
-{
-    uint8_t reg = mmu->read(hl.get());
-    int bit = 3;
-    set_bit(reg, bit, 0);
-
-   mmu->write(hl.get(), reg);
-
-    return 0;
-}
-
-int CPU::opcodeCB9F()
-{
-    uint8_t reg = af.h;
-    int bit = 3;
-    set_bit(reg, bit, 0);
-
-    af.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBA0()
-{
-    uint8_t reg = bc.h;
-    int bit = 4;
-    set_bit(reg, bit, 0);
-
-    bc.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBA1()
-{
-    uint8_t reg = bc.l;
-    int bit = 4;
-    set_bit(reg, bit, 0);
-
-    bc.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBA2()
-{
-    uint8_t reg = de.h;
-    int bit = 4;
-    set_bit(reg, bit, 0);
-
-    de.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBA3()
-{
-    uint8_t reg = de.l;
-    int bit = 4;
-    set_bit(reg, bit, 0);
-
-    de.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBA4()
-{
-    uint8_t reg = hl.h;
-    int bit = 4;
-    set_bit(reg, bit, 0);
-
-    hl.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBA5()
-{
-    uint8_t reg = hl.l;
-    int bit = 4;
-    set_bit(reg, bit, 0);
-
-    hl.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBA6()
-{
-    uint8_t reg = mmu->read(hl.get());
-    int bit = 4;
-    set_bit(reg, bit, 0);
-
-    mmu->write(hl.get(), reg);
-
-    return 0;
-}
-
-int CPU::opcodeCBA7()
-{
-    uint8_t reg = af.h;
-    int bit = 4;
-    set_bit(reg, bit, 0);
-
-    af.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBA8()
-{
-    uint8_t reg = bc.h;
-    int bit = 5;
-    set_bit(reg, bit, 0);
-
-    bc.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBA9()
-{
-    uint8_t reg = bc.l;
-    int bit = 5;
-    set_bit(reg, bit, 0);
-
-    bc.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBAA()
-{
-    uint8_t reg = de.h;
-    int bit = 5;
-    set_bit(reg, bit, 0);
-
-    de.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBAB()
-{
-    uint8_t reg = de.l;
-    int bit = 5;
-    set_bit(reg, bit, 0);
-
-    de.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBAC()
-{
-    uint8_t reg = hl.h;
-    int bit = 5;
-    set_bit(reg, bit, 0);
-
-    hl.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBAD()
-{
-    uint8_t reg = hl.l;
-    int bit = 5;
-    set_bit(reg, bit, 0);
-
-    hl.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBAE()
-{
-    uint8_t reg = mmu->read(hl.get());
-    int bit = 5;
-    set_bit(reg, bit, 0);
-
-    mmu->write(hl.get(), reg);
-
-    return 0;
-}
-
-int CPU::opcodeCBAF()
-{
-    uint8_t reg = af.h;
-    int bit = 5;
-    set_bit(reg, bit, 0);
-
-    af.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBB0()
-{
-    uint8_t reg = bc.h;
-    int bit = 6;
-    set_bit(reg, bit, 0);
-
-    bc.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBB1()
-{
-    uint8_t reg = bc.l;
-    int bit = 6;
-    set_bit(reg, bit, 0);
-
-    bc.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBB2()
-{
-    uint8_t reg = de.h;
-    int bit = 6;
-    set_bit(reg, bit, 0);
-
-    de.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBB3()
-{
-    uint8_t reg = de.l;
-    int bit = 6;
-    set_bit(reg, bit, 0);
-
-    de.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBB4()
-{
-    uint8_t reg = hl.h;
-    int bit = 6;
-    set_bit(reg, bit, 0);
-
-    hl.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBB5()
-{
-    uint8_t reg = hl.l;
-    int bit = 6;
-    set_bit(reg, bit, 0);
-
-    hl.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBB6()
-{
-    uint8_t reg = mmu->read(hl.get());
-    int bit = 6;
-    set_bit(reg, bit, 0);
-
-    mmu->write(hl.get(), reg);
-
-    return 0;
-}
-
-int CPU::opcodeCBB7()
-{
-    uint8_t reg = af.h;
-    int bit = 6;
-    set_bit(reg, bit, 0);
-
-    af.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBB8()
-{
-    uint8_t reg = bc.h;
-    int bit = 7;
-    set_bit(reg, bit, 0);
-
-    bc.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBB9()
-{
-    uint8_t reg = bc.l;
-    int bit = 7;
-    set_bit(reg, bit, 0);
-
-    bc.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBBA()
-{
-    uint8_t reg = de.h;
-    int bit = 7;
-    set_bit(reg, bit, 0);
-
-    de.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBBB()
-{
-    uint8_t reg = de.l;
-    int bit = 7;
-    set_bit(reg, bit, 0);
-
-    de.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBBC()
-{
-    uint8_t reg = hl.h;
-    int bit = 7;
-    set_bit(reg, bit, 0);
-
-    hl.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBBD()
-{
-    uint8_t reg = hl.l;
-    int bit = 7;
-    set_bit(reg, bit, 0);
-
-    hl.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBBE()
-{
-    uint8_t reg = mmu->read(hl.get());
-    int bit = 7;
-    set_bit(reg, bit, 0);
-
-    mmu->write(hl.get(), reg);
-
-    return 0;
-}
-
-int CPU::opcodeCBBF()
-{
-    uint8_t reg = af.h;
-    int bit = 7;
-    set_bit(reg, bit, 0);
-
-    af.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBC0()
-{
-    uint8_t reg = bc.h;
-    int bit = 0;
-    set_bit(reg, bit, 1);
-
-    bc.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBC1()
-{
-    uint8_t reg = bc.l;
-    int bit = 0;
-    set_bit(reg, bit, 1);
-
-    bc.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBC2()
-{
-    uint8_t reg = de.h;
-    int bit = 0;
-    set_bit(reg, bit, 1);
-
-    de.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBC3()
-{
-    uint8_t reg = de.l;
-    int bit = 0;
-    set_bit(reg, bit, 1);
-
-    de.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBC4()
-{
-    uint8_t reg = hl.h;
-    int bit = 0;
-    set_bit(reg, bit, 1);
-
-    hl.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBC5()
-{
-    uint8_t reg = hl.l;
-    int bit = 0;
-    set_bit(reg, bit, 1);
-
-    hl.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBC6()
-{
-    uint8_t reg = mmu->read(hl.get());
-    int bit = 0;
-    set_bit(reg, bit, 1);
-
-    mmu->write(hl.get(), reg);
-
-    return 0;
-}
-
-int CPU::opcodeCBC7()
-{
-    uint8_t reg = af.h;
-    int bit = 0;
-    set_bit(reg, bit, 1);
-
-    af.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBC8()
-{
-    uint8_t reg = bc.h;
-    int bit = 1;
-    set_bit(reg, bit, 1);
-
-    bc.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBC9()
-{
-    uint8_t reg = bc.l;
-    int bit = 1;
-    set_bit(reg, bit, 1);
-
-    bc.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBCA()
-{
-    uint8_t reg = de.h;
-    int bit = 1;
-    set_bit(reg, bit, 1);
-
-    de.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBCB()
-{
-    uint8_t reg = de.l;
-    int bit = 1;
-    set_bit(reg, bit, 1);
-
-    de.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBCC()
-{
-    uint8_t reg = hl.h;
-    int bit = 1;
-    set_bit(reg, bit, 1);
-
-    hl.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBCD()
-{
-    uint8_t reg = hl.l;
-    int bit = 1;
-    set_bit(reg, bit, 1);
-
-    hl.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBCE()
-{
-    uint8_t reg = mmu->read(hl.get());
-    int bit = 1;
-    set_bit(reg, bit, 1);
-
-    mmu->write(hl.get(), reg);
-
-    return 0;
-}
-
-int CPU::opcodeCBCF()
-{
-    uint8_t reg = af.h;
-    int bit = 1;
-    set_bit(reg, bit, 1);
-
-    af.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBD0()
-{
-    uint8_t reg = bc.h;
-    int bit = 2;
-    set_bit(reg, bit, 1);
-
-    bc.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBD1()
-{
-    uint8_t reg = bc.l;
-    int bit = 2;
-    set_bit(reg, bit, 1);
-
-    bc.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBD2()
-{
-    uint8_t reg = de.h;
-    int bit = 2;
-    set_bit(reg, bit, 1);
-
-    de.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBD3()
-{
-    uint8_t reg = de.l;
-    int bit = 2;
-    set_bit(reg, bit, 1);
-
-    de.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBD4()
-{
-    uint8_t reg = hl.h;
-    int bit = 2;
-    set_bit(reg, bit, 1);
-
-    hl.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBD5()
-{
-    uint8_t reg = hl.l;
-    int bit = 2;
-    set_bit(reg, bit, 1);
-
-    hl.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBD6()
-{
-    uint8_t reg = mmu->read(hl.get());
-    int bit = 2;
-    set_bit(reg, bit, 1);
-
-    mmu->write(hl.get(), reg);
-
-    return 0;
-}
-
-int CPU::opcodeCBD7()
-{
-    uint8_t reg = af.h;
-    int bit = 2;
-    set_bit(reg, bit, 1);
-
-    af.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBD8()
-{
-    uint8_t reg = bc.h;
-    int bit = 3;
-    set_bit(reg, bit, 1);
-
-    bc.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBD9()
-{
-    uint8_t reg = bc.l;
-    int bit = 3;
-    set_bit(reg, bit, 1);
-
-    bc.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBDA()
-{
-    uint8_t reg = de.h;
-    int bit = 3;
-    set_bit(reg, bit, 1);
-
-    de.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBDB()
-{
-    uint8_t reg = de.l;
-    int bit = 3;
-    set_bit(reg, bit, 1);
-
-    de.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBDC()
-{
-    uint8_t reg = hl.h;
-    int bit = 3;
-    set_bit(reg, bit, 1);
-
-    hl.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBDD()
-{
-    uint8_t reg = hl.l;
-    int bit = 3;
-    set_bit(reg, bit, 1);
-
-    hl.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBDE()
-{
-    uint8_t reg = mmu->read(hl.get());
-    int bit = 3;
-    set_bit(reg, bit, 1);
-
-    mmu->write(hl.get(), reg);
-
-    return 0;
-}
-
-int CPU::opcodeCBDF()
-{
-    uint8_t reg = af.h;
-    int bit = 3;
-    set_bit(reg, bit, 1);
-
-    af.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBE0()
-{
-    uint8_t reg = bc.h;
-    int bit = 4;
-    set_bit(reg, bit, 1);
-
-    bc.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBE1()
-{
-    uint8_t reg = bc.l;
-    int bit = 4;
-    set_bit(reg, bit, 1);
-
-    bc.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBE2()
-{
-    uint8_t reg = de.h;
-    int bit = 4;
-    set_bit(reg, bit, 1);
-
-    de.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBE3()
-{
-    uint8_t reg = de.l;
-    int bit = 4;
-    set_bit(reg, bit, 1);
-
-    de.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBE4()
-{
-    uint8_t reg = hl.h;
-    int bit = 4;
-    set_bit(reg, bit, 1);
-
-    hl.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBE5()
-{
-    uint8_t reg = hl.l;
-    int bit = 4;
-    set_bit(reg, bit, 1);
-
-    hl.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBE6()
-{
-    uint8_t reg = mmu->read(hl.get());
-    int bit = 4;
-    set_bit(reg, bit, 1);
-
-    mmu->write(hl.get(), reg);
-
-    return 0;
-}
-
-int CPU::opcodeCBE7()
-{
-    uint8_t reg = af.h;
-    int bit = 4;
-    set_bit(reg, bit, 1);
-
-    af.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBE8()
-{
-    uint8_t reg = bc.h;
-    int bit = 5;
-    set_bit(reg, bit, 1);
-
-    bc.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBE9()
-{
-    uint8_t reg = bc.l;
-    int bit = 5;
-    set_bit(reg, bit, 1);
-
-    bc.l = reg;
-
-    return 0;
-}
+const std::array<Opcode, 256> CPU::cb_handlers = make_cb_handlers(std::make_index_sequence<256>());
 
-int CPU::opcodeCBEA()
+template <size_t... Codes>
+static constexpr std::array<HostCall, 256> make_cb_host_calls(std::index_sequence<Codes...>)
 {
-    uint8_t reg = de.h;
-    int bit = 5;
-    set_bit(reg, bit, 1);
-
-    de.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBEB()
-{
-    uint8_t reg = de.l;
-    int bit = 5;
-    set_bit(reg, bit, 1);
-
-    de.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBEC()
-{
-    uint8_t reg = hl.h;
-    int bit = 5;
-    set_bit(reg, bit, 1);
-
-    hl.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBED()
-{
-    uint8_t reg = hl.l;
-    int bit = 5;
-    set_bit(reg, bit, 1);
-
-    hl.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBEE()
-{
-    uint8_t reg = mmu->read(hl.get());
-    int bit = 5;
-    set_bit(reg, bit, 1);
-
-    mmu->write(hl.get(), reg);
-
-    return 0;
-}
-
-int CPU::opcodeCBEF()
-{
-    uint8_t reg = af.h;
-    int bit = 5;
-    set_bit(reg, bit, 1);
-
-    af.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBF0()
-{
-    uint8_t reg = bc.h;
-    int bit = 6;
-    set_bit(reg, bit, 1);
-
-    bc.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBF1()
-{
-    uint8_t reg = bc.l;
-    int bit = 6;
-    set_bit(reg, bit, 1);
-
-    bc.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBF2()
-{
-    uint8_t reg = de.h;
-    int bit = 6;
-    set_bit(reg, bit, 1);
-
-    de.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBF3()
-{
-    uint8_t reg = de.l;
-    int bit = 6;
-    set_bit(reg, bit, 1);
-
-    de.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBF4()
-{
-    uint8_t reg = hl.h;
-    int bit = 6;
-    set_bit(reg, bit, 1);
-
-    hl.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBF5()
-{
-    uint8_t reg = hl.l;
-    int bit = 6;
-    set_bit(reg, bit, 1);
-
-    hl.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBF6()
-{
-    uint8_t reg = mmu->read(hl.get());
-    int bit = 6;
-    set_bit(reg, bit, 1);
-
-    mmu->write(hl.get(), reg);
-
-    return 0;
-}
-
-int CPU::opcodeCBF7()
-{
-    uint8_t reg = af.h;
-    int bit = 6;
-    set_bit(reg, bit, 1);
-
-    af.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBF8()
-{
-    uint8_t reg = bc.h;
-    int bit = 7;
-    set_bit(reg, bit, 1);
-
-    bc.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBF9()
-{
-    uint8_t reg = bc.l;
-    int bit = 7;
-    set_bit(reg, bit, 1);
-
-    bc.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBFA()
-{
-    uint8_t reg = de.h;
-    int bit = 7;
-    set_bit(reg, bit, 1);
-
-    de.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBFB()
-{
-    uint8_t reg = de.l;
-    int bit = 7;
-    set_bit(reg, bit, 1);
-
-    de.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBFC()
-{
-    uint8_t reg = hl.h;
-    int bit = 7;
-    set_bit(reg, bit, 1);
-
-    hl.h = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBFD()
-{
-    uint8_t reg = hl.l;
-    int bit = 7;
-    set_bit(reg, bit, 1);
-
-    hl.l = reg;
-
-    return 0;
-}
-
-int CPU::opcodeCBFE()
-{
-    uint8_t reg = mmu->read(hl.get());
-    int bit = 7;
-    set_bit(reg, bit, 1);
-
-    mmu->write(hl.get(), reg);
-
-    return 0;
+    return { &CPU::host_call<&CPU::cb_opcode<Codes>>... };
 }
 
-int CPU::opcodeCBFF()
-{
-    uint8_t reg = af.h;
-    int bit = 7;
-    set_bit(reg, bit, 1);
-
-    af.h = reg;
-
-    return 0;
-}
+const std::array<HostCall, 256> CPU::cb_host_calls = make_cb_host_calls(std::make_index_sequence<256>());
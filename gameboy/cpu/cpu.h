@@ -1,28 +1,24 @@
 #pragma once
-#include <map>
+#include <array>
 #include <cstdint>
 #include <string>
-#include <iomanip>
-#include <sstream>
-#include <fstream>
-#include <iostream>
 #include <functional>
 
 #include <cpu/timer.h>
+#include <cpu/dynarec.h>
+#include <cpu/blockcache.h>
+#include <cpu/tracer.h>
 
 std::string to_hex(uint16_t n, int d = 4);
 std::string to_hex_string(uint16_t num, int d = 4);
 
-#define BIND(x) std::bind(x, this)
-
 #define TU8(x) static_cast<uint8_t>(x)
 #define T8(x) static_cast<int8_t>(x)
 #define TU16(x) static_cast<uint16_t>(x)
+#define TU32(x) static_cast<uint32_t>(x)
 
 #define PCBREAK(addr) if (pc == addr) __debugbreak();
 
-using std::map;
-
 enum Flag : uint8_t {
 	C = 4,
 	H = 5,
@@ -30,11 +26,27 @@ enum Flag : uint8_t {
 	Z = 7
 };
 
+// Set to 0 to materialise the flags right after every ALU operation
+#ifndef LAZY_FLAGS
+#define LAZY_FLAGS 1
+#endif
+
+// Last ALU result, Z/N/H/C are only derived from it when something reads them
+struct LazyFlags {
+	bool pending = false;
+	bool subtract = false; // N
+	uint8_t operands = 0;  // lhs ^ rhs, bit 4 of operands ^ result is the half carry
+	uint16_t result = 0;   // Bit 8 is the carry
+};
+
+class CPU;
+using Opcode = int (CPU::*)();
+using HostCall = int (*)(CPU*); // Plain function entry for code that cannot call members
+
+// Hot dispatch entry, the mnemonic lives in a separate cold table
 struct Instruction {
-	std::string name;
-	std::function<int()> exec = nullptr;
-	
-	uint32_t cycles = 0;
+	Opcode exec = nullptr;
+	uint8_t cycles = 0;
 };
 
 struct Register {
@@ -67,6 +79,10 @@ public:
 	~CPU() = default;
 
 	void register_opcodes();
+	void register_opcode(uint8_t code, const char* name, Opcode exec, uint8_t cycles);
+	void register_cb_opcode(uint8_t code, const char* name, Opcode exec, uint8_t cycles);
+
+	const char* mnemonic(uint16_t code) const;
 
 	static void set_bit(uint8_t& num, int b, bool v);
     static bool get_bit(uint8_t& num, int b);
@@ -78,6 +94,24 @@ public:
 
 	void set_flag(Flag f, bool val);
 	bool get_flag(Flag f);
+	bool zero_flag();
+	bool carry_flag();
+
+	void set_flags(bool z, bool n, bool h, bool c);
+
+	void defer_flags(uint16_t result, uint8_t operands, bool subtract);
+	void resolve_flags();
+	void materialise_flags();
+
+	/* ALU helpers, they only record the flags */
+	void alu_add(uint8_t value, bool carry = false);
+	void alu_sub(uint8_t value, bool carry = false);
+	void alu_cp(uint8_t value);
+	void alu_and(uint8_t value);
+	void alu_or(uint8_t value);
+	void alu_xor(uint8_t value);
+	uint8_t alu_inc(uint8_t value);
+	uint8_t alu_dec(uint8_t value);
 
 	/* Opcodes */
     int opcode00(); int opcode01(); int opcode02(); int opcode03(); int opcode04(); int opcode05(); int opcode06(); int opcode07(); int opcode08(); int opcode09(); int opcode0A(); int opcode0B(); int opcode0C(); int opcode0D(); int opcode0E(); int opcode0F();
@@ -97,33 +131,27 @@ public:
     int opcodeE0(); int opcodeE1(); int opcodeE2(); int opcodeE3(); int opcodeE4(); int opcodeE5(); int opcodeE6(); int opcodeE7(); int opcodeE8(); int opcodeE9(); int opcodeEA(); int opcodeEB(); int opcodeEC(); int opcodeED(); int opcodeEE(); int opcodeEF();
     int opcodeF0(); int opcodeF1(); int opcodeF2(); int opcodeF3(); int opcodeF4(); int opcodeF5(); int opcodeF6(); int opcodeF7(); int opcodeF8(); int opcodeF9(); int opcodeFA(); int opcodeFB(); int opcodeFC(); int opcodeFD(); int opcodeFE(); int opcodeFF();
 
-    /* CB Opcodes */
-    int opcodeCB00(); int opcodeCB01(); int opcodeCB02(); int opcodeCB03(); int opcodeCB04(); int opcodeCB05(); int opcodeCB06(); int opcodeCB07(); int opcodeCB08(); int opcodeCB09(); int opcodeCB0A(); int opcodeCB0B(); int opcodeCB0C(); int opcodeCB0D(); int opcodeCB0E(); int opcodeCB0F();
-    int opcodeCB10(); int opcodeCB11(); int opcodeCB12(); int opcodeCB13(); int opcodeCB14(); int opcodeCB15(); int opcodeCB16(); int opcodeCB17(); int opcodeCB18(); int opcodeCB19(); int opcodeCB1A(); int opcodeCB1B(); int opcodeCB1C(); int opcodeCB1D(); int opcodeCB1E(); int opcodeCB1F();
-    int opcodeCB20(); int opcodeCB21(); int opcodeCB22(); int opcodeCB23(); int opcodeCB24(); int opcodeCB25(); int opcodeCB26(); int opcodeCB27(); int opcodeCB28(); int opcodeCB29(); int opcodeCB2A(); int opcodeCB2B(); int opcodeCB2C(); int opcodeCB2D(); int opcodeCB2E(); int opcodeCB2F();
-    int opcodeCB30(); int opcodeCB31(); int opcodeCB32(); int opcodeCB33(); int opcodeCB34(); int opcodeCB35(); int opcodeCB36(); int opcodeCB37(); int opcodeCB38(); int opcodeCB39(); int opcodeCB3A(); int opcodeCB3B(); int opcodeCB3C(); int opcodeCB3D(); int opcodeCB3E(); int opcodeCB3F();
-    int opcodeCB40(); int opcodeCB41(); int opcodeCB42(); int opcodeCB43(); int opcodeCB44(); int opcodeCB45(); int opcodeCB46(); int opcodeCB47(); int opcodeCB48(); int opcodeCB49(); int opcodeCB4A(); int opcodeCB4B(); int opcodeCB4C(); int opcodeCB4D(); int opcodeCB4E(); int opcodeCB4F();
-    int opcodeCB50(); int opcodeCB51(); int opcodeCB52(); int opcodeCB53(); int opcodeCB54(); int opcodeCB55(); int opcodeCB56(); int opcodeCB57(); int opcodeCB58(); int opcodeCB59(); int opcodeCB5A(); int opcodeCB5B(); int opcodeCB5C(); int opcodeCB5D(); int opcodeCB5E(); int opcodeCB5F();
-    int opcodeCB60(); int opcodeCB61(); int opcodeCB62(); int opcodeCB63(); int opcodeCB64(); int opcodeCB65(); int opcodeCB66(); int opcodeCB67(); int opcodeCB68(); int opcodeCB69(); int opcodeCB6A(); int opcodeCB6B(); int opcodeCB6C(); int opcodeCB6D(); int opcodeCB6E(); int opcodeCB6F();
-    int opcodeCB70(); int opcodeCB71(); int opcodeCB72(); int opcodeCB73(); int opcodeCB74(); int opcodeCB75(); int opcodeCB76(); int opcodeCB77(); int opcodeCB78(); int opcodeCB79(); int opcodeCB7A(); int opcodeCB7B(); int opcodeCB7C(); int opcodeCB7D(); int opcodeCB7E(); int opcodeCB7F();
-    int opcodeCB80(); int opcodeCB81(); int opcodeCB82(); int opcodeCB83(); int opcodeCB84(); int opcodeCB85(); int opcodeCB86(); int opcodeCB87(); int opcodeCB88(); int opcodeCB89(); int opcodeCB8A(); int opcodeCB8B(); int opcodeCB8C(); int opcodeCB8D(); int opcodeCB8E(); int opcodeCB8F();
-    int opcodeCB90(); int opcodeCB91(); int opcodeCB92(); int opcodeCB93(); int opcodeCB94(); int opcodeCB95(); int opcodeCB96(); int opcodeCB97(); int opcodeCB98(); int opcodeCB99(); int opcodeCB9A(); int opcodeCB9B(); int opcodeCB9C(); int opcodeCB9D(); int opcodeCB9E(); int opcodeCB9F();
-    int opcodeCBA0(); int opcodeCBA1(); int opcodeCBA2(); int opcodeCBA3(); int opcodeCBA4(); int opcodeCBA5(); int opcodeCBA6(); int opcodeCBA7(); int opcodeCBA8(); int opcodeCBA9(); int opcodeCBAA(); int opcodeCBAB(); int opcodeCBAC(); int opcodeCBAD(); int opcodeCBAE(); int opcodeCBAF();
-    int opcodeCBB0(); int opcodeCBB1(); int opcodeCBB2(); int opcodeCBB3(); int opcodeCBB4(); int opcodeCBB5(); int opcodeCBB6(); int opcodeCBB7(); int opcodeCBB8(); int opcodeCBB9(); int opcodeCBBA(); int opcodeCBBB(); int opcodeCBBC(); int opcodeCBBD(); int opcodeCBBE(); int opcodeCBBF();
-    int opcodeCBC0(); int opcodeCBC1(); int opcodeCBC2(); int opcodeCBC3(); int opcodeCBC4(); int opcodeCBC5(); int opcodeCBC6(); int opcodeCBC7(); int opcodeCBC8(); int opcodeCBC9(); int opcodeCBCA(); int opcodeCBCB(); int opcodeCBCC(); int opcodeCBCD(); int opcodeCBCE(); int opcodeCBCF();
-    int opcodeCBD0(); int opcodeCBD1(); int opcodeCBD2(); int opcodeCBD3(); int opcodeCBD4(); int opcodeCBD5(); int opcodeCBD6(); int opcodeCBD7(); int opcodeCBD8(); int opcodeCBD9(); int opcodeCBDA(); int opcodeCBDB(); int opcodeCBDC(); int opcodeCBDD(); int opcodeCBDE(); int opcodeCBDF();
-    int opcodeCBE0(); int opcodeCBE1(); int opcodeCBE2(); int opcodeCBE3(); int opcodeCBE4(); int opcodeCBE5(); int opcodeCBE6(); int opcodeCBE7(); int opcodeCBE8(); int opcodeCBE9(); int opcodeCBEA(); int opcodeCBEB(); int opcodeCBEC(); int opcodeCBED(); int opcodeCBEE(); int opcodeCBEF();
-    int opcodeCBF0(); int opcodeCBF1(); int opcodeCBF2(); int opcodeCBF3(); int opcodeCBF4(); int opcodeCBF5(); int opcodeCBF6(); int opcodeCBF7(); int opcodeCBF8(); int opcodeCBF9(); int opcodeCBFA(); int opcodeCBFB(); int opcodeCBFC(); int opcodeCBFD(); int opcodeCBFE(); int opcodeCBFF();
+    /* CB Opcodes, specialised per (operation, bit, operand) */
+    template <uint8_t Code> int cb_opcode();
+    template <uint8_t Operand> uint8_t& cb_register();
+
+    static const std::array<Opcode, 256> cb_handlers;
+    static const std::array<HostCall, 256> cb_host_calls;
+
+    template <Opcode Handler> static int host_call(CPU* cpu) { return (cpu->*Handler)(); }
 
 	void reset();
 	uint32_t tick();
-    void update_timers(uint32_t cycle);
+	void trace(bool interrupt = false); // Records the state before each instruction while tracing is on
+	void set_tracing(bool enabled);
+	uint8_t fetch(); // Next immediate operand
 
     void interupt(uint32_t id);
     void handle_interupts();
 
 public:
-	map<uint16_t, Instruction> lookup;
+	Instruction lookup[256], cb_lookup[256];
+	const char* mnemonics[256] = {}, *cb_mnemonics[256] = {};
 	MMU* mmu;
 
 public:
@@ -132,13 +160,22 @@ public:
 	Register af, bc, de, hl;
 	uint16_t pc = 0, sp = 0;
 
+	LazyFlags lazy_flags;
+
 	uint32_t cycles = 0;
 
-    std::ofstream out;
     Timer cpu_timer;
 
     bool halted = false;
     bool interupts_enabled = true;
 
+    bool tracing = false; // Toggled by the frontend
+    Tracer tracer;
+
     uint32_t divider_counter = 0;
+
+    BlockCache block_cache;
+    const uint8_t* operand = nullptr; // Predecoded operands of the running instruction
+
+    Dynarec dynarec;
 };
\ No newline at end of file
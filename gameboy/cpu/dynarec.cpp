@@ -0,0 +1,773 @@
+#include "dynarec.h"
+#include <cpu/mmu.h>
+#include <cartridge/cartridge.h>
+#include <gameboy.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#if DYNAREC_X64
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#endif
+
+static constexpr size_t CODE_BUFFER_SIZE = 32 * 1024 * 1024; // Pages are only committed once code is written to them
+static constexpr size_t MAX_BLOCK_SIZE = 8192; // Worst case host code for one block
+static constexpr int MAX_BLOCK_INSTRUCTIONS = 64;
+static constexpr int MAX_BLOCK_CYCLES = 256; // Deadlines are checked after every instruction, this only bounds the block
+
+// Rough host cost of one guest instruction, in the same units on every path
+static constexpr int INTERPRETED_COST = 6; // cpu->tick(), the block cache lookup and an indirect call
+static constexpr int CALLED_COST = 4;      // Translated into a direct call to the shared handler
+static constexpr int INLINE_COST = 1;      // Translated into host code
+static constexpr int TRANSLATE_COST = 400; // Paid once per translated instruction
+
+static_assert(offsetof(LazyFlags, pending) == 0 && offsetof(LazyFlags, subtract) == 1 &&
+              offsetof(LazyFlags, operands) == 2 && offsetof(LazyFlags, result) == 4, "translated ALU code stores LazyFlags as 4 + 2 bytes");
+
+// Instructions after which the block may have to stop, see Dynarec::on_write
+static bool writes_memory(uint8_t op, uint8_t cb)
+{
+    if (op == 0xCB)
+        return (cb & 0x07) == 6 && (cb >> 6) != 1; // Everything on (HL) but BIT
+
+    switch (op) {
+    case 0x02: case 0x08: case 0x12: case 0x22: case 0x32: case 0x34: case 0x35: case 0x36:
+    case 0x70: case 0x71: case 0x72: case 0x73: case 0x74: case 0x75: case 0x77:
+    case 0xC5: case 0xD5: case 0xE0: case 0xE2: case 0xE5: case 0xEA: case 0xF5:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// JR cc and JP cc, translated inline as the last instruction of a block
+static bool conditional_jump(uint8_t op)
+{
+    return (op & 0xE7) == 0x20 || (op & 0xE7) == 0xC2;
+}
+
+// Instructions translate() writes out as host code, everything else calls the handler the interpreter uses
+static bool inlined(uint8_t op)
+{
+    switch (op) {
+    case 0x00: case 0x18: case 0xC3: // NOP, JR e, JP nn
+    case 0x20: case 0x28: case 0x30: case 0x38: case 0xC2: case 0xCA: case 0xD2: case 0xDA: // JR cc, JP cc
+    case 0x01: case 0x11: case 0x21: case 0x31: // LD rr,nn
+    case 0x03: case 0x13: case 0x23: case 0x33: case 0x0B: case 0x1B: case 0x2B: case 0x3B: // INC rr, DEC rr
+    case 0x06: case 0x0E: case 0x16: case 0x1E: case 0x26: case 0x2E: case 0x3E: // LD r,n
+        return true;
+    case 0xC6: case 0xD6: case 0xE6: case 0xEE: case 0xF6: case 0xFE: // ADD SUB AND XOR OR CP with n
+        return LAZY_FLAGS;
+    }
+
+    if (op >= 0x40 && op < 0x80) // LD r,r', not through (HL)
+        return (op & 0x07) != 6 && ((op >> 3) & 0x07) != 6;
+
+    if (op >= 0x80 && op < 0xC0) { // ADD SUB AND XOR OR CP with r, ADC and SBC need the carry resolved
+        int group = (op >> 3) & 0x07;
+        return LAZY_FLAGS && (op & 0x07) != 6 && group != 1 && group != 3;
+    }
+
+    return false;
+}
+
+#define HOST_CALL(code) &CPU::host_call<&CPU::opcode##code>
+#define HOST_CALL_ROW(h) \
+    HOST_CALL(h##0), HOST_CALL(h##1), HOST_CALL(h##2), HOST_CALL(h##3), \
+    HOST_CALL(h##4), HOST_CALL(h##5), HOST_CALL(h##6), HOST_CALL(h##7), \
+    HOST_CALL(h##8), HOST_CALL(h##9), HOST_CALL(h##A), HOST_CALL(h##B), \
+    HOST_CALL(h##C), HOST_CALL(h##D), HOST_CALL(h##E), HOST_CALL(h##F)
+
+static const HostCall base_host_calls[256] = {
+    HOST_CALL_ROW(0), HOST_CALL_ROW(1), HOST_CALL_ROW(2), HOST_CALL_ROW(3),
+    HOST_CALL_ROW(4), HOST_CALL_ROW(5), HOST_CALL_ROW(6), HOST_CALL_ROW(7),
+    HOST_CALL_ROW(8), HOST_CALL_ROW(9), HOST_CALL_ROW(A), HOST_CALL_ROW(B),
+    HOST_CALL_ROW(C), HOST_CALL_ROW(D), HOST_CALL_ROW(E), HOST_CALL_ROW(F)
+};
+
+#undef HOST_CALL_ROW
+#undef HOST_CALL
+
+// Everything a guest instruction can change outside memory, used by the differential mode
+struct MachineState {
+    Register af, bc, de, hl;
+    uint16_t pc = 0, sp = 0, opcode = 0;
+    bool halted = false, interupts_enabled = false;
+
+    uint8_t rom_bank = 0, ram_bank = 0;
+    bool memory_enabled = false, rom_banking = false;
+
+    Scheduler::State scheduler = {};
+    Timer::State timer = {};
+};
+
+static MachineState capture(CPU* cpu)
+{
+    MachineState state;
+    Cartridge* cart = cpu->mmu->cartridge.get();
+
+    cpu->resolve_flags();
+    state.af = cpu->af; state.bc = cpu->bc; state.de = cpu->de; state.hl = cpu->hl;
+    state.pc = cpu->pc; state.sp = cpu->sp; state.opcode = cpu->opcode;
+    state.halted = cpu->halted; state.interupts_enabled = cpu->interupts_enabled;
+
+    state.rom_bank = cart->current_rom_bank; state.ram_bank = cart->current_ram_bank;
+    state.memory_enabled = cart->memory_enabled; state.rom_banking = cart->rom_banking;
+
+    state.scheduler = cpu->mmu->gb->scheduler.save_state();
+    state.timer = cpu->cpu_timer.save_state();
+
+    return state;
+}
+
+static void restore(CPU* cpu, const MachineState& state)
+{
+    Cartridge* cart = cpu->mmu->cartridge.get();
+
+    cpu->lazy_flags = LazyFlags();
+    cpu->af = state.af; cpu->bc = state.bc; cpu->de = state.de; cpu->hl = state.hl;
+    cpu->pc = state.pc; cpu->sp = state.sp; cpu->opcode = state.opcode;
+    cpu->halted = state.halted; cpu->interupts_enabled = state.interupts_enabled;
+
+    cart->current_rom_bank = state.rom_bank; cart->current_ram_bank = state.ram_bank;
+    cart->memory_enabled = state.memory_enabled; cart->rom_banking = state.rom_banking;
+
+    cpu->mmu->gb->scheduler.load_state(state.scheduler);
+    cpu->cpu_timer.load_state(state.timer);
+
+    cpu->mmu->map_pages();
+}
+
+// Scheduler::previous is left out, the translated run only keeps now current
+static bool same_state(const MachineState& a, const MachineState& b)
+{
+    return a.af.h == b.af.h && a.af.l == b.af.l && a.bc.h == b.bc.h && a.bc.l == b.bc.l &&
+           a.de.h == b.de.h && a.de.l == b.de.l && a.hl.h == b.hl.h && a.hl.l == b.hl.l &&
+           a.pc == b.pc && a.sp == b.sp && a.opcode == b.opcode && a.halted == b.halted &&
+           a.interupts_enabled == b.interupts_enabled && a.rom_bank == b.rom_bank && a.ram_bank == b.ram_bank &&
+           a.scheduler.now == b.scheduler.now && memcmp(a.scheduler.deadlines, b.scheduler.deadlines, sizeof(a.scheduler.deadlines)) == 0 &&
+           a.timer.ticks == b.timer.ticks && a.timer.base_origin == b.timer.base_origin && a.timer.div_origin == b.timer.div_origin;
+}
+
+Dynarec::Dynarec(CPU* _cpu) : cpu(_cpu)
+{
+}
+
+Dynarec::~Dynarec()
+{
+#if DYNAREC_X64
+    if (code_buffer) {
+#ifdef _WIN32
+        VirtualFree(code_buffer, 0, MEM_RELEASE);
+#else
+        munmap(code_buffer, code_size);
+#endif
+    }
+#endif
+}
+
+void Dynarec::set_mode(DynarecMode _mode)
+{
+    if (!supported()) _mode = DynarecMode::Off;
+
+#if DYNAREC_X64
+    if (_mode != DynarecMode::Off && !code_buffer) {
+        // Below the handlers, so translated code reaches them with a direct call
+        uintptr_t handlers = RCAST(uintptr_t, base_host_calls[0]);
+        void* hint = handlers > 2 * CODE_BUFFER_SIZE ? RCAST(void*, (handlers - 2 * CODE_BUFFER_SIZE) & ~uintptr_t(0xFFFF)) : nullptr;
+
+#ifdef _WIN32
+        void* memory = VirtualAlloc(hint, CODE_BUFFER_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+        if (!memory) memory = VirtualAlloc(nullptr, CODE_BUFFER_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+#else
+        void* memory = mmap(hint, CODE_BUFFER_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) memory = nullptr;
+#endif
+        if (!memory) _mode = DynarecMode::Off;
+
+        code_buffer = static_cast<uint8_t*>(memory);
+        code_size = memory ? CODE_BUFFER_SIZE : 0;
+    }
+#endif
+
+    mode = _mode;
+
+    if (mode != DynarecMode::Off && !rom0) { // Left out of instances that never compile anything
+        rom0 = std::make_unique<Block*[]>(0x4000);
+        wram = std::make_unique<Block*[]>(0x2000);
+        hram = std::make_unique<Block*[]>(0x7F);
+        romx.resize(256);
+    }
+
+    flush(); // Also remaps the pages, the differential mode takes every write through MMU::write_slow
+
+    // Any cartridge write may be a bank switch under a running block
+    memset(code_pages, mode != DynarecMode::Off, 0x80);
+}
+
+void Dynarec::flush()
+{
+    if (rom0) {
+        std::fill(rom0.get(), rom0.get() + 0x4000, nullptr);
+        std::fill(wram.get(), wram.get() + 0x2000, nullptr);
+        std::fill(hram.get(), hram.get() + 0x7F, nullptr);
+    }
+
+    for (auto& table : romx)
+        table.reset();
+
+    blocks.clear();
+    code_used = 0;
+    resume = nullptr;
+
+    memset(code_pages + 0x80, 0, 0x80);
+    cpu->mmu->map_pages();
+}
+
+Block** Dynarec::slot(uint16_t addr)
+{
+    if (addr < 0x4000)
+        return &rom0[addr];
+
+    if (addr < 0x8000) { // Each bank keeps its blocks while the others are mapped in
+        auto& table = romx[cpu->mmu->cartridge->current_rom_bank];
+        if (!table) table = std::make_unique<Block*[]>(0x4000);
+
+        return &table[addr - 0x4000];
+    }
+
+    if (addr >= 0xC000 && addr < 0xE000)
+        return &wram[addr - 0xC000];
+    if (addr >= 0xFF80 && addr < 0xFFFF)
+        return &hram[addr - 0xFF80];
+
+    return nullptr;
+}
+
+Block* Dynarec::find_block(uint16_t addr)
+{
+    Block** entry = slot(addr);
+    if (!entry) return nullptr;
+
+    if (!*entry) *entry = decode(addr);
+    return *entry;
+}
+
+uint32_t Dynarec::execute()
+{
+    // The interpreter also owns the nintendo check bypass at 0x00FA and tracing
+    if (mode == DynarecMode::Off || cpu->halted || !cpu->mmu->memory[BOOTING] || cpu->pc == 0x00FA || cpu->tracing)
+        return cpu->tick();
+
+    // A block stopped at a deadline carries on from there, unless its code was overwritten or banked out since
+    Block* block = resume;
+    size_t first = resume_step;
+    resume = nullptr;
+
+    if (!block || mode == DynarecMode::Differential || cpu->pc != block->steps[first - 1].next || *slot(block->start) != block) {
+        block = find_block(cpu->pc);
+        first = 0;
+    }
+
+    if (!block) return cpu->tick();
+
+    // The differential mode compares every block, otherwise only the ones that have paid for themselves
+    if (!block->code && (mode == DynarecMode::Differential || (first == 0 && block->countdown >= 0 && block->countdown-- == 0))) {
+        if (code_size - code_used < MAX_BLOCK_SIZE) {
+            flush(); // Frees the block as well, it is decoded again on the next visit
+            return cpu->tick();
+        }
+
+        translate(block);
+    }
+
+    if (mode == DynarecMode::Differential)
+        return execute_differential(block);
+
+    // A run that stops after its first instruction costs less through the interpreter than through the host code
+    Scheduler& scheduler = cpu->mmu->gb->scheduler;
+    uint32_t base = first ? block->steps[first - 1].cycles : 0;
+
+    if (!block->code || scheduler.now + block->steps[first].cycles - base >= scheduler.next_deadline())
+        return interpret(block, first);
+
+    return run(block, first);
+}
+
+uint32_t Dynarec::run(Block* block, size_t first)
+{
+    uint64_t start = cpu->mmu->gb->scheduler.now;
+
+    running = true;
+    exit_block = false;
+
+    block->code(cpu, RCAST(const uint8_t*, block->code) + block->steps[first].host);
+    running = false;
+
+    uint32_t instructions = 0;
+    return finish(block, first, start, instructions);
+}
+
+// Stops where the translated code would, so both leave the scheduler alike
+uint32_t Dynarec::interpret(Block* block, size_t first)
+{
+    Scheduler& scheduler = cpu->mmu->gb->scheduler;
+
+    running = true;
+    exit_block = false;
+
+    size_t next = first + 1;
+    uint32_t cycles = cpu->tick();
+    for (; next < block->steps.size(); next++) {
+        if (exit_block || scheduler.now + cycles >= scheduler.next_deadline()) break;
+
+        scheduler.advance(cycles);
+        cycles = cpu->tick();
+    }
+
+    running = false;
+
+    if (next < block->steps.size()) {
+        resume = block;
+        resume_step = next;
+    }
+
+    return cycles;
+}
+
+// The host code leaves Scheduler::now after the last instruction it ran. All but the block's final instruction
+// take a fixed number of cycles, so the elapsed cycles tell which one that was. Like after cpu->tick(), the
+// scheduler is then put back before that instruction and its cycles are returned.
+uint32_t Dynarec::finish(Block* block, size_t first, uint64_t start, uint32_t& instructions)
+{
+    Scheduler& scheduler = cpu->mmu->gb->scheduler;
+    const std::vector<BlockStep>& steps = block->steps;
+
+    // Step cycles count from the block start, not from the step the run began at, and a loop starts over on
+    // every pass
+    uint64_t origin = start - (first ? steps[first - 1].cycles : 0);
+    uint64_t elapsed = scheduler.now - origin;
+    uint64_t pass = steps.back().cycles + (block->branches ? 1 : 0); // A conditional jump back is taken
+    uint64_t passes = block->loops ? (elapsed - 1) / pass : 0;
+
+    origin += passes * pass;
+    elapsed -= passes * pass;
+
+    auto last = std::lower_bound(steps.begin(), steps.end() - 1, elapsed,
+        [](const BlockStep& step, uint64_t cycles) { return step.cycles < cycles; });
+
+    uint32_t before = last == steps.begin() ? 0 : (last - 1)->cycles;
+    if (last != steps.end() - 1 || !block->branches) cpu->pc = last->next;
+    cpu->opcode = last->opcode;
+
+    scheduler.now = origin + before;
+    instructions = TU32(passes * steps.size() + size_t(last - steps.begin()) + 1 - first);
+
+    if (last != steps.end() - 1) {
+        resume = block;
+        resume_step = size_t(last - steps.begin()) + 1;
+    }
+
+    cpu->cycles = TU8(elapsed - before);
+    return cpu->cycles;
+}
+
+uint32_t Dynarec::execute_differential(Block* block)
+{
+    Scheduler& scheduler = cpu->mmu->gb->scheduler;
+
+    cpu->cpu_timer.sync();
+    MachineState before = capture(cpu);
+
+    // Pages are copied on their first write, I/O can also change without one, a timer interrupt for instance
+    written.clear();
+    tracking = true;
+    keep_page(cpu->mmu->memory + 0xFF00);
+
+    uint64_t start = scheduler.now;
+    running = true;
+    exit_block = false;
+
+    block->code(cpu, RCAST(const uint8_t*, block->code) + block->steps[0].host);
+    running = false;
+
+    uint32_t instructions = 0;
+    uint32_t result = finish(block, 0, start, instructions);
+
+    MachineState translated = capture(cpu);
+    size_t translated_pages = written.size();
+    for (PageCopy& page : written)
+        memcpy(page.after, page.memory, 0x100);
+
+    for (PageCopy& page : written)
+        memcpy(page.memory, page.before, 0x100);
+    restore(cpu, before);
+
+    uint32_t cycles = 0;
+    for (uint32_t i = 0; i < instructions; i++) {
+        if (i) scheduler.advance(cycles);
+        cycles = cpu->tick();
+    }
+
+    tracking = false;
+    MachineState reference = capture(cpu);
+
+    // Pages only the interpreter wrote still hold their old contents in the translated run
+    bool same = same_state(translated, reference) && cycles == result;
+    for (size_t i = 0; i < written.size() && same; i++)
+        same = memcmp(written[i].memory, i < translated_pages ? written[i].after : written[i].before, 0x100) == 0;
+
+    if (!same) {
+        mismatches++;
+
+        cpu->mmu->gb->log("Dynarec mismatch in block %04X bank %d | PC %04X / %04X AF %04X / %04X cycles %u / %u\n",
+            block->start, block->bank, translated.pc, reference.pc,
+            CPU::combine(translated.af.l, translated.af.h), CPU::combine(reference.af.l, reference.af.h), result, cycles);
+    }
+
+    return cycles; // The interpreter is the reference, its state is kept
+}
+
+// Host memory a write to the page lands in, nullptr for the MBC registers
+uint8_t* Dynarec::page_memory(uint8_t page)
+{
+    Cartridge* cart = cpu->mmu->cartridge.get();
+
+    if (page < 0x80) return nullptr;
+    if (page >= 0xA0 && page < 0xC0) return cart->memory + cart->current_ram_bank * 0x2000 + (page - 0xA0) * 0x100;
+    if (page >= 0xE0 && page < 0xFE) return cpu->mmu->memory + (page - 0x20) * 0x100; // Echo RAM
+
+    return cpu->mmu->memory + page * 0x100;
+}
+
+void Dynarec::keep_page(uint8_t* memory)
+{
+    if (!memory) return;
+
+    for (const PageCopy& page : written)
+        if (page.memory == memory) return;
+
+    written.emplace_back();
+    written.back().memory = memory;
+    memcpy(written.back().before, memory, 0x100);
+}
+
+void Dynarec::on_tracked_write(uint16_t addr)
+{
+    if (addr == DMA) keep_page(cpu->mmu->memory + SPRITE_ATTR);
+    keep_page(page_memory(addr >> 8));
+}
+
+void Dynarec::on_write(uint16_t addr)
+{
+    if (addr < 0x8000) { // MBC register, the bank mapped at 0x4000 may change
+        exit_block = running;
+        return;
+    }
+
+    if (addr >= 0xFF00 && (addr < 0xFF80 || addr == 0xFFFF))
+        return; // I/O registers share the page with HRAM
+
+    uint16_t page = addr & 0xFF00;
+    for (uint32_t a = page; a < page + 0x100u; a++) {
+        Block** entry = slot(TU16(a));
+        if (entry) *entry = nullptr;
+    }
+
+    code_pages[addr >> 8] = 0;
+    cpu->mmu->map_page(addr >> 8);
+
+    exit_block = running; // The running block may have just overwritten itself
+}
+
+// Events the write scheduled stop the block at the next deadline check, only an interrupt it made pending needs
+// the block to end now so CPU::handle_interupts sees it after this instruction
+void Dynarec::on_io_write()
+{
+    const uint8_t* memory = cpu->mmu->memory;
+    if (running && cpu->interupts_enabled && (memory[INTERUPT_FLAG] & memory[INTERUPT_ENABLE] & 0x1F))
+        exit_block = true;
+}
+
+uint8_t* Dynarec::emit_bytes(const void* bytes, size_t count)
+{
+    uint8_t* at = code_buffer + code_used;
+
+    memcpy(at, bytes, count);
+    code_used += count;
+
+    return at;
+}
+
+void Dynarec::emit_call(const void* function)
+{
+    int64_t offset = RCAST(int64_t, function) - RCAST(int64_t, code_buffer + code_used + 5);
+
+    if (offset == int32_t(offset)) {
+        emit<uint8_t>(0xE8); emit<int32_t>(int32_t(offset)); // call rel32
+    }
+    else {
+        emit_bytes("\x48\xB8", 2); emit<uint64_t>(RCAST(uint64_t, function)); // mov rax, function
+        emit_bytes("\xFF\xD0", 2); // call rax
+    }
+}
+
+// Reads the block once and works out how many entries translating it takes to pay off
+Block* Dynarec::decode(uint16_t addr)
+{
+    // Blocks never leave a bank or, in RAM, a page so invalidation stays per page
+    uint32_t base = 0, limit = 0;
+    if (addr < 0x4000) limit = 0x4000;
+    else if (addr < 0x8000) base = 0x4000, limit = 0x8000;
+    else if (addr >= 0xFF80) base = 0xFF80, limit = 0xFFFF;
+    else base = addr & 0xFF00, limit = base + 0x100;
+
+    auto block = std::make_unique<Block>();
+    block->start = addr;
+    block->bank = addr >= 0x4000 && addr < 0x8000 ? cpu->mmu->cartridge->current_rom_bank : 0;
+
+    uint32_t current = addr, cycles = 0;
+    int saving = 0;
+
+    while (block->steps.size() < MAX_BLOCK_INSTRUCTIONS && cycles < MAX_BLOCK_CYCLES) {
+        uint8_t op = cpu->mmu->read(TU16(current));
+        uint8_t cb = op == 0xCB ? cpu->mmu->read(TU16(current + 1)) : 0;
+
+        uint32_t length = BlockCache::opcode_length[op];
+        if (current + length > limit || current == 0x00FA) break;
+
+        const Instruction& instr = op == 0xCB ? cpu->cb_lookup[cb] : cpu->lookup[op];
+        cycles += instr.cycles;
+
+        BlockStep step;
+        step.next = TU16(current + length);
+        step.opcode = op == 0xCB ? CPU::combine(cb, 0xCB) : op;
+        step.cycles = TU16(cycles);
+
+        uint16_t target = 0;
+        if (op == 0x18 || op == 0x20 || op == 0x28 || op == 0x30 || op == 0x38)
+            target = TU16(step.next + T8(cpu->mmu->read(TU16(current + 1))));
+        else if (op == 0xC3 || conditional_jump(op))
+            target = CPU::combine(cpu->mmu->read(TU16(current + 1)), cpu->mmu->read(TU16(current + 2)));
+
+        // Translated jumps only leave their target behind, conditional ones set PC themselves
+        if (op == 0x18 || op == 0xC3) step.next = target;
+
+        block->steps.push_back(step);
+        block->branches = !inlined(op) || conditional_jump(op);
+        saving += INTERPRETED_COST - (inlined(op) ? INLINE_COST : CALLED_COST);
+
+        if (conditional_jump(op)) {
+            block->loops = target == addr;
+            break;
+        }
+
+        // Decoding goes on at the target of a jump that is translated inline, as long as it stays in range
+        current = step.next;
+        if (op == 0x18 || op == 0xC3) {
+            block->loops = current == addr;
+            if (block->loops || current < base || current >= limit) break;
+        }
+        else if (BlockCache::ends_block(op)) {
+            break;
+        }
+    }
+
+    if (block->steps.empty())
+        return nullptr;
+
+    // A block that saves nothing per entry stays with the interpreter
+    int cost = TRANSLATE_COST * int(block->steps.size());
+    block->countdown = saving > 0 ? cost / saving : -1;
+
+    if (addr >= 0x8000) {
+        code_pages[addr >> 8] = 1;
+        cpu->mmu->map_page(addr >> 8);
+    }
+
+    blocks.push_back(std::move(block));
+    return blocks.back().get();
+}
+
+// Inlined instructions work on the CPU fields directly, the others call the interpreter's handler. r14 holds
+// Scheduler::now and is stored before every call so timer reads see the right cycle. After each instruction
+// the block stops once now reaches the next deadline, where the interpreter would stop to run the due events.
+void Dynarec::translate(Block* block)
+{
+#if DYNAREC_X64
+    Scheduler& scheduler = cpu->mmu->gb->scheduler;
+
+    auto offset = [this](const void* field) { return int32_t(RCAST(const uint8_t*, field) - RCAST(const uint8_t*, cpu)); };
+    const int32_t pc_offset = offset(&cpu->pc);
+    const int32_t flags_offset = offset(&cpu->lazy_flags);
+    const int32_t exit_offset = offset(&exit_block);
+    const int32_t deadline_offset = int32_t(RCAST(const uint8_t*, &scheduler.next_deadline()) - RCAST(const uint8_t*, &scheduler.now));
+
+    // B C D E H L - A and BC DE HL SP, in the encoding's operand order
+    const int32_t regs[8] = { offset(&cpu->bc.h), offset(&cpu->bc.l), offset(&cpu->de.h), offset(&cpu->de.l),
+                              offset(&cpu->hl.h), offset(&cpu->hl.l), 0, offset(&cpu->af.h) };
+    const int32_t pairs[4] = { offset(&cpu->bc), offset(&cpu->de), offset(&cpu->hl), offset(&cpu->sp) };
+
+    uint8_t* entry = code_buffer + code_used;
+    std::vector<uint8_t*> exits; // rel32 fields of the early exits
+
+    // push rbx; push r14; push r15; sub rsp, 32 (keeps rsp 16 byte aligned, doubles as shadow space)
+    emit_bytes("\x53\x41\x56\x41\x57\x48\x83\xEC\x20", 9);
+#ifdef _WIN32
+    emit_bytes("\x48\x89\xCB", 3); // mov rbx, rcx
+#else
+    emit_bytes("\x48\x89\xFB", 3); // mov rbx, rdi
+#endif
+    emit_bytes("\x49\xBF", 2); emit<uint64_t>(RCAST(uint64_t, &scheduler.now)); // mov r15, &scheduler.now
+    emit_bytes("\x4D\x8B\x37", 3); // mov r14, [r15]
+#ifdef _WIN32
+    emit_bytes("\xFF\xE2", 2); // jmp rdx, to the step the block resumes at
+#else
+    emit_bytes("\xFF\xE6", 2); // jmp rsi, to the step the block resumes at
+#endif
+
+    for (size_t i = 0; i < block->steps.size(); i++) {
+        bool last = i + 1 == block->steps.size();
+        uint32_t current = i ? block->steps[i - 1].next : block->start;
+        block->steps[i].host = TU32(code_buffer + code_used - entry);
+
+        uint8_t op = cpu->mmu->read(TU16(current));
+        uint8_t cb = op == 0xCB ? cpu->mmu->read(TU16(current + 1)) : 0;
+        uint32_t length = BlockCache::opcode_length[op];
+        uint8_t n = length > 1 ? cpu->mmu->read(TU16(current + 1)) : 0;
+        uint8_t n2 = length > 2 ? cpu->mmu->read(TU16(current + 2)) : 0;
+
+        const Instruction& instr = op == 0xCB ? cpu->cb_lookup[cb] : cpu->lookup[op];
+        int dst = (op >> 3) & 0x07, src = op & 0x07, pair = op >> 4;
+
+        if (!inlined(op)) {
+            HostCall call = op == 0xCB ? CPU::cb_host_calls[cb] : base_host_calls[op];
+
+            // PC points past the opcode, the handler fetches the operands itself
+            emit_bytes("\x4D\x89\x37", 3); // mov [r15], r14
+            emit<uint8_t>(0xB8); emit<uint32_t>(TU16(current + (op == 0xCB ? 2 : 1))); // mov eax, pc
+            emit_bytes("\x66\x89\x83", 3); emit<int32_t>(pc_offset); // mov [rbx + pc], ax
+#ifdef _WIN32
+            emit_bytes("\x48\x89\xD9", 3); // mov rcx, rbx
+#else
+            emit_bytes("\x48\x89\xDF", 3); // mov rdi, rbx
+#endif
+            emit_call(RCAST(const void*, call));
+
+            if (last) emit_bytes("\x89\xC0\x49\x01\xC6", 5); // mov eax, eax; add r14, rax (a taken branch)
+        }
+        else if (conditional_jump(op)) { // Always last, stores PC itself and takes a cycle more when taken
+            uint16_t target = op < 0x40 ? TU16(current + 2 + T8(n)) : CPU::combine(n, n2);
+            bool carry = op & 0x10, set = op & 0x08;
+
+            // eax is non zero when the flag is set, read from the pending ALU result or else from F
+            emit_bytes("\x80\xBB", 2); emit<int32_t>(flags_offset); emit<uint8_t>(0); // cmp byte [rbx + lazy_flags.pending], 0
+            uint8_t* resolved = emit_bytes("\x74\0", 2); // je resolved
+            emit_bytes("\x0F\xB7\x83", 3); emit<int32_t>(flags_offset + 4); // movzx eax, word [rbx + lazy_flags.result]
+            if (carry) emit_bytes("\x25\x00\x01\x00\x00", 5); // and eax, 0x100
+            else emit_bytes("\x84\xC0\x0F\x94\xC0\x0F\xB6\xC0", 8); // test al, al; sete al; movzx eax, al
+            uint8_t* decided = emit_bytes("\xEB\0", 2); // jmp decided
+
+            resolved[1] = uint8_t(code_buffer + code_used - (resolved + 2));
+            emit_bytes("\x0F\xB6\x83", 3); emit<int32_t>(offset(&cpu->af.l)); // movzx eax, byte [rbx + f]
+            emit<uint8_t>(0x25); emit<uint32_t>(carry ? 0x10 : 0x80); // and eax, C or Z
+
+            decided[1] = uint8_t(code_buffer + code_used - (decided + 2));
+            emit_bytes("\x85\xC0", 2); // test eax, eax
+            uint8_t* taken = emit_bytes(set ? "\x75\0" : "\x74\0", 2); // jnz/jz taken
+
+            emit<uint8_t>(0xB8); emit<uint32_t>(TU16(current + length)); // mov eax, next
+            emit_bytes("\x66\x89\x83", 3); emit<int32_t>(pc_offset); // mov [rbx + pc], ax
+            emit_bytes("\x49\x83\xC6", 3); emit<uint8_t>(instr.cycles); // add r14, cycles
+            emit<uint8_t>(0xE9); // jmp exit
+            exits.push_back(emit_bytes("\0\0\0\0", 4));
+
+            taken[1] = uint8_t(code_buffer + code_used - (taken + 2));
+            emit<uint8_t>(0xB8); emit<uint32_t>(target); // mov eax, target
+            emit_bytes("\x66\x89\x83", 3); emit<int32_t>(pc_offset); // mov [rbx + pc], ax
+            emit_bytes("\x49\x83\xC6", 3); emit<uint8_t>(instr.cycles + 1); // add r14, cycles + 1
+            break; // Into the loop back below when the target is the block start
+        }
+        else if (op < 0x40 && (op & 0x0F) == 0x01) { // LD rr,nn
+            emit<uint8_t>(0xB8); emit<uint32_t>(CPU::combine(n, n2)); // mov eax, nn
+            emit_bytes("\x66\x89\x83", 3); emit<int32_t>(pairs[pair]); // mov [rbx + rr], ax
+        }
+        else if (op < 0x40 && (op & 0x07) == 0x03) { // INC rr, DEC rr
+            emit_bytes(op & 0x08 ? "\x66\xFF\x8B" : "\x66\xFF\x83", 3); emit<int32_t>(pairs[pair]); // dec/inc word [rbx + rr]
+        }
+        else if (op < 0x40 && (op & 0x07) == 0x06) { // LD r,n
+            emit_bytes("\xC6\x83", 2); emit<int32_t>(regs[dst]); emit<uint8_t>(n); // mov byte [rbx + r], n
+        }
+        else if (op >= 0x40 && op < 0x80) { // LD r,r'
+            emit_bytes("\x0F\xB6\x83", 3); emit<int32_t>(regs[src]); // movzx eax, byte [rbx + r']
+            emit_bytes("\x88\x83", 2); emit<int32_t>(regs[dst]); // mov [rbx + r], al
+        }
+        else if (op >= 0x80 && op != 0xC3) { // ALU with r or n, the flags are left pending like CPU::defer_flags does
+            emit_bytes("\x0F\xB6\x83", 3); emit<int32_t>(regs[7]); // movzx eax, byte [rbx + a]
+            if (op >= 0xC0) {
+                emit<uint8_t>(0xB9); emit<uint32_t>(n); // mov ecx, n
+            }
+            else {
+                emit_bytes("\x0F\xB6\x8B", 3); emit<int32_t>(regs[src]); // movzx ecx, byte [rbx + r]
+            }
+
+            // edx gets the result, eax the operands
+            switch (dst) {
+            case 0: emit_bytes("\x8D\x14\x08\x31\xC8", 5); break; // lea edx, [rax + rcx]; xor eax, ecx
+            case 2: case 7: emit_bytes("\x89\xC2\x29\xCA\x31\xC8", 6); break; // mov edx, eax; sub edx, ecx; xor eax, ecx
+            case 4: emit_bytes("\x21\xC8\x89\xC2\x83\xF0\x10", 7); break; // and eax, ecx; mov edx, eax; xor eax, 0x10 (H)
+            case 5: emit_bytes("\x31\xC8\x89\xC2", 4); break; // xor eax, ecx; mov edx, eax
+            case 6: emit_bytes("\x09\xC8\x89\xC2", 4); break; // or eax, ecx; mov edx, eax
+            }
+
+            if (dst != 7) {
+                emit_bytes("\x88\x93", 2); emit<int32_t>(regs[7]); // mov [rbx + a], dl
+            }
+
+            // lazy_flags = { true, subtract, operands, result }
+            bool subtract = dst == 2 || dst == 7;
+            emit_bytes("\xC1\xE0\x10", 3); // shl eax, 16
+            emit<uint8_t>(0x0D); emit<uint32_t>(subtract ? 0x0101 : 0x0001); // or eax, pending | subtract
+            emit_bytes("\x89\x83", 2); emit<int32_t>(flags_offset); // mov [rbx + lazy_flags], eax
+            emit_bytes("\x66\x89\x93", 3); emit<int32_t>(flags_offset + 4); // mov [rbx + lazy_flags.result], dx
+        }
+        // NOP, JR e and JP nn leave nothing to do, finish() sets PC
+
+        emit_bytes("\x49\x83\xC6", 3); emit<uint8_t>(instr.cycles); // add r14, cycles
+        if (last) break;
+
+        if (writes_memory(op, cb)) {
+            emit_bytes("\x80\xBB", 2); emit<int32_t>(exit_offset); emit<uint8_t>(0); // cmp byte [rbx + exit_block], 0
+            emit_bytes("\x0F\x85", 2); // jne exit
+            exits.push_back(emit_bytes("\0\0\0\0", 4));
+        }
+
+        emit_bytes("\x4D\x3B\xB7", 3); emit<int32_t>(deadline_offset); // cmp r14, [r15 + next deadline]
+        emit_bytes("\x0F\x83", 2); // jae exit
+        exits.push_back(emit_bytes("\0\0\0\0", 4));
+    }
+
+    if (block->loops) { // Round again from the first step until the next deadline
+        emit_bytes("\x4D\x3B\xB7", 3); emit<int32_t>(deadline_offset); // cmp r14, [r15 + next deadline]
+        emit_bytes("\x0F\x82", 2); // jb first step
+        emit<int32_t>(int32_t(entry + block->steps[0].host - (code_buffer + code_used + 4)));
+    }
+
+    uint8_t* exit = code_buffer + code_used;
+    for (uint8_t* rel : exits) {
+        int32_t offset = TU32(exit - (rel + 4));
+        memcpy(rel, &offset, 4);
+    }
+
+    emit_bytes("\x4D\x89\x37", 3); // mov [r15], r14
+    // add rsp, 32; pop r15; pop r14; pop rbx; ret
+    emit_bytes("\x48\x83\xC4\x20\x41\x5F\x41\x5E\x5B\xC3", 10);
+
+    block->code = RCAST(Block::HostCode, entry);
+#endif
+}
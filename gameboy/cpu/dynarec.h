@@ -0,0 +1,109 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define DYNAREC_X64 1
+#else
+#define DYNAREC_X64 0
+#endif
+
+enum class DynarecMode {
+	Off,
+	On,
+	Differential // Runs every block on both backends and compares the results
+};
+
+class CPU;
+
+// One instruction of a block, enough to stop the block after it
+struct BlockStep {
+	uint16_t next = 0;   // PC after it, the target for a jump translated inline, so the next step's address
+	uint16_t opcode = 0; // 0xCBxx for the prefixed ones
+	uint16_t cycles = 0; // Base cycles from the block start through this instruction
+	uint32_t host = 0;   // Offset of its translated code from the block's entry
+};
+
+// Guest basic block, interpreted until it has run often enough to pay for translating it
+struct Block {
+	using HostCode = void(*)(CPU*, const uint8_t* step);
+
+	HostCode code = nullptr; // Starts at the given step's code, moves Scheduler::now along and stops at its next deadline
+	uint16_t start = 0;
+	uint8_t bank = 0;
+	bool branches = false; // The last instruction is a handler call that sets PC itself
+	bool loops = false; // Ends with a jump back to start, the host code repeats it until a deadline
+	int countdown = 0; // Interpreted entries left before it is translated, negative when it never pays off
+	std::vector<BlockStep> steps;
+};
+
+class Dynarec {
+public:
+	Dynarec(CPU* _cpu);
+	~Dynarec();
+
+	void set_mode(DynarecMode _mode);
+	bool supported() const { return DYNAREC_X64; }
+
+	uint32_t execute();
+	void flush();
+
+	void on_write(uint16_t addr); // Writes into pages flagged in code_pages
+	void on_io_write(); // Stops the block when the write leaves an interrupt to take
+
+	// Differential mode, MMU::write_slow reports every write while a block is compared
+	void on_tracked_write(uint16_t addr);
+
+private:
+	Block* find_block(uint16_t addr);
+	Block* decode(uint16_t addr);
+	void translate(Block* block);
+	Block** slot(uint16_t addr);
+
+	uint32_t run(Block* block, size_t first);
+	uint32_t interpret(Block* block, size_t first);
+	uint32_t finish(Block* block, size_t first, uint64_t start, uint32_t& instructions);
+	uint32_t execute_differential(Block* block);
+
+	uint8_t* page_memory(uint8_t page);
+	void keep_page(uint8_t* memory);
+
+	uint8_t* emit_bytes(const void* bytes, size_t count);
+	template <typename T> void emit(T value) { emit_bytes(&value, sizeof(T)); }
+	void emit_call(const void* function);
+
+public:
+	DynarecMode mode = DynarecMode::Off;
+
+	// One flag per 256 byte page, set for the cartridge and for RAM pages that hold decoded blocks
+	uint8_t code_pages[256] = {};
+
+	uint64_t mismatches = 0;
+	bool tracking = false; // Set while a differential run is compared, writes are logged into written
+
+private:
+	CPU* cpu;
+
+	// Direct mapped block tables: rom bank 0, one table per switchable bank, WRAM and HRAM
+	std::unique_ptr<Block*[]> rom0, wram, hram;
+	std::vector<std::unique_ptr<Block*[]>> romx;
+	std::vector<std::unique_ptr<Block>> blocks;
+
+	uint8_t* code_buffer = nullptr;
+	size_t code_size = 0, code_used = 0;
+
+	// Pages a differential run wrote, with their contents from before it and after the translated run
+	struct PageCopy {
+		uint8_t* memory;
+		uint8_t before[0x100], after[0x100];
+	};
+	std::vector<PageCopy> written;
+
+	bool running = false;
+	bool exit_block = false; // Polled by the host code after every guest store
+
+	// Block that stopped at a deadline before its end, the next visit picks it up at resume_step
+	Block* resume = nullptr;
+	size_t resume_step = 0;
+};
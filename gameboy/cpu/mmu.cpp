@@ -6,16 +6,38 @@
 #pragma warning(disable : 6385)
 #pragma warning(disable : 6386)
 
-uint8_t MMU::read(uint16_t address)
+MMU::MMU()
+{
+	register_io(DMA, nullptr, [this](uint16_t address, uint8_t data) {
+		dma_transfer(data);
+		memory[address] = data;
+	});
+
+	register_io(BOOTING, nullptr, [this](uint16_t address, uint8_t data) {
+		if (memory[address]) return; // Like on hardware, nothing maps the boot rom back in
+		memory[address] = data;
+		map_page(0); // Unmaps the boot rom
+	});
+}
+
+void MMU::register_io(uint16_t address, std::function<uint8_t(uint16_t)> read, std::function<void(uint16_t, uint8_t)> write)
+{
+	IOHandler& handler = io_handler(address);
+
+	handler.read = read;
+	handler.write = write;
+}
+
+uint8_t MMU::read_slow(uint16_t address)
 {
 	uint8_t data = 0x00;
-	LCDMode mode = gb->ppu.mode;
 
-	if (address >= 0x0000 && address <= 0x00FF && !memory[BOOTING]) {
-		data = bios[address];
+	if (is_io(address)) {
+		IOHandler& handler = io_handler(address);
+		data = handler.read ? handler.read(address) : memory[address];
 	}
-	else if (address == JOYPAD) {
-		data = gb->joypad.read();
+	else if (address >= 0x0000 && address <= 0x00FF && !memory[BOOTING]) {
+		data = bios[address];
 	}
 	else if (address >= 0x0000 && address <= 0x7FFF) {
 		data = cartridge->read(address);
@@ -30,17 +52,34 @@ uint8_t MMU::read(uint16_t address)
 	return data;
 }
 
-uint8_t& MMU::get(uint16_t address)
+void MMU::write_slow(uint16_t address, uint8_t data)
 {
-	std::reference_wrapper<uint8_t> data = cartridge->data[0];
+	Dynarec& dynarec = gb->cpu.dynarec;
+	if (dynarec.tracking) dynarec.on_tracked_write(address);
 
-	data = memory[address];
-	return data.get();
-}
+	if (is_io(address)) {
+		IOHandler& handler = io_handler(address);
 
-void MMU::write(uint16_t address, uint8_t data)
-{
-	LCDMode mode = gb->ppu.mode;
+		if (handler.write) handler.write(address, data);
+		else memory[address] = data;
+
+		dynarec.on_io_write();
+		return;
+	}
+
+	BlockCache& block_cache = gb->cpu.block_cache;
+	if (block_cache.code_pages[address >> 8]) block_cache.on_write(address);
+
+	if (dynarec.code_pages[address >> 8]) dynarec.on_write(address);
+
+	PPU& ppu = gb->ppu;
+	if (ppu.render_thread.running()) {
+		if ((address >= VRAM && address < VRAM + VRAM_SIZE) || (address >= SPRITE_ATTR && address < SPRITE_ATTR + OAM_SIZE))
+			ppu.render_thread.write(address, data);
+	}
+	else if (TileCache::covers(address)) {
+		ppu.renderer.tile_cache.on_write(address);
+	}
 
 	if (address < 0x8000) {
 		cartridge->write(address, data);
@@ -48,25 +87,63 @@ void MMU::write(uint16_t address, uint8_t data)
 	else if (address >= 0xA000 && address <= 0xBFFF) {
 		cartridge->write(address, data);
 	}
-	else if (address == DMA) {
-		dma_transfer(data);
-	}
-	else if (address == DIV || address == LY) {
-		memory[address] = 0;
-	}
-	if (address >= 0xE000 && address < 0xFE00) { // Echo Ram
+
+	if (address >= 0xE000 && address < 0xFE00) { // Echo Ram, only stored in the WRAM it mirrors
+		if (block_cache.code_pages[(address - 0x2000) >> 8]) block_cache.on_write(address - 0x2000);
+		if (dynarec.code_pages[(address - 0x2000) >> 8]) dynarec.on_write(address - 0x2000);
+
 		memory[address - 0x2000] = data;
-		memory[address] = data;
-	}
-	else if (address == JOYPAD) {
-		memory[address] = data & 0x30;
 	}
 	else {
 		memory[address] = data;
 	}
 }
 
-void MMU::copy_bootrom(uint8_t* rom)
+void MMU::map_pages()
+{
+	for (int page = 0; page < 256; page++)
+		map_page(page);
+}
+
+void MMU::map_page(uint8_t page)
+{
+	uint8_t* read = nullptr;
+	uint8_t* write = nullptr;
+
+	if (page == 0 && !memory[BOOTING]) {
+		read = bios;
+	}
+	else if (page < 0x80) { // Writes go to the MBC
+		if (cartridge) {
+			uint32_t offset = page * 0x100;
+			if (page >= 0x40) // Banks past the end of data wrap around
+				offset = (page - 0x40) * 0x100 + (cartridge->current_rom_bank % 128) * 0x4000;
+
+			read = cartridge->data + offset;
+		}
+	}
+	else if (page >= 0xA0 && page < 0xC0) { // Writes depend on the RAM enable
+		if (cartridge)
+			read = cartridge->memory + cartridge->current_ram_bank * 0x2000 + (page - 0xA0) * 0x100;
+	}
+	else if (page != 0xFF) { // I/O and HRAM always take the slow path
+		bool echo = page >= 0xE0 && page < 0xFE; // Writes check the code in the WRAM page behind it
+		read = memory + (echo ? page - 0x20 : page) * 0x100;
+
+		bool code = gb->cpu.block_cache.code_pages[page] || gb->cpu.dynarec.code_pages[page];
+		bool tiles = TileCache::covers(page << 8); // Writes mark decoded tiles dirty
+		bool queued = gb->ppu.render_thread.running() && ((page >= 0x80 && page < 0xA0) || page == 0xFE); // Copied to the render thread
+		bool tracked = gb->cpu.dynarec.mode == DynarecMode::Differential; // Written pages are compared
+
+		if (!echo && !code && !tiles && !queued && !tracked)
+			write = memory + page * 0x100;
+	}
+
+	read_pages[page] = read;
+	write_pages[page] = write;
+}
+
+void MMU::copy_bootrom(const uint8_t* rom)
 {
 	for (int i = 0; i < 256; i++)
 		bios[i] = rom[i];
@@ -2,6 +2,7 @@
 #include <cpu/cpu.h>
 #include <vector>
 #include <memory>
+#include <functional>
 
 using std::shared_ptr;
 
@@ -16,24 +17,65 @@ using std::shared_ptr;
 
 #define BOOTING 0xFF50
 
+// Callbacks for one I/O register, an empty one reads or stores memory as is
+struct IOHandler {
+	std::function<uint8_t(uint16_t)> read;
+	std::function<void(uint16_t, uint8_t)> write;
+};
+
 class Cartridge;
 class GameBoy;
 class MMU {
 public:
-	MMU() = default;
+	MMU();
 	~MMU() = default;
 
-	uint8_t read(uint16_t addr);	
-	uint8_t& get(uint16_t addr); // VERY UNSAFE USE ONLY IF NECCESSARY
+	uint8_t read(uint16_t addr);
 	void write(uint16_t addr, uint8_t data);
 
-	void copy_bootrom(uint8_t* rom);
+	// Subsystems claim their registers in 0xFF00-0xFF7F and IE here
+	void register_io(uint16_t addr, std::function<uint8_t(uint16_t)> read, std::function<void(uint16_t, uint8_t)> write);
+
+	// Rebuilds the page tables, needed after bank switches, unmapping the boot rom and code page changes
+	void map_pages();
+	void map_page(uint8_t page);
+
+	void copy_bootrom(const uint8_t* rom);
 	void dma_transfer(uint8_t data);
 
+private:
+	uint8_t read_slow(uint16_t addr);
+	void write_slow(uint16_t addr, uint8_t data);
+
+	static bool is_io(uint16_t addr) { return addr >= 0xFF00 && (addr < 0xFF80 || addr == INTERUPT_ENABLE); }
+	IOHandler& io_handler(uint16_t addr) { return io[addr == INTERUPT_ENABLE ? 0x80 : addr - 0xFF00]; }
+
 public:
 	shared_ptr<Cartridge> cartridge;
 	GameBoy* gb;
 
 public:
-	uint8_t bios[256], memory[0x10000];
-};
\ No newline at end of file
+	uint8_t bios[256] = {}, memory[0x10000] = {};
+
+	// Host pointer for each 256 byte page, nullptr sends the access through the slow path
+	uint8_t* read_pages[256] = {};
+	uint8_t* write_pages[256] = {};
+
+	IOHandler io[0x81]; // 0xFF00-0xFF7F, then IE
+};
+
+inline uint8_t MMU::read(uint16_t addr)
+{
+	if (const uint8_t* page = read_pages[addr >> 8])
+		return page[addr & 0xFF];
+
+	return read_slow(addr);
+}
+
+inline void MMU::write(uint16_t addr, uint8_t data)
+{
+	if (uint8_t* page = write_pages[addr >> 8])
+		page[addr & 0xFF] = data;
+	else
+		write_slow(addr, data);
+}
\ No newline at end of file
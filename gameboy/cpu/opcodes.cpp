@@ -2,522 +2,294 @@
 
 void CPU::register_opcodes()
 {
-    lookup[0x00] = { "NOP", BIND(&CPU::opcode00), 1};
-    lookup[0x01] = { "LD",  BIND(&CPU::opcode01), 3};
-    lookup[0x02] = { "LD",  BIND(&CPU::opcode02), 2};
-    lookup[0x03] = { "INC", BIND(&CPU::opcode03), 2};
-    lookup[0x04] = { "INC", BIND(&CPU::opcode04), 1};
-    lookup[0x05] = { "DEC", BIND(&CPU::opcode05), 1};
-    lookup[0x06] = { "LD", BIND(&CPU::opcode06), 2};
-    lookup[0x07] = { "RLCA", BIND(&CPU::opcode07), 1};
-    lookup[0x08] = { "LD", BIND(&CPU::opcode08), 5};
-    lookup[0x09] = { "ADD", BIND(&CPU::opcode09), 2};
-    lookup[0x0A] = { "LD", BIND(&CPU::opcode0A), 2};
-    lookup[0x0B] = { "DEC", BIND(&CPU::opcode0B), 2};
-    lookup[0x0C] = { "INC", BIND(&CPU::opcode0C), 1};
-    lookup[0x0D] = { "DEC", BIND(&CPU::opcode0D), 1};
-    lookup[0x0E] = { "LD", BIND(&CPU::opcode0E), 2};
-    lookup[0x0F] = { "RRCA", BIND(&CPU::opcode0F), 1};
-    lookup[0x10] = { "STOP", BIND(&CPU::opcode10), 1};
-    lookup[0x11] = { "LD", BIND(&CPU::opcode11), 3};
-    lookup[0x12] = { "LD", BIND(&CPU::opcode12), 2};
-    lookup[0x13] = { "INC", BIND(&CPU::opcode13), 2};
-    lookup[0x14] = { "INC", BIND(&CPU::opcode14), 1};
-    lookup[0x15] = { "DEC", BIND(&CPU::opcode15), 1};
-    lookup[0x16] = { "LD", BIND(&CPU::opcode16), 2};
-    lookup[0x17] = { "RLA", BIND(&CPU::opcode17), 1};
-    lookup[0x18] = { "JR", BIND(&CPU::opcode18), 3};
-    lookup[0x19] = { "ADD", BIND(&CPU::opcode19), 2};
-    lookup[0x1A] = { "LD", BIND(&CPU::opcode1A), 2};
-    lookup[0x1B] = { "DEC", BIND(&CPU::opcode1B), 2};
-    lookup[0x1C] = { "INC", BIND(&CPU::opcode1C), 1};
-    lookup[0x1D] = { "DEC", BIND(&CPU::opcode1D), 1};
-    lookup[0x1E] = { "LD", BIND(&CPU::opcode1E), 2};
-    lookup[0x1F] = { "RRA", BIND(&CPU::opcode1F), 1};
-    lookup[0x20] = { "JR", BIND(&CPU::opcode20), 2};
-    lookup[0x21] = { "LD", BIND(&CPU::opcode21), 3};
-    lookup[0x22] = { "LD", BIND(&CPU::opcode22), 2};
-    lookup[0x23] = { "INC", BIND(&CPU::opcode23), 2};
-    lookup[0x24] = { "INC", BIND(&CPU::opcode24), 1};
-    lookup[0x25] = { "DEC", BIND(&CPU::opcode25), 1};
-    lookup[0x26] = { "LD", BIND(&CPU::opcode26), 2};
-    lookup[0x27] = { "DAA", BIND(&CPU::opcode27), 1};
-    lookup[0x28] = { "JR", BIND(&CPU::opcode28), 2};
-    lookup[0x29] = { "ADD", BIND(&CPU::opcode29), 2};
-    lookup[0x2A] = { "LD", BIND(&CPU::opcode2A), 2};
-    lookup[0x2B] = { "DEC", BIND(&CPU::opcode2B), 2};
-    lookup[0x2C] = { "INC", BIND(&CPU::opcode2C), 1};
-    lookup[0x2D] = { "DEC", BIND(&CPU::opcode2D), 1};
-    lookup[0x2E] = { "LD", BIND(&CPU::opcode2E), 2};
-    lookup[0x2F] = { "CPL", BIND(&CPU::opcode2F), 1};
-    lookup[0x30] = { "JR", BIND(&CPU::opcode30), 2};
-    lookup[0x31] = { "LD", BIND(&CPU::opcode31), 3};
-    lookup[0x32] = { "LD", BIND(&CPU::opcode32), 2};
-    lookup[0x33] = { "INC", BIND(&CPU::opcode33), 2};
-    lookup[0x34] = { "INC", BIND(&CPU::opcode34), 3};
-    lookup[0x35] = { "DEC", BIND(&CPU::opcode35), 3};
-    lookup[0x36] = { "LD", BIND(&CPU::opcode36), 3};
-    lookup[0x37] = { "SCF", BIND(&CPU::opcode37), 1};
-    lookup[0x38] = { "JR", BIND(&CPU::opcode38), 2};
-    lookup[0x39] = { "ADD", BIND(&CPU::opcode39), 2};
-    lookup[0x3A] = { "LD", BIND(&CPU::opcode3A), 2};
-    lookup[0x3B] = { "DEC", BIND(&CPU::opcode3B), 2};
-    lookup[0x3C] = { "INC", BIND(&CPU::opcode3C), 1};
-    lookup[0x3D] = { "DEC", BIND(&CPU::opcode3D), 1};
-    lookup[0x3E] = { "LD", BIND(&CPU::opcode3E), 2};
-    lookup[0x3F] = { "CCF", BIND(&CPU::opcode3F), 1};
-    lookup[0x40] = { "LD", BIND(&CPU::opcode40), 1};
-    lookup[0x41] = { "LD", BIND(&CPU::opcode41), 1};
-    lookup[0x42] = { "LD", BIND(&CPU::opcode42), 1};
-    lookup[0x43] = { "LD", BIND(&CPU::opcode43), 1};
-    lookup[0x44] = { "LD", BIND(&CPU::opcode44), 1};
-    lookup[0x45] = { "LD", BIND(&CPU::opcode45), 1};
-    lookup[0x46] = { "LD", BIND(&CPU::opcode46), 2};
-    lookup[0x47] = { "LD", BIND(&CPU::opcode47), 1};
-    lookup[0x48] = { "LD", BIND(&CPU::opcode48), 1};
-    lookup[0x49] = { "LD", BIND(&CPU::opcode49), 1};
-    lookup[0x4A] = { "LD", BIND(&CPU::opcode4A), 1};
-    lookup[0x4B] = { "LD", BIND(&CPU::opcode4B), 1};
-    lookup[0x4C] = { "LD", BIND(&CPU::opcode4C), 1};
-    lookup[0x4D] = { "LD", BIND(&CPU::opcode4D), 1};
-    lookup[0x4E] = { "LD", BIND(&CPU::opcode4E), 2};
-    lookup[0x4F] = { "LD", BIND(&CPU::opcode4F), 1};
-    lookup[0x50] = { "LD", BIND(&CPU::opcode50), 1};
-    lookup[0x51] = { "LD", BIND(&CPU::opcode51), 1};
-    lookup[0x52] = { "LD", BIND(&CPU::opcode52), 1};
-    lookup[0x53] = { "LD", BIND(&CPU::opcode53), 1};
-    lookup[0x54] = { "LD", BIND(&CPU::opcode54), 1};
-    lookup[0x55] = { "LD", BIND(&CPU::opcode55), 1};
-    lookup[0x56] = { "LD", BIND(&CPU::opcode56), 2};
-    lookup[0x57] = { "LD", BIND(&CPU::opcode57), 1};
-    lookup[0x58] = { "LD", BIND(&CPU::opcode58), 1};
-    lookup[0x59] = { "LD", BIND(&CPU::opcode59), 1};
-    lookup[0x5A] = { "LD", BIND(&CPU::opcode5A), 1};
-    lookup[0x5B] = { "LD", BIND(&CPU::opcode5B), 1};
-    lookup[0x5C] = { "LD", BIND(&CPU::opcode5C), 1};
-    lookup[0x5D] = { "LD", BIND(&CPU::opcode5D), 1};
-    lookup[0x5E] = { "LD", BIND(&CPU::opcode5E), 2};
-    lookup[0x5F] = { "LD", BIND(&CPU::opcode5F), 1};
-    lookup[0x60] = { "LD", BIND(&CPU::opcode60), 1};
-    lookup[0x61] = { "LD", BIND(&CPU::opcode61), 1};
-    lookup[0x62] = { "LD", BIND(&CPU::opcode62), 1};
-    lookup[0x63] = { "LD", BIND(&CPU::opcode63), 1};
-    lookup[0x64] = { "LD", BIND(&CPU::opcode64), 1};
-    lookup[0x65] = { "LD", BIND(&CPU::opcode65), 1};
-    lookup[0x66] = { "LD", BIND(&CPU::opcode66), 2};
-    lookup[0x67] = { "LD", BIND(&CPU::opcode67), 1};
-    lookup[0x68] = { "LD", BIND(&CPU::opcode68), 1};
-    lookup[0x69] = { "LD", BIND(&CPU::opcode69), 1};
-    lookup[0x6A] = { "LD", BIND(&CPU::opcode6A), 1};
-    lookup[0x6B] = { "LD", BIND(&CPU::opcode6B), 1};
-    lookup[0x6C] = { "LD", BIND(&CPU::opcode6C), 1};
-    lookup[0x6D] = { "LD", BIND(&CPU::opcode6D), 1};
-    lookup[0x6E] = { "LD", BIND(&CPU::opcode6E), 2};
-    lookup[0x6F] = { "LD", BIND(&CPU::opcode6F), 1};
-    lookup[0x70] = { "LD", BIND(&CPU::opcode70), 2};
-    lookup[0x71] = { "LD", BIND(&CPU::opcode71), 2};
-    lookup[0x72] = { "LD", BIND(&CPU::opcode72), 2};
-    lookup[0x73] = { "LD", BIND(&CPU::opcode73), 2};
-    lookup[0x74] = { "LD", BIND(&CPU::opcode74), 2};
-    lookup[0x75] = { "LD", BIND(&CPU::opcode75), 2};
-    lookup[0x76] = { "HALT", BIND(&CPU::opcode76), 1};
-    lookup[0x77] = { "LD", BIND(&CPU::opcode77), 2};
-    lookup[0x78] = { "LD", BIND(&CPU::opcode78), 1};
-    lookup[0x79] = { "LD", BIND(&CPU::opcode79), 1};
-    lookup[0x7A] = { "LD", BIND(&CPU::opcode7A), 1};
-    lookup[0x7B] = { "LD", BIND(&CPU::opcode7B), 1};
-    lookup[0x7C] = { "LD", BIND(&CPU::opcode7C), 1};
-    lookup[0x7D] = { "LD", BIND(&CPU::opcode7D), 1};
-    lookup[0x7E] = { "LD", BIND(&CPU::opcode7E), 2};
-    lookup[0x7F] = { "LD", BIND(&CPU::opcode7F), 1};
-    lookup[0x80] = { "ADD", BIND(&CPU::opcode80), 1};
-    lookup[0x81] = { "ADD", BIND(&CPU::opcode81), 1};
-    lookup[0x82] = { "ADD", BIND(&CPU::opcode82), 1};
-    lookup[0x83] = { "ADD", BIND(&CPU::opcode83), 1};
-    lookup[0x84] = { "ADD", BIND(&CPU::opcode84), 1};
-    lookup[0x85] = { "ADD", BIND(&CPU::opcode85), 1};
-    lookup[0x86] = { "ADD", BIND(&CPU::opcode86), 2};
-    lookup[0x87] = { "ADD", BIND(&CPU::opcode87), 1};
-    lookup[0x88] = { "ADC", BIND(&CPU::opcode88), 1};
-    lookup[0x89] = { "ADC", BIND(&CPU::opcode89), 1};
-    lookup[0x8A] = { "ADC", BIND(&CPU::opcode8A), 1};
-    lookup[0x8B] = { "ADC", BIND(&CPU::opcode8B), 1};
-    lookup[0x8C] = { "ADC", BIND(&CPU::opcode8C), 1};
-    lookup[0x8D] = { "ADC", BIND(&CPU::opcode8D), 1};
-    lookup[0x8E] = { "ADC", BIND(&CPU::opcode8E), 2};
-    lookup[0x8F] = { "ADC", BIND(&CPU::opcode8F), 1};
-    lookup[0x90] = { "SUB", BIND(&CPU::opcode90), 1};
-    lookup[0x91] = { "SUB", BIND(&CPU::opcode91), 1};
-    lookup[0x92] = { "SUB", BIND(&CPU::opcode92), 1};
-    lookup[0x93] = { "SUB", BIND(&CPU::opcode93), 1};
-    lookup[0x94] = { "SUB", BIND(&CPU::opcode94), 1};
-    lookup[0x95] = { "SUB", BIND(&CPU::opcode95), 1};
-    lookup[0x96] = { "SUB", BIND(&CPU::opcode96), 2};
-    lookup[0x97] = { "SUB", BIND(&CPU::opcode97), 1};
-    lookup[0x98] = { "SBC", BIND(&CPU::opcode98), 1};
-    lookup[0x99] = { "SBC", BIND(&CPU::opcode99), 1};
-    lookup[0x9A] = { "SBC", BIND(&CPU::opcode9A), 1};
-    lookup[0x9B] = { "SBC", BIND(&CPU::opcode9B), 1};
-    lookup[0x9C] = { "SBC", BIND(&CPU::opcode9C), 1};
-    lookup[0x9D] = { "SBC", BIND(&CPU::opcode9D), 1};
-    lookup[0x9E] = { "SBC", BIND(&CPU::opcode9E), 2};
-    lookup[0x9F] = { "SBC", BIND(&CPU::opcode9F), 1};
-    lookup[0xA0] = { "AND", BIND(&CPU::opcodeA0), 1};
-    lookup[0xA1] = { "AND", BIND(&CPU::opcodeA1), 1};
-    lookup[0xA2] = { "AND", BIND(&CPU::opcodeA2), 1};
-    lookup[0xA3] = { "AND", BIND(&CPU::opcodeA3), 1};
-    lookup[0xA4] = { "AND", BIND(&CPU::opcodeA4), 1};
-    lookup[0xA5] = { "AND", BIND(&CPU::opcodeA5), 1};
-    lookup[0xA6] = { "AND", BIND(&CPU::opcodeA6), 2};
-    lookup[0xA7] = { "AND", BIND(&CPU::opcodeA7), 1};
-    lookup[0xA8] = { "XOR", BIND(&CPU::opcodeA8), 1};
-    lookup[0xA9] = { "XOR", BIND(&CPU::opcodeA9), 1};
-    lookup[0xAA] = { "XOR", BIND(&CPU::opcodeAA), 1};
-    lookup[0xAB] = { "XOR", BIND(&CPU::opcodeAB), 1};
-    lookup[0xAC] = { "XOR", BIND(&CPU::opcodeAC), 1};
-    lookup[0xAD] = { "XOR", BIND(&CPU::opcodeAD), 1};
-    lookup[0xAE] = { "XOR", BIND(&CPU::opcodeAE), 2};
-    lookup[0xAF] = { "XOR", BIND(&CPU::opcodeAF), 1};
-    lookup[0xB0] = { "OR", BIND(&CPU::opcodeB0), 1};
-    lookup[0xB1] = { "OR", BIND(&CPU::opcodeB1), 1};
-    lookup[0xB2] = { "OR", BIND(&CPU::opcodeB2), 1};
-    lookup[0xB3] = { "OR", BIND(&CPU::opcodeB3), 1};
-    lookup[0xB4] = { "OR", BIND(&CPU::opcodeB4), 1};
-    lookup[0xB5] = { "OR", BIND(&CPU::opcodeB5), 1};
-    lookup[0xB6] = { "OR", BIND(&CPU::opcodeB6), 2};
-    lookup[0xB7] = { "OR", BIND(&CPU::opcodeB7), 1};
-    lookup[0xB8] = { "CP", BIND(&CPU::opcodeB8), 1};
-    lookup[0xB9] = { "CP", BIND(&CPU::opcodeB9), 1};
-    lookup[0xBA] = { "CP", BIND(&CPU::opcodeBA), 1};
-    lookup[0xBB] = { "CP", BIND(&CPU::opcodeBB), 1};
-    lookup[0xBC] = { "CP", BIND(&CPU::opcodeBC), 1};
-    lookup[0xBD] = { "CP", BIND(&CPU::opcodeBD), 1};
-    lookup[0xBE] = { "CP", BIND(&CPU::opcodeBE), 2};
-    lookup[0xBF] = { "CP", BIND(&CPU::opcodeBF), 1};
-    lookup[0xC0] = { "RET", BIND(&CPU::opcodeC0), 2};
-    lookup[0xC1] = { "POP", BIND(&CPU::opcodeC1), 3};
-    lookup[0xC2] = { "JP", BIND(&CPU::opcodeC2), 3};
-    lookup[0xC3] = { "JP", BIND(&CPU::opcodeC3), 4};
-    lookup[0xC4] = { "CALL", BIND(&CPU::opcodeC4), 3};
-    lookup[0xC5] = { "PUSH", BIND(&CPU::opcodeC5), 4};
-    lookup[0xC6] = { "ADD", BIND(&CPU::opcodeC6), 2};
-    lookup[0xC7] = { "RST", BIND(&CPU::opcodeC7), 4};
-    lookup[0xC8] = { "RET", BIND(&CPU::opcodeC8), 2};
-    lookup[0xC9] = { "RET", BIND(&CPU::opcodeC9), 4};
-    lookup[0xCA] = { "JP", BIND(&CPU::opcodeCA), 3};
-    lookup[0xCB] = { "PREFIX", BIND(&CPU::opcodeCB), 1};
-    lookup[0xCC] = { "CALL", BIND(&CPU::opcodeCC), 3};
-    lookup[0xCD] = { "CALL", BIND(&CPU::opcodeCD), 6};
-    lookup[0xCE] = { "ADC", BIND(&CPU::opcodeCE), 2};
-    lookup[0xCF] = { "RST", BIND(&CPU::opcodeCF), 4};
-    lookup[0xD0] = { "RET", BIND(&CPU::opcodeD0), 2};
-    lookup[0xD1] = { "POP", BIND(&CPU::opcodeD1), 3};
-    lookup[0xD2] = { "JP", BIND(&CPU::opcodeD2), 3};
-    lookup[0xD3] = { "ILL", BIND(&CPU::opcodeD3), 1};
-    lookup[0xD4] = { "CALL", BIND(&CPU::opcodeD4), 3};
-    lookup[0xD5] = { "PUSH", BIND(&CPU::opcodeD5), 4};
-    lookup[0xD6] = { "SUB", BIND(&CPU::opcodeD6), 2};
-    lookup[0xD7] = { "RST", BIND(&CPU::opcodeD7), 4};
-    lookup[0xD8] = { "RET", BIND(&CPU::opcodeD8), 2};
-    lookup[0xD9] = { "RETI", BIND(&CPU::opcodeD9), 4};
-    lookup[0xDA] = { "JP", BIND(&CPU::opcodeDA), 3};
-    lookup[0xDB] = { "ILL", BIND(&CPU::opcodeDB), 1};
-    lookup[0xDC] = { "CALL", BIND(&CPU::opcodeDC), 3};
-    lookup[0xDD] = { "ILL", BIND(&CPU::opcodeDD), 1};
-    lookup[0xDE] = { "SBC", BIND(&CPU::opcodeDE), 2};
-    lookup[0xDF] = { "RST", BIND(&CPU::opcodeDF), 4};
-    lookup[0xE0] = { "LDH", BIND(&CPU::opcodeE0), 3};
-    lookup[0xE1] = { "POP", BIND(&CPU::opcodeE1), 3};
-    lookup[0xE2] = { "LD", BIND(&CPU::opcodeE2), 2};
-    lookup[0xE3] = { "ILL", BIND(&CPU::opcodeE3), 1};
-    lookup[0xE4] = { "ILL", BIND(&CPU::opcodeE4), 1};
-    lookup[0xE5] = { "PUSH", BIND(&CPU::opcodeE5), 4};
-    lookup[0xE6] = { "AND", BIND(&CPU::opcodeE6), 2};
-    lookup[0xE7] = { "RST", BIND(&CPU::opcodeE7), 4};
-    lookup[0xE8] = { "ADD", BIND(&CPU::opcodeE8), 4};
-    lookup[0xE9] = { "JP", BIND(&CPU::opcodeE9), 1};
-    lookup[0xEA] = { "LD", BIND(&CPU::opcodeEA), 4};
-    lookup[0xEB] = { "ILL", BIND(&CPU::opcodeEB), 1};
-    lookup[0xEC] = { "ILL", BIND(&CPU::opcodeEC), 1};
-    lookup[0xED] = { "ILL", BIND(&CPU::opcodeED), 1};
-    lookup[0xEE] = { "XOR", BIND(&CPU::opcodeEE), 2};
-    lookup[0xEF] = { "RST", BIND(&CPU::opcodeEF), 4};
-    lookup[0xF0] = { "LDH", BIND(&CPU::opcodeF0), 3};
-    lookup[0xF1] = { "POP", BIND(&CPU::opcodeF1), 3};
-    lookup[0xF2] = { "LD", BIND(&CPU::opcodeF2), 2};
-    lookup[0xF3] = { "DI", BIND(&CPU::opcodeF3), 1};
-    lookup[0xF4] = { "ILL", BIND(&CPU::opcodeF4), 1};
-    lookup[0xF5] = { "PUSH", BIND(&CPU::opcodeF5), 4};
-    lookup[0xF6] = { "OR", BIND(&CPU::opcodeF6), 2};
-    lookup[0xF7] = { "RST", BIND(&CPU::opcodeF7), 4};
-    lookup[0xF8] = { "LD", BIND(&CPU::opcodeF8), 3};
-    lookup[0xF9] = { "LD", BIND(&CPU::opcodeF9), 2};
-    lookup[0xFA] = { "LD", BIND(&CPU::opcodeFA), 4};
-    lookup[0xFB] = { "EI", BIND(&CPU::opcodeFB), 1};
-    lookup[0xFC] = { "ILL", BIND(&CPU::opcodeFC), 1};
-    lookup[0xFD] = { "ILL", BIND(&CPU::opcodeFD), 1};
-    lookup[0xFE] = { "CP", BIND(&CPU::opcodeFE), 2};
-    lookup[0xFF] = { "RST", BIND(&CPU::opcodeFF), 4};
+    register_opcode(0x00, "NOP", &CPU::opcode00, 1);
+    register_opcode(0x01, "LD", &CPU::opcode01, 3);
+    register_opcode(0x02, "LD", &CPU::opcode02, 2);
+    register_opcode(0x03, "INC", &CPU::opcode03, 2);
+    register_opcode(0x04, "INC", &CPU::opcode04, 1);
+    register_opcode(0x05, "DEC", &CPU::opcode05, 1);
+    register_opcode(0x06, "LD", &CPU::opcode06, 2);
+    register_opcode(0x07, "RLCA", &CPU::opcode07, 1);
+    register_opcode(0x08, "LD", &CPU::opcode08, 5);
+    register_opcode(0x09, "ADD", &CPU::opcode09, 2);
+    register_opcode(0x0A, "LD", &CPU::opcode0A, 2);
+    register_opcode(0x0B, "DEC", &CPU::opcode0B, 2);
+    register_opcode(0x0C, "INC", &CPU::opcode0C, 1);
+    register_opcode(0x0D, "DEC", &CPU::opcode0D, 1);
+    register_opcode(0x0E, "LD", &CPU::opcode0E, 2);
+    register_opcode(0x0F, "RRCA", &CPU::opcode0F, 1);
+    register_opcode(0x10, "STOP", &CPU::opcode10, 1);
+    register_opcode(0x11, "LD", &CPU::opcode11, 3);
+    register_opcode(0x12, "LD", &CPU::opcode12, 2);
+    register_opcode(0x13, "INC", &CPU::opcode13, 2);
+    register_opcode(0x14, "INC", &CPU::opcode14, 1);
+    register_opcode(0x15, "DEC", &CPU::opcode15, 1);
+    register_opcode(0x16, "LD", &CPU::opcode16, 2);
+    register_opcode(0x17, "RLA", &CPU::opcode17, 1);
+    register_opcode(0x18, "JR", &CPU::opcode18, 3);
+    register_opcode(0x19, "ADD", &CPU::opcode19, 2);
+    register_opcode(0x1A, "LD", &CPU::opcode1A, 2);
+    register_opcode(0x1B, "DEC", &CPU::opcode1B, 2);
+    register_opcode(0x1C, "INC", &CPU::opcode1C, 1);
+    register_opcode(0x1D, "DEC", &CPU::opcode1D, 1);
+    register_opcode(0x1E, "LD", &CPU::opcode1E, 2);
+    register_opcode(0x1F, "RRA", &CPU::opcode1F, 1);
+    register_opcode(0x20, "JR", &CPU::opcode20, 2);
+    register_opcode(0x21, "LD", &CPU::opcode21, 3);
+    register_opcode(0x22, "LD", &CPU::opcode22, 2);
+    register_opcode(0x23, "INC", &CPU::opcode23, 2);
+    register_opcode(0x24, "INC", &CPU::opcode24, 1);
+    register_opcode(0x25, "DEC", &CPU::opcode25, 1);
+    register_opcode(0x26, "LD", &CPU::opcode26, 2);
+    register_opcode(0x27, "DAA", &CPU::opcode27, 1);
+    register_opcode(0x28, "JR", &CPU::opcode28, 2);
+    register_opcode(0x29, "ADD", &CPU::opcode29, 2);
+    register_opcode(0x2A, "LD", &CPU::opcode2A, 2);
+    register_opcode(0x2B, "DEC", &CPU::opcode2B, 2);
+    register_opcode(0x2C, "INC", &CPU::opcode2C, 1);
+    register_opcode(0x2D, "DEC", &CPU::opcode2D, 1);
+    register_opcode(0x2E, "LD", &CPU::opcode2E, 2);
+    register_opcode(0x2F, "CPL", &CPU::opcode2F, 1);
+    register_opcode(0x30, "JR", &CPU::opcode30, 2);
+    register_opcode(0x31, "LD", &CPU::opcode31, 3);
+    register_opcode(0x32, "LD", &CPU::opcode32, 2);
+    register_opcode(0x33, "INC", &CPU::opcode33, 2);
+    register_opcode(0x34, "INC", &CPU::opcode34, 3);
+    register_opcode(0x35, "DEC", &CPU::opcode35, 3);
+    register_opcode(0x36, "LD", &CPU::opcode36, 3);
+    register_opcode(0x37, "SCF", &CPU::opcode37, 1);
+    register_opcode(0x38, "JR", &CPU::opcode38, 2);
+    register_opcode(0x39, "ADD", &CPU::opcode39, 2);
+    register_opcode(0x3A, "LD", &CPU::opcode3A, 2);
+    register_opcode(0x3B, "DEC", &CPU::opcode3B, 2);
+    register_opcode(0x3C, "INC", &CPU::opcode3C, 1);
+    register_opcode(0x3D, "DEC", &CPU::opcode3D, 1);
+    register_opcode(0x3E, "LD", &CPU::opcode3E, 2);
+    register_opcode(0x3F, "CCF", &CPU::opcode3F, 1);
+    register_opcode(0x40, "LD", &CPU::opcode40, 1);
+    register_opcode(0x41, "LD", &CPU::opcode41, 1);
+    register_opcode(0x42, "LD", &CPU::opcode42, 1);
+    register_opcode(0x43, "LD", &CPU::opcode43, 1);
+    register_opcode(0x44, "LD", &CPU::opcode44, 1);
+    register_opcode(0x45, "LD", &CPU::opcode45, 1);
+    register_opcode(0x46, "LD", &CPU::opcode46, 2);
+    register_opcode(0x47, "LD", &CPU::opcode47, 1);
+    register_opcode(0x48, "LD", &CPU::opcode48, 1);
+    register_opcode(0x49, "LD", &CPU::opcode49, 1);
+    register_opcode(0x4A, "LD", &CPU::opcode4A, 1);
+    register_opcode(0x4B, "LD", &CPU::opcode4B, 1);
+    register_opcode(0x4C, "LD", &CPU::opcode4C, 1);
+    register_opcode(0x4D, "LD", &CPU::opcode4D, 1);
+    register_opcode(0x4E, "LD", &CPU::opcode4E, 2);
+    register_opcode(0x4F, "LD", &CPU::opcode4F, 1);
+    register_opcode(0x50, "LD", &CPU::opcode50, 1);
+    register_opcode(0x51, "LD", &CPU::opcode51, 1);
+    register_opcode(0x52, "LD", &CPU::opcode52, 1);
+    register_opcode(0x53, "LD", &CPU::opcode53, 1);
+    register_opcode(0x54, "LD", &CPU::opcode54, 1);
+    register_opcode(0x55, "LD", &CPU::opcode55, 1);
+    register_opcode(0x56, "LD", &CPU::opcode56, 2);
+    register_opcode(0x57, "LD", &CPU::opcode57, 1);
+    register_opcode(0x58, "LD", &CPU::opcode58, 1);
+    register_opcode(0x59, "LD", &CPU::opcode59, 1);
+    register_opcode(0x5A, "LD", &CPU::opcode5A, 1);
+    register_opcode(0x5B, "LD", &CPU::opcode5B, 1);
+    register_opcode(0x5C, "LD", &CPU::opcode5C, 1);
+    register_opcode(0x5D, "LD", &CPU::opcode5D, 1);
+    register_opcode(0x5E, "LD", &CPU::opcode5E, 2);
+    register_opcode(0x5F, "LD", &CPU::opcode5F, 1);
+    register_opcode(0x60, "LD", &CPU::opcode60, 1);
+    register_opcode(0x61, "LD", &CPU::opcode61, 1);
+    register_opcode(0x62, "LD", &CPU::opcode62, 1);
+    register_opcode(0x63, "LD", &CPU::opcode63, 1);
+    register_opcode(0x64, "LD", &CPU::opcode64, 1);
+    register_opcode(0x65, "LD", &CPU::opcode65, 1);
+    register_opcode(0x66, "LD", &CPU::opcode66, 2);
+    register_opcode(0x67, "LD", &CPU::opcode67, 1);
+    register_opcode(0x68, "LD", &CPU::opcode68, 1);
+    register_opcode(0x69, "LD", &CPU::opcode69, 1);
+    register_opcode(0x6A, "LD", &CPU::opcode6A, 1);
+    register_opcode(0x6B, "LD", &CPU::opcode6B, 1);
+    register_opcode(0x6C, "LD", &CPU::opcode6C, 1);
+    register_opcode(0x6D, "LD", &CPU::opcode6D, 1);
+    register_opcode(0x6E, "LD", &CPU::opcode6E, 2);
+    register_opcode(0x6F, "LD", &CPU::opcode6F, 1);
+    register_opcode(0x70, "LD", &CPU::opcode70, 2);
+    register_opcode(0x71, "LD", &CPU::opcode71, 2);
+    register_opcode(0x72, "LD", &CPU::opcode72, 2);
+    register_opcode(0x73, "LD", &CPU::opcode73, 2);
+    register_opcode(0x74, "LD", &CPU::opcode74, 2);
+    register_opcode(0x75, "LD", &CPU::opcode75, 2);
+    register_opcode(0x76, "HALT", &CPU::opcode76, 1);
+    register_opcode(0x77, "LD", &CPU::opcode77, 2);
+    register_opcode(0x78, "LD", &CPU::opcode78, 1);
+    register_opcode(0x79, "LD", &CPU::opcode79, 1);
+    register_opcode(0x7A, "LD", &CPU::opcode7A, 1);
+    register_opcode(0x7B, "LD", &CPU::opcode7B, 1);
+    register_opcode(0x7C, "LD", &CPU::opcode7C, 1);
+    register_opcode(0x7D, "LD", &CPU::opcode7D, 1);
+    register_opcode(0x7E, "LD", &CPU::opcode7E, 2);
+    register_opcode(0x7F, "LD", &CPU::opcode7F, 1);
+    register_opcode(0x80, "ADD", &CPU::opcode80, 1);
+    register_opcode(0x81, "ADD", &CPU::opcode81, 1);
+    register_opcode(0x82, "ADD", &CPU::opcode82, 1);
+    register_opcode(0x83, "ADD", &CPU::opcode83, 1);
+    register_opcode(0x84, "ADD", &CPU::opcode84, 1);
+    register_opcode(0x85, "ADD", &CPU::opcode85, 1);
+    register_opcode(0x86, "ADD", &CPU::opcode86, 2);
+    register_opcode(0x87, "ADD", &CPU::opcode87, 1);
+    register_opcode(0x88, "ADC", &CPU::opcode88, 1);
+    register_opcode(0x89, "ADC", &CPU::opcode89, 1);
+    register_opcode(0x8A, "ADC", &CPU::opcode8A, 1);
+    register_opcode(0x8B, "ADC", &CPU::opcode8B, 1);
+    register_opcode(0x8C, "ADC", &CPU::opcode8C, 1);
+    register_opcode(0x8D, "ADC", &CPU::opcode8D, 1);
+    register_opcode(0x8E, "ADC", &CPU::opcode8E, 2);
+    register_opcode(0x8F, "ADC", &CPU::opcode8F, 1);
+    register_opcode(0x90, "SUB", &CPU::opcode90, 1);
+    register_opcode(0x91, "SUB", &CPU::opcode91, 1);
+    register_opcode(0x92, "SUB", &CPU::opcode92, 1);
+    register_opcode(0x93, "SUB", &CPU::opcode93, 1);
+    register_opcode(0x94, "SUB", &CPU::opcode94, 1);
+    register_opcode(0x95, "SUB", &CPU::opcode95, 1);
+    register_opcode(0x96, "SUB", &CPU::opcode96, 2);
+    register_opcode(0x97, "SUB", &CPU::opcode97, 1);
+    register_opcode(0x98, "SBC", &CPU::opcode98, 1);
+    register_opcode(0x99, "SBC", &CPU::opcode99, 1);
+    register_opcode(0x9A, "SBC", &CPU::opcode9A, 1);
+    register_opcode(0x9B, "SBC", &CPU::opcode9B, 1);
+    register_opcode(0x9C, "SBC", &CPU::opcode9C, 1);
+    register_opcode(0x9D, "SBC", &CPU::opcode9D, 1);
+    register_opcode(0x9E, "SBC", &CPU::opcode9E, 2);
+    register_opcode(0x9F, "SBC", &CPU::opcode9F, 1);
+    register_opcode(0xA0, "AND", &CPU::opcodeA0, 1);
+    register_opcode(0xA1, "AND", &CPU::opcodeA1, 1);
+    register_opcode(0xA2, "AND", &CPU::opcodeA2, 1);
+    register_opcode(0xA3, "AND", &CPU::opcodeA3, 1);
+    register_opcode(0xA4, "AND", &CPU::opcodeA4, 1);
+    register_opcode(0xA5, "AND", &CPU::opcodeA5, 1);
+    register_opcode(0xA6, "AND", &CPU::opcodeA6, 2);
+    register_opcode(0xA7, "AND", &CPU::opcodeA7, 1);
+    register_opcode(0xA8, "XOR", &CPU::opcodeA8, 1);
+    register_opcode(0xA9, "XOR", &CPU::opcodeA9, 1);
+    register_opcode(0xAA, "XOR", &CPU::opcodeAA, 1);
+    register_opcode(0xAB, "XOR", &CPU::opcodeAB, 1);
+    register_opcode(0xAC, "XOR", &CPU::opcodeAC, 1);
+    register_opcode(0xAD, "XOR", &CPU::opcodeAD, 1);
+    register_opcode(0xAE, "XOR", &CPU::opcodeAE, 2);
+    register_opcode(0xAF, "XOR", &CPU::opcodeAF, 1);
+    register_opcode(0xB0, "OR", &CPU::opcodeB0, 1);
+    register_opcode(0xB1, "OR", &CPU::opcodeB1, 1);
+    register_opcode(0xB2, "OR", &CPU::opcodeB2, 1);
+    register_opcode(0xB3, "OR", &CPU::opcodeB3, 1);
+    register_opcode(0xB4, "OR", &CPU::opcodeB4, 1);
+    register_opcode(0xB5, "OR", &CPU::opcodeB5, 1);
+    register_opcode(0xB6, "OR", &CPU::opcodeB6, 2);
+    register_opcode(0xB7, "OR", &CPU::opcodeB7, 1);
+    register_opcode(0xB8, "CP", &CPU::opcodeB8, 1);
+    register_opcode(0xB9, "CP", &CPU::opcodeB9, 1);
+    register_opcode(0xBA, "CP", &CPU::opcodeBA, 1);
+    register_opcode(0xBB, "CP", &CPU::opcodeBB, 1);
+    register_opcode(0xBC, "CP", &CPU::opcodeBC, 1);
+    register_opcode(0xBD, "CP", &CPU::opcodeBD, 1);
+    register_opcode(0xBE, "CP", &CPU::opcodeBE, 2);
+    register_opcode(0xBF, "CP", &CPU::opcodeBF, 1);
+    register_opcode(0xC0, "RET", &CPU::opcodeC0, 2);
+    register_opcode(0xC1, "POP", &CPU::opcodeC1, 3);
+    register_opcode(0xC2, "JP", &CPU::opcodeC2, 3);
+    register_opcode(0xC3, "JP", &CPU::opcodeC3, 4);
+    register_opcode(0xC4, "CALL", &CPU::opcodeC4, 3);
+    register_opcode(0xC5, "PUSH", &CPU::opcodeC5, 4);
+    register_opcode(0xC6, "ADD", &CPU::opcodeC6, 2);
+    register_opcode(0xC7, "RST", &CPU::opcodeC7, 4);
+    register_opcode(0xC8, "RET", &CPU::opcodeC8, 2);
+    register_opcode(0xC9, "RET", &CPU::opcodeC9, 4);
+    register_opcode(0xCA, "JP", &CPU::opcodeCA, 3);
+    register_opcode(0xCB, "PREFIX", &CPU::opcodeCB, 1);
+    register_opcode(0xCC, "CALL", &CPU::opcodeCC, 3);
+    register_opcode(0xCD, "CALL", &CPU::opcodeCD, 6);
+    register_opcode(0xCE, "ADC", &CPU::opcodeCE, 2);
+    register_opcode(0xCF, "RST", &CPU::opcodeCF, 4);
+    register_opcode(0xD0, "RET", &CPU::opcodeD0, 2);
+    register_opcode(0xD1, "POP", &CPU::opcodeD1, 3);
+    register_opcode(0xD2, "JP", &CPU::opcodeD2, 3);
+    register_opcode(0xD3, "ILL", &CPU::opcodeD3, 1);
+    register_opcode(0xD4, "CALL", &CPU::opcodeD4, 3);
+    register_opcode(0xD5, "PUSH", &CPU::opcodeD5, 4);
+    register_opcode(0xD6, "SUB", &CPU::opcodeD6, 2);
+    register_opcode(0xD7, "RST", &CPU::opcodeD7, 4);
+    register_opcode(0xD8, "RET", &CPU::opcodeD8, 2);
+    register_opcode(0xD9, "RETI", &CPU::opcodeD9, 4);
+    register_opcode(0xDA, "JP", &CPU::opcodeDA, 3);
+    register_opcode(0xDB, "ILL", &CPU::opcodeDB, 1);
+    register_opcode(0xDC, "CALL", &CPU::opcodeDC, 3);
+    register_opcode(0xDD, "ILL", &CPU::opcodeDD, 1);
+    register_opcode(0xDE, "SBC", &CPU::opcodeDE, 2);
+    register_opcode(0xDF, "RST", &CPU::opcodeDF, 4);
+    register_opcode(0xE0, "LDH", &CPU::opcodeE0, 3);
+    register_opcode(0xE1, "POP", &CPU::opcodeE1, 3);
+    register_opcode(0xE2, "LD", &CPU::opcodeE2, 2);
+    register_opcode(0xE3, "ILL", &CPU::opcodeE3, 1);
+    register_opcode(0xE4, "ILL", &CPU::opcodeE4, 1);
+    register_opcode(0xE5, "PUSH", &CPU::opcodeE5, 4);
+    register_opcode(0xE6, "AND", &CPU::opcodeE6, 2);
+    register_opcode(0xE7, "RST", &CPU::opcodeE7, 4);
+    register_opcode(0xE8, "ADD", &CPU::opcodeE8, 4);
+    register_opcode(0xE9, "JP", &CPU::opcodeE9, 1);
+    register_opcode(0xEA, "LD", &CPU::opcodeEA, 4);
+    register_opcode(0xEB, "ILL", &CPU::opcodeEB, 1);
+    register_opcode(0xEC, "ILL", &CPU::opcodeEC, 1);
+    register_opcode(0xED, "ILL", &CPU::opcodeED, 1);
+    register_opcode(0xEE, "XOR", &CPU::opcodeEE, 2);
+    register_opcode(0xEF, "RST", &CPU::opcodeEF, 4);
+    register_opcode(0xF0, "LDH", &CPU::opcodeF0, 3);
+    register_opcode(0xF1, "POP", &CPU::opcodeF1, 3);
+    register_opcode(0xF2, "LD", &CPU::opcodeF2, 2);
+    register_opcode(0xF3, "DI", &CPU::opcodeF3, 1);
+    register_opcode(0xF4, "ILL", &CPU::opcodeF4, 1);
+    register_opcode(0xF5, "PUSH", &CPU::opcodeF5, 4);
+    register_opcode(0xF6, "OR", &CPU::opcodeF6, 2);
+    register_opcode(0xF7, "RST", &CPU::opcodeF7, 4);
+    register_opcode(0xF8, "LD", &CPU::opcodeF8, 3);
+    register_opcode(0xF9, "LD", &CPU::opcodeF9, 2);
+    register_opcode(0xFA, "LD", &CPU::opcodeFA, 4);
+    register_opcode(0xFB, "EI", &CPU::opcodeFB, 1);
+    register_opcode(0xFC, "ILL", &CPU::opcodeFC, 1);
+    register_opcode(0xFD, "ILL", &CPU::opcodeFD, 1);
+    register_opcode(0xFE, "CP", &CPU::opcodeFE, 2);
+    register_opcode(0xFF, "RST", &CPU::opcodeFF, 4);
 
-    lookup[0xCB00] = { "RLC", BIND(&CPU::opcodeCB00), 2 };
-    lookup[0xCB01] = { "RLC",  BIND(&CPU::opcodeCB01), 2 };
-    lookup[0xCB02] = { "RLC",  BIND(&CPU::opcodeCB02), 2 };
-    lookup[0xCB03] = { "RLC", BIND(&CPU::opcodeCB03), 2 };
-    lookup[0xCB04] = { "RLC", BIND(&CPU::opcodeCB04), 2 };
-    lookup[0xCB05] = { "RLC", BIND(&CPU::opcodeCB05), 2 };
-    lookup[0xCB06] = { "RLC", BIND(&CPU::opcodeCB06), 4 };
-    lookup[0xCB07] = { "RLC", BIND(&CPU::opcodeCB07), 2 };
-    lookup[0xCB08] = { "RRC", BIND(&CPU::opcodeCB08), 2 };
-    lookup[0xCB09] = { "RRC", BIND(&CPU::opcodeCB09), 2 };
-    lookup[0xCB0A] = { "RRC", BIND(&CPU::opcodeCB0A), 2 };
-    lookup[0xCB0B] = { "RRC", BIND(&CPU::opcodeCB0B), 2 };
-    lookup[0xCB0C] = { "RRC", BIND(&CPU::opcodeCB0C), 2 };
-    lookup[0xCB0D] = { "RRC", BIND(&CPU::opcodeCB0D), 2 };
-    lookup[0xCB0E] = { "RRC", BIND(&CPU::opcodeCB0E), 4 };
-    lookup[0xCB0F] = { "RRC", BIND(&CPU::opcodeCB0F), 2 };
-    lookup[0xCB10] = { "RL", BIND(&CPU::opcodeCB10), 2 };
-    lookup[0xCB11] = { "RL", BIND(&CPU::opcodeCB11), 2 };
-    lookup[0xCB12] = { "RL", BIND(&CPU::opcodeCB12), 2 };
-    lookup[0xCB13] = { "RL", BIND(&CPU::opcodeCB13), 2 };
-    lookup[0xCB14] = { "RL", BIND(&CPU::opcodeCB14), 2 };
-    lookup[0xCB15] = { "RL", BIND(&CPU::opcodeCB15), 2 };
-    lookup[0xCB16] = { "RL", BIND(&CPU::opcodeCB16), 4 };
-    lookup[0xCB17] = { "RL", BIND(&CPU::opcodeCB17), 2 };
-    lookup[0xCB18] = { "RR", BIND(&CPU::opcodeCB18), 2 };
-    lookup[0xCB19] = { "RR", BIND(&CPU::opcodeCB19), 2 };
-    lookup[0xCB1A] = { "RR", BIND(&CPU::opcodeCB1A), 2 };
-    lookup[0xCB1B] = { "RR", BIND(&CPU::opcodeCB1B), 2 };
-    lookup[0xCB1C] = { "RR", BIND(&CPU::opcodeCB1C), 2 };
-    lookup[0xCB1D] = { "RR", BIND(&CPU::opcodeCB1D), 2 };
-    lookup[0xCB1E] = { "RR", BIND(&CPU::opcodeCB1E), 4 };
-    lookup[0xCB1F] = { "RR", BIND(&CPU::opcodeCB1F), 2 };
-    lookup[0xCB20] = { "SLA", BIND(&CPU::opcodeCB20), 2 };
-    lookup[0xCB21] = { "SLA", BIND(&CPU::opcodeCB21), 2 };
-    lookup[0xCB22] = { "SLA", BIND(&CPU::opcodeCB22), 2 };
-    lookup[0xCB23] = { "SLA", BIND(&CPU::opcodeCB23), 2 };
-    lookup[0xCB24] = { "SLA", BIND(&CPU::opcodeCB24), 2 };
-    lookup[0xCB25] = { "SLA", BIND(&CPU::opcodeCB25), 2 };
-    lookup[0xCB26] = { "SLA", BIND(&CPU::opcodeCB26), 4 };
-    lookup[0xCB27] = { "SLA", BIND(&CPU::opcodeCB27), 2 };
-    lookup[0xCB28] = { "SRA", BIND(&CPU::opcodeCB28), 2 };
-    lookup[0xCB29] = { "SRA", BIND(&CPU::opcodeCB29), 2 };
-    lookup[0xCB2A] = { "SRA", BIND(&CPU::opcodeCB2A), 2 };
-    lookup[0xCB2B] = { "SRA", BIND(&CPU::opcodeCB2B), 2 };
-    lookup[0xCB2C] = { "SRA", BIND(&CPU::opcodeCB2C), 2 };
-    lookup[0xCB2D] = { "SRA", BIND(&CPU::opcodeCB2D), 2 };
-    lookup[0xCB2E] = { "SRA", BIND(&CPU::opcodeCB2E), 4 };
-    lookup[0xCB2F] = { "SRA", BIND(&CPU::opcodeCB2F), 2 };
-    lookup[0xCB30] = { "SWAP", BIND(&CPU::opcodeCB30), 2 };
-    lookup[0xCB31] = { "SWAP", BIND(&CPU::opcodeCB31), 2 };
-    lookup[0xCB32] = { "SWAP", BIND(&CPU::opcodeCB32), 2 };
-    lookup[0xCB33] = { "SWAP", BIND(&CPU::opcodeCB33), 2 };
-    lookup[0xCB34] = { "SWAP", BIND(&CPU::opcodeCB34), 2 };
-    lookup[0xCB35] = { "SWAP", BIND(&CPU::opcodeCB35), 2 };
-    lookup[0xCB36] = { "SWAP", BIND(&CPU::opcodeCB36), 4 };
-    lookup[0xCB37] = { "SWAP", BIND(&CPU::opcodeCB37), 2 };
-    lookup[0xCB38] = { "SRL", BIND(&CPU::opcodeCB38), 2 };
-    lookup[0xCB39] = { "SRL", BIND(&CPU::opcodeCB39), 2 };
-    lookup[0xCB3A] = { "SRL", BIND(&CPU::opcodeCB3A), 2 };
-    lookup[0xCB3B] = { "SRL", BIND(&CPU::opcodeCB3B), 2 };
-    lookup[0xCB3C] = { "SRL", BIND(&CPU::opcodeCB3C), 2 };
-    lookup[0xCB3D] = { "SRL", BIND(&CPU::opcodeCB3D), 2 };
-    lookup[0xCB3E] = { "SRL", BIND(&CPU::opcodeCB3E), 4 };
-    lookup[0xCB3F] = { "SRL", BIND(&CPU::opcodeCB3F), 2 };
-    lookup[0xCB40] = { "BIT", BIND(&CPU::opcodeCB40), 2 };
-    lookup[0xCB41] = { "BIT", BIND(&CPU::opcodeCB41), 2 };
-    lookup[0xCB42] = { "BIT", BIND(&CPU::opcodeCB42), 2 };
-    lookup[0xCB43] = { "BIT", BIND(&CPU::opcodeCB43), 2 };
-    lookup[0xCB44] = { "BIT", BIND(&CPU::opcodeCB44), 2 };
-    lookup[0xCB45] = { "BIT", BIND(&CPU::opcodeCB45), 2 };
-    lookup[0xCB46] = { "BIT", BIND(&CPU::opcodeCB46), 3 };
-    lookup[0xCB47] = { "BIT", BIND(&CPU::opcodeCB47), 2 };
-    lookup[0xCB48] = { "BIT", BIND(&CPU::opcodeCB48), 2 };
-    lookup[0xCB49] = { "BIT", BIND(&CPU::opcodeCB49), 2 };
-    lookup[0xCB4A] = { "BIT", BIND(&CPU::opcodeCB4A), 2 };
-    lookup[0xCB4B] = { "BIT", BIND(&CPU::opcodeCB4B), 2 };
-    lookup[0xCB4C] = { "BIT", BIND(&CPU::opcodeCB4C), 2 };
-    lookup[0xCB4D] = { "BIT", BIND(&CPU::opcodeCB4D), 2 };
-    lookup[0xCB4E] = { "BIT", BIND(&CPU::opcodeCB4E), 4 };
-    lookup[0xCB4F] = { "BIT", BIND(&CPU::opcodeCB4F), 2 };    
-    lookup[0xCB50] = { "BIT", BIND(&CPU::opcodeCB50), 2 };
-    lookup[0xCB51] = { "BIT", BIND(&CPU::opcodeCB51), 2 };
-    lookup[0xCB52] = { "BIT", BIND(&CPU::opcodeCB52), 2 };
-    lookup[0xCB53] = { "BIT", BIND(&CPU::opcodeCB53), 2 };
-    lookup[0xCB54] = { "BIT", BIND(&CPU::opcodeCB54), 2 };
-    lookup[0xCB55] = { "BIT", BIND(&CPU::opcodeCB55), 2 };
-    lookup[0xCB56] = { "BIT", BIND(&CPU::opcodeCB56), 4 };
-    lookup[0xCB57] = { "BIT", BIND(&CPU::opcodeCB57), 2 };
-    lookup[0xCB58] = { "BIT", BIND(&CPU::opcodeCB58), 2 };
-    lookup[0xCB59] = { "BIT", BIND(&CPU::opcodeCB59), 2 };
-    lookup[0xCB5A] = { "BIT", BIND(&CPU::opcodeCB5A), 2 };
-    lookup[0xCB5B] = { "BIT", BIND(&CPU::opcodeCB5B), 2 };
-    lookup[0xCB5C] = { "BIT", BIND(&CPU::opcodeCB5C), 2 };
-    lookup[0xCB5D] = { "BIT", BIND(&CPU::opcodeCB5D), 2 };
-    lookup[0xCB5E] = { "BIT", BIND(&CPU::opcodeCB5E), 4 };
-    lookup[0xCB5F] = { "BIT", BIND(&CPU::opcodeCB5F), 2 };   
-    lookup[0xCB60] = { "BIT", BIND(&CPU::opcodeCB60), 2 };
-    lookup[0xCB61] = { "BIT", BIND(&CPU::opcodeCB61), 2 };
-    lookup[0xCB62] = { "BIT", BIND(&CPU::opcodeCB62), 2 };
-    lookup[0xCB63] = { "BIT", BIND(&CPU::opcodeCB63), 2 };
-    lookup[0xCB64] = { "BIT", BIND(&CPU::opcodeCB64), 2 };
-    lookup[0xCB65] = { "BIT", BIND(&CPU::opcodeCB65), 2 };
-    lookup[0xCB66] = { "BIT", BIND(&CPU::opcodeCB66), 4 };
-    lookup[0xCB67] = { "BIT", BIND(&CPU::opcodeCB67), 2 };
-    lookup[0xCB68] = { "BIT", BIND(&CPU::opcodeCB68), 2 };
-    lookup[0xCB69] = { "BIT", BIND(&CPU::opcodeCB69), 2 };
-    lookup[0xCB6A] = { "BIT", BIND(&CPU::opcodeCB6A), 2 };
-    lookup[0xCB6B] = { "BIT", BIND(&CPU::opcodeCB6B), 2 };
-    lookup[0xCB6C] = { "BIT", BIND(&CPU::opcodeCB6C), 2 };
-    lookup[0xCB6D] = { "BIT", BIND(&CPU::opcodeCB6D), 2 };
-    lookup[0xCB6E] = { "BIT", BIND(&CPU::opcodeCB6E), 4 };
-    lookup[0xCB6F] = { "BIT", BIND(&CPU::opcodeCB6F), 2 };
-    lookup[0xCB70] = { "BIT", BIND(&CPU::opcodeCB70), 2 };
-    lookup[0xCB71] = { "BIT", BIND(&CPU::opcodeCB71), 2 };
-    lookup[0xCB72] = { "BIT", BIND(&CPU::opcodeCB72), 2 };
-    lookup[0xCB73] = { "BIT", BIND(&CPU::opcodeCB73), 2 };
-    lookup[0xCB74] = { "BIT", BIND(&CPU::opcodeCB74), 2 };
-    lookup[0xCB75] = { "BIT", BIND(&CPU::opcodeCB75), 2 };
-    lookup[0xCB76] = { "BIT", BIND(&CPU::opcodeCB76), 4 };
-    lookup[0xCB77] = { "BIT", BIND(&CPU::opcodeCB77), 2 };
-    lookup[0xCB78] = { "BIT", BIND(&CPU::opcodeCB78), 2 };
-    lookup[0xCB79] = { "BIT", BIND(&CPU::opcodeCB79), 2 };
-    lookup[0xCB7A] = { "BIT", BIND(&CPU::opcodeCB7A), 2 };
-    lookup[0xCB7B] = { "BIT", BIND(&CPU::opcodeCB7B), 2 };
-    lookup[0xCB7C] = { "BIT", BIND(&CPU::opcodeCB7C), 2 };
-    lookup[0xCB7D] = { "BIT", BIND(&CPU::opcodeCB7D), 2 };
-    lookup[0xCB7E] = { "BIT", BIND(&CPU::opcodeCB7E), 4 };
-    lookup[0xCB7F] = { "BIT", BIND(&CPU::opcodeCB7F), 2 };        
-    lookup[0xCB80] = { "RES", BIND(&CPU::opcodeCB80), 2 };
-    lookup[0xCB81] = { "RES", BIND(&CPU::opcodeCB81), 2 };
-    lookup[0xCB82] = { "RES", BIND(&CPU::opcodeCB82), 2 };
-    lookup[0xCB83] = { "RES", BIND(&CPU::opcodeCB83), 2 };
-    lookup[0xCB84] = { "RES", BIND(&CPU::opcodeCB84), 2 };
-    lookup[0xCB85] = { "RES", BIND(&CPU::opcodeCB85), 2 };
-    lookup[0xCB86] = { "RES", BIND(&CPU::opcodeCB86), 4 };
-    lookup[0xCB87] = { "RES", BIND(&CPU::opcodeCB87), 2 };
-    lookup[0xCB88] = { "RES", BIND(&CPU::opcodeCB88), 2 };
-    lookup[0xCB89] = { "RES", BIND(&CPU::opcodeCB89), 2 };
-    lookup[0xCB8A] = { "RES", BIND(&CPU::opcodeCB8A), 2 };
-    lookup[0xCB8B] = { "RES", BIND(&CPU::opcodeCB8B), 2 };
-    lookup[0xCB8C] = { "RES", BIND(&CPU::opcodeCB8C), 2 };
-    lookup[0xCB8D] = { "RES", BIND(&CPU::opcodeCB8D), 2 };
-    lookup[0xCB8E] = { "RES", BIND(&CPU::opcodeCB8E), 4 };
-    lookup[0xCB8F] = { "RES", BIND(&CPU::opcodeCB8F), 2 };   
-    lookup[0xCB90] = { "RES", BIND(&CPU::opcodeCB90), 2 };
-    lookup[0xCB91] = { "RES", BIND(&CPU::opcodeCB91), 2 };
-    lookup[0xCB92] = { "RES", BIND(&CPU::opcodeCB92), 2 };
-    lookup[0xCB93] = { "RES", BIND(&CPU::opcodeCB93), 2 };
-    lookup[0xCB94] = { "RES", BIND(&CPU::opcodeCB94), 2 };
-    lookup[0xCB95] = { "RES", BIND(&CPU::opcodeCB95), 2 };
-    lookup[0xCB96] = { "RES", BIND(&CPU::opcodeCB96), 4 };
-    lookup[0xCB97] = { "RES", BIND(&CPU::opcodeCB97), 2 };
-    lookup[0xCB98] = { "RES", BIND(&CPU::opcodeCB98), 2 };
-    lookup[0xCB99] = { "RES", BIND(&CPU::opcodeCB99), 2 };
-    lookup[0xCB9A] = { "RES", BIND(&CPU::opcodeCB9A), 2 };
-    lookup[0xCB9B] = { "RES", BIND(&CPU::opcodeCB9B), 2 };
-    lookup[0xCB9C] = { "RES", BIND(&CPU::opcodeCB9C), 2 };
-    lookup[0xCB9D] = { "RES", BIND(&CPU::opcodeCB9D), 2 };
-    lookup[0xCB9E] = { "RES", BIND(&CPU::opcodeCB9E), 4 };
-    lookup[0xCB9F] = { "RES", BIND(&CPU::opcodeCB9F), 2 };    
-    lookup[0xCBA0] = { "RES", BIND(&CPU::opcodeCBA0), 2 };
-    lookup[0xCBA1] = { "RES", BIND(&CPU::opcodeCBA1), 2 };
-    lookup[0xCBA2] = { "RES", BIND(&CPU::opcodeCBA2), 2 };
-    lookup[0xCBA3] = { "RES", BIND(&CPU::opcodeCBA3), 2 };
-    lookup[0xCBA4] = { "RES", BIND(&CPU::opcodeCBA4), 2 };
-    lookup[0xCBA5] = { "RES", BIND(&CPU::opcodeCBA5), 2 };
-    lookup[0xCBA6] = { "RES", BIND(&CPU::opcodeCBA6), 4 };
-    lookup[0xCBA7] = { "RES", BIND(&CPU::opcodeCBA7), 2 };
-    lookup[0xCBA8] = { "RES", BIND(&CPU::opcodeCBA8), 2 };
-    lookup[0xCBA9] = { "RES", BIND(&CPU::opcodeCBA9), 2 };
-    lookup[0xCBAA] = { "RES", BIND(&CPU::opcodeCBAA), 2 };
-    lookup[0xCBAB] = { "RES", BIND(&CPU::opcodeCBAB), 2 };
-    lookup[0xCBAC] = { "RES", BIND(&CPU::opcodeCBAC), 2 };
-    lookup[0xCBAD] = { "RES", BIND(&CPU::opcodeCBAD), 2 };
-    lookup[0xCBAE] = { "RES", BIND(&CPU::opcodeCBAE), 4 };
-    lookup[0xCBAF] = { "RES", BIND(&CPU::opcodeCBAF), 2 };
-    lookup[0xCBB0] = { "RES", BIND(&CPU::opcodeCBB0), 2 };
-    lookup[0xCBB1] = { "RES", BIND(&CPU::opcodeCBB1), 2 };
-    lookup[0xCBB2] = { "RES", BIND(&CPU::opcodeCBB2), 2 };
-    lookup[0xCBB3] = { "RES", BIND(&CPU::opcodeCBB3), 2 };
-    lookup[0xCBB4] = { "RES", BIND(&CPU::opcodeCBB4), 2 };
-    lookup[0xCBB5] = { "RES", BIND(&CPU::opcodeCBB5), 2 };
-    lookup[0xCBB6] = { "RES", BIND(&CPU::opcodeCBB6), 4 };
-    lookup[0xCBB7] = { "RES", BIND(&CPU::opcodeCBB7), 2 };
-    lookup[0xCBB8] = { "RES", BIND(&CPU::opcodeCBB8), 2 };
-    lookup[0xCBB9] = { "RES", BIND(&CPU::opcodeCBB9), 2 };
-    lookup[0xCBBA] = { "RES", BIND(&CPU::opcodeCBBA), 2 };
-    lookup[0xCBBB] = { "RES", BIND(&CPU::opcodeCBBB), 2 };
-    lookup[0xCBBC] = { "RES", BIND(&CPU::opcodeCBBC), 2 };
-    lookup[0xCBBD] = { "RES", BIND(&CPU::opcodeCBBD), 2 };
-    lookup[0xCBBE] = { "RES", BIND(&CPU::opcodeCBBE), 4 };
-    lookup[0xCBBF] = { "RES", BIND(&CPU::opcodeCBBF), 2 };
-  
-    lookup[0xCBC0] = { "SET", BIND(&CPU::opcodeCBC0), 2 };
-    lookup[0xCBC1] = { "SET", BIND(&CPU::opcodeCBC1), 2 };
-    lookup[0xCBC2] = { "SET", BIND(&CPU::opcodeCBC2), 2 };
-    lookup[0xCBC3] = { "SET", BIND(&CPU::opcodeCBC3), 2 };
-    lookup[0xCBC4] = { "SET", BIND(&CPU::opcodeCBC4), 2 };
-    lookup[0xCBC5] = { "SET", BIND(&CPU::opcodeCBC5), 2 };
-    lookup[0xCBC6] = { "SET", BIND(&CPU::opcodeCBC6), 4 };
-    lookup[0xCBC7] = { "SET", BIND(&CPU::opcodeCBC7), 2 };
-    lookup[0xCBC8] = { "SET", BIND(&CPU::opcodeCBC8), 2 };
-    lookup[0xCBC9] = { "SET", BIND(&CPU::opcodeCBC9), 2 };
-    lookup[0xCBCA] = { "SET", BIND(&CPU::opcodeCBCA), 2 };
-    lookup[0xCBCB] = { "SET", BIND(&CPU::opcodeCBCB), 2 };
-    lookup[0xCBCC] = { "SET", BIND(&CPU::opcodeCBCC), 2 };
-    lookup[0xCBCD] = { "SET", BIND(&CPU::opcodeCBCD), 2 };
-    lookup[0xCBCE] = { "SET", BIND(&CPU::opcodeCBCE), 4 };
-    lookup[0xCBCF] = { "SET", BIND(&CPU::opcodeCBCF), 2 };
-    
-    lookup[0xCBD0] = { "SET", BIND(&CPU::opcodeCBD0), 2 };
-    lookup[0xCBD1] = { "SET", BIND(&CPU::opcodeCBD1), 2 };
-    lookup[0xCBD2] = { "SET", BIND(&CPU::opcodeCBD2), 2 };
-    lookup[0xCBD3] = { "SET", BIND(&CPU::opcodeCBD3), 2 };
-    lookup[0xCBD4] = { "SET", BIND(&CPU::opcodeCBD4), 2 };
-    lookup[0xCBD5] = { "SET", BIND(&CPU::opcodeCBD5), 2 };
-    lookup[0xCBD6] = { "SET", BIND(&CPU::opcodeCBD6), 4 };
-    lookup[0xCBD7] = { "SET", BIND(&CPU::opcodeCBD7), 2 };
-    lookup[0xCBD8] = { "SET", BIND(&CPU::opcodeCBD8), 2 };
-    lookup[0xCBD9] = { "SET", BIND(&CPU::opcodeCBD9), 2 };
-    lookup[0xCBDA] = { "SET", BIND(&CPU::opcodeCBDA), 2 };
-    lookup[0xCBDB] = { "SET", BIND(&CPU::opcodeCBDB), 2 };
-    lookup[0xCBDC] = { "SET", BIND(&CPU::opcodeCBDC), 2 };
-    lookup[0xCBDD] = { "SET", BIND(&CPU::opcodeCBDD), 2 };
-    lookup[0xCBDE] = { "SET", BIND(&CPU::opcodeCBDE), 4 };
-    lookup[0xCBDF] = { "SET", BIND(&CPU::opcodeCBDF), 2 };
-    
-    lookup[0xCBE0] = { "SET", BIND(&CPU::opcodeCBE0), 2 };
-    lookup[0xCBE1] = { "SET", BIND(&CPU::opcodeCBE1), 2 };
-    lookup[0xCBE2] = { "SET", BIND(&CPU::opcodeCBE2), 2 };
-    lookup[0xCBE3] = { "SET", BIND(&CPU::opcodeCBE3), 2 };
-    lookup[0xCBE4] = { "SET", BIND(&CPU::opcodeCBE4), 2 };
-    lookup[0xCBE5] = { "SET", BIND(&CPU::opcodeCBE5), 2 };
-    lookup[0xCBE6] = { "SET", BIND(&CPU::opcodeCBE6), 4 };
-    lookup[0xCBE7] = { "SET", BIND(&CPU::opcodeCBE7), 2 };
-    lookup[0xCBE8] = { "SET", BIND(&CPU::opcodeCBE8), 2 };
-    lookup[0xCBE9] = { "SET", BIND(&CPU::opcodeCBE9), 2 };
-    lookup[0xCBEA] = { "SET", BIND(&CPU::opcodeCBEA), 2 };
-    lookup[0xCBEB] = { "SET", BIND(&CPU::opcodeCBEB), 2 };
-    lookup[0xCBEC] = { "SET", BIND(&CPU::opcodeCBEC), 2 };
-    lookup[0xCBED] = { "SET", BIND(&CPU::opcodeCBED), 2 };
-    lookup[0xCBEE] = { "SET", BIND(&CPU::opcodeCBEE), 4 };
-    lookup[0xCBEF] = { "SET", BIND(&CPU::opcodeCBEF), 2 };
-    
-    lookup[0xCBF0] = { "SET", BIND(&CPU::opcodeCBF0), 2 };
-    lookup[0xCBF1] = { "SET", BIND(&CPU::opcodeCBF1), 2 };
-    lookup[0xCBF2] = { "SET", BIND(&CPU::opcodeCBF2), 2 };
-    lookup[0xCBF3] = { "SET", BIND(&CPU::opcodeCBF3), 2 };
-    lookup[0xCBF4] = { "SET", BIND(&CPU::opcodeCBF4), 2 };
-    lookup[0xCBF5] = { "SET", BIND(&CPU::opcodeCBF5), 2 };
-    lookup[0xCBF6] = { "SET", BIND(&CPU::opcodeCBF6), 4 };
-    lookup[0xCBF7] = { "SET", BIND(&CPU::opcodeCBF7), 2 };
-    lookup[0xCBF8] = { "SET", BIND(&CPU::opcodeCBF8), 2 };
-    lookup[0xCBF9] = { "SET", BIND(&CPU::opcodeCBF9), 2 };
-    lookup[0xCBFA] = { "SET", BIND(&CPU::opcodeCBFA), 2 };
-    lookup[0xCBFB] = { "SET", BIND(&CPU::opcodeCBFB), 2 };
-    lookup[0xCBFC] = { "SET", BIND(&CPU::opcodeCBFC), 2 };
-    lookup[0xCBFD] = { "SET", BIND(&CPU::opcodeCBFD), 2 };
-    lookup[0xCBFE] = { "SET", BIND(&CPU::opcodeCBFE), 4 };
-    lookup[0xCBFF] = { "SET", BIND(&CPU::opcodeCBFF), 2 };
+    static const char* shifts[] = { "RLC", "RRC", "RL", "RR", "SLA", "SRA", "SWAP", "SRL" };
+    static const char* groups[] = { nullptr, "BIT", "RES", "SET" };
+
+    for (int code = 0; code < 256; code++) {
+        uint8_t group = code >> 6;
+        bool indirect = (code & 0x07) == 6; // (HL) operand
+
+        const char* name = group ? groups[group] : shifts[(code >> 3) & 0x07];
+        uint8_t cycles = !indirect ? 2 : (group == 1 ? 3 : 4);
+
+        register_cb_opcode(code, name, cb_handlers[code], cycles);
+    }
+}
+
+
+void CPU::register_opcode(uint8_t code, const char* name, Opcode exec, uint8_t cycles)
+{
+    lookup[code] = { exec, cycles };
+    mnemonics[code] = name;
 }
 
+void CPU::register_cb_opcode(uint8_t code, const char* name, Opcode exec, uint8_t cycles)
+{
+    cb_lookup[code] = { exec, cycles };
+    cb_mnemonics[code] = name;
+}
+
+const char* CPU::mnemonic(uint16_t code) const
+{
+    if ((code & 0xFF00) == 0xCB00)
+        return cb_mnemonics[code & 0xFF];
+
+    return mnemonics[code & 0xFF];
+}
@@ -2,71 +2,117 @@
 #include <cpu/mmu.h>
 #include <gameboy.h>
 
+// Base ticks per TIMA increment
+static constexpr uint64_t freqs[] = {
+    64, // 4   KHz
+    1,  // 262 KHz (base)
+    4,  // 65  KHz
+    16  // 16  KHz
+};
+
 Timer::Timer(MMU* mmu) :
     _mmu(mmu),
-    controller_(mmu->get(TAC)),
-    counter_(mmu->get(TIMA)),
-    modulo_(mmu->get(TMA)),
-    divider_(mmu->get(DIV)),
-    t_clock_(0),
-    base_clock_(0),
-    div_clock_(0)
+    controller_(mmu->memory[TAC]),
+    counter_(mmu->memory[TIMA]),
+    modulo_(mmu->memory[TMA]),
+    divider_(mmu->memory[DIV]),
+    ticks_(0),
+    base_origin_(0),
+    div_origin_(0)
 {
+    auto read = [this](uint16_t address) { return this->read(address); };
+    auto write = [this](uint16_t address, uint8_t data) { this->write(address, data); };
+
+    // TMA and TAC never change on their own, they read straight from memory
+    mmu->register_io(DIV, read, write);
+    mmu->register_io(TIMA, read, write);
+    mmu->register_io(TMA, nullptr, write);
+    mmu->register_io(TAC, nullptr, write);
 }
 
-void Timer::update(const uint8_t machine_cycles)
+uint8_t Timer::read(uint16_t address)
 {
-    // M clock increments at 1/4 the T clock rate
-    t_clock_ += machine_cycles * 4;
-
-    // timer ticks occur at 1/16 the CPU cycles
-    while (t_clock_ >= 16)
-    {
-        t_clock_ -= 16;
-        tick();
-    }
+    sync();
+    return _mmu->memory[address];
 }
 
-void Timer::tick()
+void Timer::write(uint16_t address, uint8_t data)
 {
-    // base clock dividers
-    static constexpr int freqs[] = {
-        64, // 4   KHz
-        1,  // 262 KHz (base)
-        4,  // 65  KHz
-        16  // 16  KHz
-    };
-
-    base_clock_++;
-    div_clock_++;
-
-    // do divider clock
-    if (div_clock_ == 16)
-    {
-        divider_++;
-        div_clock_ = 0;
+    // Everything up to this instruction still counts with the old values
+    sync();
+
+    if (address == DIV) { // Clears the whole divider, so the TIMA period starts over as well
+        divider_ = 0;
+        div_origin_ = ticks_;
+        base_origin_ = ticks_;
+    }
+    else {
+        _mmu->memory[address] = data;
     }
 
+    schedule_overflow();
+}
+
+void Timer::sync()
+{
+    // M clock increments at 1/4 the T clock rate, timer ticks occur at 1/16 the T clock rate
+    catch_up(_mmu->gb->scheduler.now / 4);
+}
+
+void Timer::on_overflow()
+{
+    sync();
+    schedule_overflow();
+}
+
+void Timer::catch_up(uint64_t ticks)
+{
+    if (ticks <= ticks_)
+        return;
+
+    // DIV counts every 16th base tick
+    divider_ += static_cast<uint8_t>((ticks - div_origin_) / 16 - (ticks_ - div_origin_) / 16);
+
     // only if timer is enabled
-    if (controller_ & 0x04)
-    {
-        // get frequency 
-        auto freq = freqs[controller_ & 0x03];
-
-        // increment counter
-        while (base_clock_ >= freq)
-        {
-            base_clock_ -= freq;
-
-            if (counter_ == 0xFF)
-            {
-                counter_ = modulo_;
-                _mmu->gb->cpu.interupt(TIMER_INTERUPT);
-            }
-            else
-            {
-                counter_++;
-            }
-        }
+    if (controller_ & 0x04) {
+        uint64_t freq = freqs[controller_ & 0x03];
+        uint64_t steps = (ticks - base_origin_) / freq;
+
+        base_origin_ += steps * freq;
+        count(steps);
     }
-}
\ No newline at end of file
+
+    ticks_ = ticks;
+}
+
+void Timer::count(uint64_t steps)
+{
+    if (steps < 256u - counter_) {
+        counter_ += static_cast<uint8_t>(steps);
+        return;
+    }
+
+    // Overflowed at least once, from then on TIMA cycles between TMA and 0xFF
+    steps -= 256u - counter_;
+    counter_ = static_cast<uint8_t>(modulo_ + steps % (256u - modulo_));
+
+    _mmu->gb->cpu.interupt(TIMER_INTERUPT);
+}
+
+void Timer::schedule_overflow()
+{
+    Scheduler& scheduler = _mmu->gb->scheduler;
+
+    if (!(controller_ & 0x04)) {
+        scheduler.cancel(Event::Timer);
+        return;
+    }
+
+    uint64_t freq = freqs[controller_ & 0x03];
+    uint64_t overflow = base_origin_ + freq * (256u - counter_);
+
+    // A backlog from while the timer was off drains on the next tick
+    if (overflow <= ticks_) overflow = ticks_ + 1;
+
+    scheduler.schedule(Event::Timer, overflow * 4);
+}
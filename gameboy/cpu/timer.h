@@ -8,19 +8,39 @@ public:
     Timer(MMU* mmu);
     ~Timer() = default;
 
-    void update(const uint8_t cycles);
+    uint8_t read(uint16_t address);
+    void write(uint16_t address, uint8_t data);
+
+    void sync();        // Brings DIV and TIMA in memory up to the current cycle
+    void on_overflow(); // Scheduled through Event::Timer
+
+    // Counters behind the registers, the registers themselves live in memory
+    struct State {
+        uint64_t ticks;
+        uint64_t base_origin;
+        uint64_t div_origin;
+    };
+
+    State save_state() const { return { ticks_, base_origin_, div_origin_ }; }
+    void load_state(const State& state) { ticks_ = state.ticks; base_origin_ = state.base_origin; div_origin_ = state.div_origin; }
 
 private:
-    void tick();
+    void catch_up(uint64_t ticks);
+    void count(uint64_t steps);
+    void schedule_overflow();
 
     uint8_t& controller_; // TAC
     uint8_t& counter_;    // TIMA
     uint8_t& modulo_;     // TMA
     uint8_t& divider_;    // DIV
 
-    int t_clock_;
-    int base_clock_;
-    int div_clock_;
+    // Base ticks (every 16 T-cycles) already applied to DIV and TIMA
+    uint64_t ticks_;
+    // TIMA advances once per frequency period counted from here, it keeps
+    // falling behind while the timer is disabled
+    uint64_t base_origin_;
+    // DIV counts every 16th base tick from here, a DIV write moves it up
+    uint64_t div_origin_;
 
     MMU* _mmu;
-};
\ No newline at end of file
+};
@@ -0,0 +1,77 @@
+#include "tracer.h"
+#include <algorithm>
+
+Tracer::~Tracer()
+{
+    stop();
+}
+
+bool Tracer::start(const std::string& path, uint64_t cycle)
+{
+    stop();
+
+    file = fopen(path.c_str(), "wb");
+    if (!file) return false;
+
+    TraceHeader header;
+    header.cycle = cycle;
+    fwrite(&header, sizeof(header), 1, file);
+
+    if (!ring) ring.reset(new TraceRecord[CAPACITY]);
+    head = published = written = 0;
+    stopping = false;
+
+    thread = std::thread(&Tracer::writer, this);
+    return true;
+}
+
+void Tracer::stop()
+{
+    if (!thread.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        published = head;
+        stopping = true;
+    }
+    wake.notify_one();
+
+    thread.join();
+    fclose(file);
+    file = nullptr;
+}
+
+void Tracer::publish()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    published = head;
+    wake.notify_one();
+
+    // The next chunk must not overwrite records the writer has not reached yet
+    drained.wait(lock, [this] { return head - written <= CAPACITY - CHUNK; });
+}
+
+void Tracer::writer()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (;;) {
+        wake.wait(lock, [this] { return published != written || stopping; });
+        if (published == written) return; // Stopping and drained
+
+        uint64_t from = written, to = published;
+        lock.unlock();
+
+        while (from < to) {
+            uint64_t index = from & (CAPACITY - 1);
+            uint64_t count = std::min(to - from, CAPACITY - index);
+
+            fwrite(&ring[index], sizeof(TraceRecord), count, file);
+            from += count;
+        }
+
+        lock.lock();
+        written = to;
+        drained.notify_one();
+    }
+}
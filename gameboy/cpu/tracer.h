@@ -0,0 +1,61 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#define TRACE_INTERRUPT 0x8000 // Set in TraceRecord::cycle for an interrupt dispatch
+
+// One traced instruction, registers are taken before it executes
+struct TraceRecord {
+	uint16_t pc, af, bc, de, hl, sp;
+	uint8_t opcode, ly;
+	uint16_t cycle; // Low 15 bits of the M-cycle clock
+};
+
+static_assert(sizeof(TraceRecord) == 16, "Trace records are packed into 16 bytes");
+
+// Written once at the start of a trace file, the records follow
+struct TraceHeader {
+	char magic[4] = { 'G', 'B', 'T', 'R' };
+	uint32_t version = 1;
+	uint64_t cycle = 0; // Full clock of the first record, consecutive records are less than 0x8000 cycles apart
+};
+
+// Fixed size ring of binary records, a background thread streams full chunks to disk
+class Tracer {
+public:
+	static constexpr uint64_t CHUNK = 1 << 14;     // Records handed to the writer at once
+	static constexpr uint64_t CAPACITY = CHUNK * 16; // 4 MB
+
+	~Tracer();
+
+	bool start(const std::string& path, uint64_t cycle);
+	void stop(); // Flushes everything recorded so far
+
+	void record(const TraceRecord& record)
+	{
+		ring[head & (CAPACITY - 1)] = record;
+		if ((++head & (CHUNK - 1)) == 0) publish();
+	}
+
+private:
+	void publish();
+	void writer();
+
+private:
+	std::unique_ptr<TraceRecord[]> ring;
+	FILE* file = nullptr;
+	std::thread thread;
+
+	std::mutex mutex;
+	std::condition_variable wake, drained;
+
+	uint64_t head = 0;      // Next record, only touched by the emulation thread
+	uint64_t published = 0; // Records handed to the writer
+	uint64_t written = 0;   // Records on disk
+	bool stopping = false;
+};
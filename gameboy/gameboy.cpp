@@ -1,11 +1,7 @@
 #include "gameboy.h"
-#include <sstream>
-#include <thread>
-#include <iomanip>
-#include <logger.h>
-#include <imgui/imgui_textcolor.h>
-
-std::vector<std::string> GameBoy::hex_str;
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
 
 GameBoy::GameBoy() : cpu(&mmu)
 {
@@ -14,200 +10,266 @@ GameBoy::GameBoy() : cpu(&mmu)
     ppu.init(&mmu);
     joypad.init(&mmu);
 	cpu.reset();
-    
-    viewport = sf::Sprite(ppu.frame_buffer);
-    viewport.setScale(3.5, 3.5);
 
-    for (int i = 0; i <= 0xFFFF; i++) hex_str.push_back(to_hex_string(i));
+    scheduler.set_handler(Event::PPU, [this]() { ppu.step(); });
+    scheduler.set_handler(Event::Timer, [this]() { cpu.cpu_timer.on_overflow(); });
+    scheduler.schedule_next(Event::PPU);
 }
 
 void GameBoy::load_rom(const std::string& file)
+{
+    if (auto image = RomImage::load(file))
+        load_rom(std::move(image));
+    else
+        log("Cannot read %s\n", file.c_str());
+}
+
+void GameBoy::load_rom(std::shared_ptr<RomImage> image)
 {
     mmu.cartridge = std::make_shared<Cartridge>(&mmu);
-    mmu.cartridge->load_rom(file);
+    mmu.cartridge->load_rom(std::move(image));
+    mmu.map_pages();
+
+    cpu.block_cache.flush();
+    cpu.dynarec.flush();
+    rewind.clear();
+    movie.stop();
 
     rom_loaded = true;
 }
 
-void GameBoy::boot(const std::string& boot)
+bool GameBoy::read_bios(const std::string& file, uint8_t* bios)
 {
-    uint8_t bootrom[256];
-    
-    FILE* in = fopen(boot.c_str(), "rb");
-    fread(bootrom, 1, 256, in);
-    fclose(in);
+    FILE* in = fopen(file.c_str(), "rb");
+    if (!in) return false;
 
-    cpu.pc = 0;
+    size_t size = fread(bios, 1, BIOS_SIZE, in);
+    fclose(in);
 
-    mmu.copy_bootrom(bootrom);
+    return size == BIOS_SIZE;
 }
 
-void GameBoy::cpu_stats()
+bool GameBoy::boot(const std::string& file)
 {
-    bool n = cpu.get_flag(N), z = cpu.get_flag(Z), 
-         h = cpu.get_flag(H), c = cpu.get_flag(C);
-    
-    ImGui::Begin("CPU-Info");
-    
-    ImVec2 size = ImGui::GetWindowSize();
-
-    NEWLINE;
-    std::string dashes = std::string(12, '-');
-    ImGui::Text("    %s %s %s", dashes.c_str(), "Flags", dashes.c_str());
-
-    NEWLINE;
-    ImGui::Text("       N:"); NO_NEWLINE;
-    ImGui::TextAnsiColored(n ? YELLOW : WHITE, "%d", n); NO_NEWLINE;
-    ImGui::Text("   Z:"); NO_NEWLINE;
-    ImGui::TextAnsiColored(z ? YELLOW : WHITE, "%d", z); NO_NEWLINE;
-    ImGui::Text("   H:"); NO_NEWLINE;
-    ImGui::TextAnsiColored(h ? YELLOW : WHITE, "%d", h); NO_NEWLINE;
-    ImGui::Text("   C:"); NO_NEWLINE;
-    ImGui::TextAnsiColored(c ? YELLOW : WHITE, "%d", c); NEWLINE;
-    
-    ImGui::Text("   %s %s %s", dashes.c_str(), "Registers", dashes.c_str());
+    uint8_t bootrom[BIOS_SIZE];
 
-    NEWLINE;
-	ImGui::Text("       B: %s      C: %s", hex_str[cpu.bc.h].c_str(), hex_str[cpu.bc.l].c_str());
-	ImGui::Text("       D: %s      E: %s", hex_str[cpu.de.h].c_str(), hex_str[cpu.de.l].c_str());
-	ImGui::Text("       H: %s      L: %s", hex_str[cpu.hl.h].c_str(), hex_str[cpu.hl.l].c_str());
-    ImGui::Text("       A: %s      F: %s", hex_str[cpu.af.h].c_str(), hex_str[cpu.af.l].c_str());
-    
-    NEWLINE;
-    ImGui::Text("       Program Counter: %s", hex_str[cpu.pc].c_str());
-	ImGui::Text("       Stack Pointer:   %s", hex_str[cpu.sp].c_str());
-
-    NEWLINE;
-    ImGui::Text("       Opcode:   %s ", hex_str[cpu.opcode].c_str());
-	ImGui::Text("       Mnemonic: %s", cpu.lookup[cpu.opcode].name.c_str());
-	
-    ImGui::End();
+    if (!read_bios(file, bootrom)) {
+        log("Cannot read %s\n", file.c_str());
+        return false;
+    }
+
+    boot(bootrom);
+    return true;
 }
 
-void GameBoy::memory_map(uint16_t from, uint16_t to, uint8_t step)
+void GameBoy::boot(const uint8_t* bios)
 {
-    ImGui::Begin("Memory");
-
-    ImVec2 size = ImGui::GetWindowSize();
-
-    if (mmu.read(BOOTING)) {
-        ImGui::Text("Address");
-        ImGui::Text("%s", std::string(40, '-').c_str());
-        
-        std::string line = "";
-        for (int i = from; i <= to; i++) {
-            if (i == 0) {
-                line += "0x0000 | ";
-            }
-            else if ((i - from) % step == 0) {
-                ImGui::Text(line.c_str());
-                line.clear();
-                line += hex_str[i] + " | ";
-            }
-
-            line += hex_str[mmu.read(i)] + ' ';
-        }
-    }
+    cpu.pc = 0;
 
-    ImGui::End();
+    mmu.copy_bootrom(bios);
 }
 
-void GameBoy::display_viewport()
+void GameBoy::log(const char* fmt, ...)
 {
-    ImGui::Begin("Viewport");
+    if (!on_log) return;
 
-    ImVec2 pos = ImGui::GetCursorScreenPos();
-    uint32_t tex = viewport.getTexture()->getNativeHandle();
+    char message[512];
+    va_list args;
 
-    ImVec2 size = ImGui::GetWindowSize();
-    size.y -= 46;
+    va_start(args, fmt);
+    vsnprintf(message, sizeof(message), fmt, args);
+    va_end(args);
 
-    ImGui::Image(tex, size, ImVec2(0, 0), ImVec2(0.625, 0.5625));
-    ImGui::End();
+    on_log(message);
 }
 
-void GameBoy::dockspace(std::function<void()> menu_func)
+void GameBoy::tick()
 {
-    ImGuiDockNodeFlags dockspace_flags = ImGuiDockNodeFlags_None;
+    if (rom_loaded) {
+        ahead_shown = false;
 
-    ImGuiWindowFlags window_flags = ImGuiWindowFlags_MenuBar | ImGuiWindowFlags_NoDocking;
-    ImGuiViewport* viewport = ImGui::GetMainViewport();
-    ImGui::SetNextWindowPos(viewport->Pos);
-    ImGui::SetNextWindowSize(viewport->Size);
-    ImGui::SetNextWindowViewport(viewport->ID);
-    ImGui::PushStyleVar(ImGuiStyleVar_WindowRounding, 0.0f);
-    ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.0f);
-    window_flags |= ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove;
-    window_flags |= ImGuiWindowFlags_NoBringToFrontOnFocus | ImGuiWindowFlags_NoNavFocus;
+        if (rewinding) {
+            if (rewind.step_back(*this)) movie.on_rewind();
+            return;
+        }
 
-    if (dockspace_flags & ImGuiDockNodeFlags_PassthruCentralNode)
-        window_flags |= ImGuiWindowFlags_NoBackground;
+        movie.on_frame(*this);
+        rewind.capture(*this);
 
-    ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0f, 0.0f));
-    ImGui::Begin("DockSpace Demo", &bool_ptr, window_flags);
-    ImGui::PopStyleVar();
-    ImGui::PopStyleVar(2);
+        bool draw = render_requested || (render_interval && frame_count % render_interval == 0);
+        render_requested = false;
 
-    // DockSpace
-    ImGuiID dockspace_id = ImGui::GetID("MyDockSpace");
-    ImGui::DockSpace(dockspace_id, ImVec2(0.0f, 0.0f), dockspace_flags);
+        if (!run_ahead) {
+            run_frame(draw);
+            return;
+        }
 
-    menu_func();
+        // The frame the input belongs to, only drawn for rewinding to show, then the ones after it as if the input stayed the same
+        run_frame(draw && rewind.budget);
 
-    ImGui::End();
-}
+        if (!ahead_state) {
+            ahead_state = std::make_unique<SaveState>();
+            ahead_frame.reset(new uint8_t[SCREEN_WIDTH * SCREEN_HEIGHT]);
+        }
+        save_state(*ahead_state);
 
-void GameBoy::log()
-{
-    logger.draw();
-}
+        for (uint32_t i = 1; i <= run_ahead; i++)
+            run_frame(draw && i == run_ahead);
 
-void GameBoy::menu_function()
-{
-    ImGuiDockNodeFlags dockspace_flags = ImGuiDockNodeFlags_None;
-    
-    if (ImGui::BeginMenuBar()) {
-        if (ImGui::BeginMenu("File")) {
-            if (ImGui::MenuItem("Load Rom", "  Loads rom file")) {
-                file_dialog_opened = true;
+        if (draw) {
+            const uint8_t* frame = ppu.frame;
+            if (ppu.render_thread.running()) { // Its finished frames reach back into the rolled back frame
+                ppu.render_thread.sync();
+                frame = ppu.render_thread.work_frame();
             }
-            ImGui::EndMenu();
+            memcpy(ahead_frame.get(), frame, SCREEN_WIDTH * SCREEN_HEIGHT);
         }
-        ImGui::EndMenuBar();
+
+        load_state(*ahead_state);
+        ahead_shown = true;
     }
+}
 
-    if (file_dialog_opened) {
-        file.open_dialog();
-        bool done = file.draw();
+void GameBoy::run_frame(bool draw)
+{
+    uint64_t frame_end = scheduler.now + cycles_per_frame;
+    scheduler.set_limit(frame_end); // Translated blocks stop there like the interpreter
 
-        file_dialog_opened = !done;
-        if (file_dialog_opened == false) {
-            if (!file.selected().empty()) {
-                load_rom(file.selected()[0]);
+    ppu.render = draw;
+    frame_count++;
 
-                rom_loaded = true;
-                if (mmu.read(BOOTING)) cpu.reset();
-            }
-        }
+    while (scheduler.now < frame_end) {
+        // Falls back to cpu.tick() when the dynarec is off, a block advances the scheduler up to its last instruction
+        uint32_t cycle = cpu.dynarec.execute();
+        scheduler.advance(cycle);
+
+        if (scheduler.due()) scheduler.run_due();
+
+        cpu.handle_interupts();
     }
+
+    cpu.cpu_timer.sync(); // Keeps DIV and TIMA current for the debug views
 }
 
-void GameBoy::tick()
+void GameBoy::save_state(SaveState& state)
 {
-    uint32_t current_cycle = 0;
+    // Padding included, so equal states compare equal byte for byte
+    memset(static_cast<void*>(&state), 0, sizeof(state));
+    memcpy(state.magic, "GBSS", 4);
+    state.version = SAVE_STATE_VERSION;
+    state.size = sizeof(SaveState);
+    state.rom_hash = rom_hash();
+
+    // Member by member, copying whole structs could carry their padding over
+    state.cpu.af = cpu.af; state.cpu.bc = cpu.bc; state.cpu.de = cpu.de; state.cpu.hl = cpu.hl;
+    state.cpu.pc = cpu.pc;
+    state.cpu.sp = cpu.sp;
+    state.cpu.opcode = cpu.opcode;
+    state.cpu.lazy_flags.pending = cpu.lazy_flags.pending;
+    state.cpu.lazy_flags.subtract = cpu.lazy_flags.subtract;
+    state.cpu.lazy_flags.operands = cpu.lazy_flags.operands;
+    state.cpu.lazy_flags.result = cpu.lazy_flags.result;
+    state.cpu.cycles = cpu.cycles;
+    state.cpu.divider_counter = cpu.divider_counter;
+    state.cpu.halted = cpu.halted;
+    state.cpu.interupts_enabled = cpu.interupts_enabled;
+
+    state.timer = cpu.cpu_timer.save_state();
+    state.scheduler = scheduler.save_state();
+    state.joypad = joypad.save_state();
+
+    state.ppu.line_start = ppu.line_start;
+    state.ppu.lcd_on = ppu.lcd_on;
+    state.ppu.mode = ppu.mode;
+    state.ppu.backend = ppu.backend;
+    memcpy(static_cast<void*>(&state.ppu.fifo), &ppu.fifo, sizeof(ppu.fifo)); // Its padding is zeroed in PPU::init
+    state.ppu.fifo.init(nullptr, nullptr); // Pointers into this instance
+
+    const uint8_t* frame = ppu.frame;
+    if (ppu.render_thread.running()) { // Same lines drawn as without the thread
+        ppu.render_thread.sync();
+        frame = ppu.render_thread.work_frame();
+    }
+    memcpy(state.ppu.frame, frame, sizeof(state.ppu.frame));
+
+    if (const Cartridge* cartridge = mmu.cartridge.get()) {
+        state.cartridge.rom_bank = cartridge->current_rom_bank;
+        state.cartridge.ram_bank = cartridge->current_ram_bank;
+        state.cartridge.memory_enabled = cartridge->memory_enabled;
+        state.cartridge.rom_banking = cartridge->rom_banking;
+        memcpy(state.cartridge.ram, cartridge->memory, sizeof(state.cartridge.ram));
+    }
 
-    if (rom_loaded) {
+    state.frame_count = frame_count;
+    memcpy(state.memory, mmu.memory, sizeof(state.memory));
+}
 
-        while (current_cycle < cycles_per_frame) {
-            uint32_t cycle = cpu.tick();
-            current_cycle += cycle;
+bool GameBoy::load_state(const SaveState& state)
+{
+    if (memcmp(state.magic, "GBSS", 4) != 0 || state.version != SAVE_STATE_VERSION || state.size != sizeof(SaveState))
+        return false;
+
+    if (!rom_loaded || state.rom_hash != rom_hash())
+        return false;
+
+    if (state.ppu.backend == PPUBackend::Fifo) // The render thread only serves the scanline backend
+        ppu.set_threaded(false);
+
+    cpu.af = state.cpu.af; cpu.bc = state.cpu.bc; cpu.de = state.cpu.de; cpu.hl = state.cpu.hl;
+    cpu.pc = state.cpu.pc;
+    cpu.sp = state.cpu.sp;
+    cpu.opcode = state.cpu.opcode;
+    cpu.lazy_flags = state.cpu.lazy_flags;
+    cpu.cycles = state.cpu.cycles;
+    cpu.divider_counter = state.cpu.divider_counter;
+    cpu.halted = state.cpu.halted;
+    cpu.interupts_enabled = state.cpu.interupts_enabled;
+
+    cpu.cpu_timer.load_state(state.timer);
+    scheduler.load_state(state.scheduler);
+    joypad.load_state(state.joypad);
+
+    Cartridge* cartridge = mmu.cartridge.get();
+    cartridge->current_rom_bank = state.cartridge.rom_bank;
+    cartridge->current_ram_bank = state.cartridge.ram_bank;
+    cartridge->memory_enabled = state.cartridge.memory_enabled;
+    cartridge->rom_banking = state.cartridge.rom_banking;
+    memcpy(cartridge->memory, state.cartridge.ram, sizeof(cartridge->memory));
+
+    // Rom code stays valid, only code decoded out of RAM that the state changes has to go
+    for (int page = 0x80; page < 0x100; page++) {
+        if (!cpu.block_cache.code_pages[page] && !cpu.dynarec.code_pages[page]) continue;
+
+        uint16_t address = TU16(page << 8);
+        size_t size = 0x100;
+        if (page == 0xFF) { address = 0xFF80; size = 0x7F; } // HRAM, the I/O registers share the page
+
+        if (memcmp(mmu.memory + address, state.memory + address, size) == 0) continue;
+
+        if (cpu.block_cache.code_pages[page]) cpu.block_cache.on_write(address);
+        if (cpu.dynarec.code_pages[page]) cpu.dynarec.on_write(address);
+    }
 
-            cpu.update_timers(cycle);
-            ppu.tick(cycle);
+    // Run-ahead rolls back every frame, so only tiles the state changes are decoded again
+    ppu.renderer.tile_cache.invalidate_changed(state.memory + TILE_DATA);
+    if (ppu.render_thread.running()) // Its VRAM copy and frame belong to the old timeline
+        ppu.render_thread.restore(state.memory, state.ppu.frame);
 
-            cpu.handle_interupts();
-        }
-    }
+    frame_count = state.frame_count;
+    memcpy(mmu.memory, state.memory, sizeof(mmu.memory));
+
+    ppu.line_start = state.ppu.line_start;
+    ppu.lcd_on = state.ppu.lcd_on;
+    ppu.mode = state.ppu.mode;
+    ppu.backend = state.ppu.backend;
+    memcpy(static_cast<void*>(&ppu.fifo), &state.ppu.fifo, sizeof(ppu.fifo));
+    ppu.fifo.init(mmu.memory, ppu.frame);
+    memcpy(ppu.frame, state.ppu.frame, sizeof(ppu.frame));
+
+    // Like a bank switch for the caches, and the page tables follow the banks and boot rom flag
+    cpu.block_cache.on_write(0x2000);
+    cpu.dynarec.on_write(0x2000);
+    mmu.map_pages();
 
-    ppu.blit_pixels();
+    return true;
 }
@@ -3,68 +3,78 @@
 #include <vector>
 #include <functional>
 #include <string>
-#include <imgui.h>
-#include <imgui_file.h>
 
 #include <cpu/mmu.h>
 #include <video/ppu.h>
 #include <cartridge/joypad.h>
 #include <cartridge/cartridge.h>
-#include <logger.h>
+#include <scheduler.h>
+#include <savestate.h>
+#include <rewind.h>
+#include <movie.h>
+
+#define BIOS_SIZE 256
 
 template <typename T>
 using ref = std::shared_ptr<T>;
 
-#define NO_NEWLINE ImGui::SameLine()
-#define NEWLINE ImGui::NewLine()
-
-#define RED ImVec4(255, 0, 0, 255)
-#define YELLOW ImVec4(255, 255, 0, 255)
-#define WHITE ImVec4(255, 255, 255, 255)
-#define BLACK ImVec4(0, 0, 0, 255)
-
-class Window;
+// Emulation core, frontends drive it through tick() and read the frame buffer they hand in
 class GameBoy {
 public:
 	GameBoy();
 
-	void boot(const std::string& boot);
+	static bool read_bios(const std::string& file, uint8_t* bios); // BIOS_SIZE bytes, false when the file is missing or short
+	bool boot(const std::string& file); // False when the boot rom cannot be read
+	void boot(const uint8_t* bios); // One copy read up front can boot any number of instances
 	void load_rom(const std::string& file);
+	void load_rom(std::shared_ptr<RomImage> image); // Instances running the same rom can share one image
 
-	void cpu_stats();
-	void memory_map(uint16_t from, uint16_t to, uint8_t step);
-	void dockspace(std::function<void()> menu_func);
+	void tick(); // One frame of emulation, drawn or not as render_interval says
+	void run_frame(bool draw);
 
-	void log();
-    void menu_function();
+	void expand_frame(uint32_t* pixels) { ppu.expand(pixels, ahead_shown ? ahead_frame.get() : nullptr); } // SCREEN_WIDTH * SCREEN_HEIGHT RGBA pixels
+	void log(const char* fmt, ...); // Forwarded to on_log
 
-	void tick();
-	void display_viewport();
+	void save_state(SaveState& state);
+	bool load_state(const SaveState& state); // False for a state from another version or rom, which is then left alone
+	uint64_t rom_hash() const { return mmu.cartridge ? mmu.cartridge->rom_hash : 0; } // Of the whole image, states and movies only load on the same one
 
 public:
-	const int cycles_per_frame = 17556;
+	const uint32_t cycles_per_frame = 17556;
 	const double fps = 60;
 	const double frame_interval = 1000.0 / fps;
 
 public:
 	MMU mmu;
+	Scheduler scheduler;
 
 	CPU cpu;
 	PPU ppu;
 	Joypad joypad;
-	
-	FileDialog file;
-	Logger logger;
 
-	static std::vector<std::string> hex_str;
-	sf::Sprite viewport;
-	sf::IntRect view_area;
+	std::function<void(const char*)> on_log;
+
+	// Skipped frames keep full PPU timing, STAT/LY and interrupts but leave the frame buffer as it was
+	uint32_t render_interval = 1; // Draw every Nth frame, 0 only draws requested frames
+	bool render_requested = false; // Draws the next frame regardless, cleared by tick()
+	uint64_t frame_count = 0;
+
+	Rewind rewind; // Captures a state before every frame once given a budget
+	bool rewinding = false; // tick() steps back a frame instead of running one
+
+	Movie movie; // Records or plays back the joypad frame by frame
+
+	// Frames emulated past the current one and rolled back, the last of them is shown. Hides that much input lag,
+	// each frame ahead costs about two thirds of a drawn frame and the save and rollback around 10 us together
+	uint32_t run_ahead = 0;
+	bool ahead_shown = false; // expand_frame() gives ahead_frame
+	std::unique_ptr<SaveState> ahead_state;
+	std::unique_ptr<uint8_t[]> ahead_frame;
+
 	uint32_t cycles = 0;
 	uint32_t previous = 0;
 	
 	std::chrono::high_resolution_clock clock;
 	bool frame_complete = true;
-	bool bool_ptr = true;
 	bool rom_loaded = false;
-	bool file_dialog_opened = false;
 };
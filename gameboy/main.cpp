@@ -1,21 +1,78 @@
+// usage: gameboy_frontend [-d mode] [-a frames] [-p shades] [-m movie] [-r] [-t] [-f] [rom.gb]
+//   -d  0 interpreter, 1 dynarec, 2 dynarec (differential), F1 switches while running
+//   -a  run ahead this many frames, PageUp and PageDown change it
+//   -p  custom shades as four RRGGBB values, lightest first and separated by commas, F4 switches schemes
+//   -m  play an input movie, F6 records one to movie.gbm and F7 plays that back
+//   -r  capture rewind snapshots, hold Backspace to step back, F9 toggles
+//   -t  draw on the render thread, F3 toggles
+//   -f  pixel FIFO backend, F2 toggles
 #include <video/window.h>
 #include <gameboy.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <thread>
 #include <iomanip>
 #include <iostream>
 
-void main()
+int main(int argc, char** argv)
 {
+	std::cout.sync_with_stdio(false);
+
+	int mode = 0, ahead = 0;
+	bool rewind = false, threaded = false, fifo = false;
+	const char* shades = nullptr;
+	const char* movie = nullptr;
+
+	for (;;) {
+		if (argc > 2 && argv[1][0] == '-' && argv[1][1] && strchr("da", argv[1][1]) && !argv[1][2]) {
+			(argv[1][1] == 'd' ? mode : ahead) = atoi(argv[2]);
+			argc -= 2; argv += 2;
+		}
+		else if (argc > 2 && (strcmp(argv[1], "-p") == 0 || strcmp(argv[1], "-m") == 0)) {
+			(argv[1][1] == 'p' ? shades : movie) = argv[2];
+			argc -= 2; argv += 2;
+		}
+		else if (argc > 1 && argv[1][0] == '-' && argv[1][1] && strchr("rtf", argv[1][1]) && !argv[1][2]) {
+			(argv[1][1] == 'r' ? rewind : argv[1][1] == 't' ? threaded : fifo) = true;
+			argc--; argv++;
+		}
+		else break;
+	}
+
 	GameBoy gb;
 	Window window(560, 504, "Gameboy Emulator", &gb);
 
 	gb.boot("bios.gb");
-	gb.load_rom("../roms/mario2.gb");
+	gb.load_rom(argc > 1 ? argv[1] : "../roms/mario2.gb");
+
+	if (mode && gb.cpu.dynarec.supported())
+		gb.cpu.dynarec.set_mode((DynarecMode)mode);
+
+	gb.ppu.set_backend(fifo ? PPUBackend::Fifo : PPUBackend::Scanline);
+	gb.ppu.set_threaded(threaded);
+	gb.run_ahead = uint32_t(std::min(std::max(ahead, 0), MAX_RUN_AHEAD));
+	gb.rewind.budget = rewind ? REWIND_BUDGET : 0;
+
+	unsigned rgb[4];
+	if (shades && sscanf(shades, "%x,%x,%x,%x", &rgb[0], &rgb[1], &rgb[2], &rgb[3]) == 4) {
+		for (unsigned color : rgb)
+			window.custom_colors.push_back(RGBA((color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF));
+
+		std::copy(window.custom_colors.begin(), window.custom_colors.end(), gb.ppu.colors);
+		gb.ppu.set_color_scheme(ColorScheme::Custom);
+	}
+	else if (shades) {
+		fprintf(stderr, "gameboy: shades take four RRGGBB values, not %s\n", shades);
+	}
+
+	if (movie) window.play_movie(movie);
 
 	while (!window.should_close()) {
 		window.update();
-		
-		gb.tick();		
+
+		gb.tick();
 		window.render();
 	}
-}
\ No newline at end of file
+}
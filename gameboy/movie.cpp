@@ -0,0 +1,92 @@
+#include "movie.h"
+#include <gameboy.h>
+#include <cstring>
+#include <fstream>
+
+void Movie::record(GameBoy& gb)
+{
+    if (!start) start = std::make_unique<SaveState>();
+    gb.save_state(*start);
+
+    hash = gb.rom_hash();
+    inputs.clear();
+    position = 0;
+    mode = MovieMode::Recording;
+}
+
+bool Movie::play(GameBoy& gb)
+{
+    mode = MovieMode::Off;
+    if (!start || hash != gb.rom_hash() || !gb.load_state(*start)) return false;
+
+    position = 0;
+    mode = MovieMode::Playing;
+    return true;
+}
+
+void Movie::on_frame(GameBoy& gb)
+{
+    if (mode == MovieMode::Recording) {
+        Joypad::State state = gb.joypad.save_state();
+        inputs.push_back(TU8(state.buttons << 4 | (state.arrows & 0xF)));
+    }
+    else if (mode == MovieMode::Playing) {
+        if (position == inputs.size()) {
+            mode = MovieMode::Off; // The keys stay as the last frame had them
+            return;
+        }
+
+        uint8_t input = inputs[position++];
+        gb.joypad.apply({ TU8(input & 0xF), TU8(input >> 4) });
+    }
+}
+
+void Movie::on_rewind()
+{
+    if (mode == MovieMode::Recording && !inputs.empty())
+        inputs.pop_back();
+    else if (mode == MovieMode::Playing && position)
+        position--;
+}
+
+bool Movie::save(const std::string& path) const
+{
+    if (!start) return false;
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+
+    MovieHeader header;
+    header.rom_hash = hash;
+    header.frames = TU32(inputs.size());
+
+    out.write(RCAST(const char*, &header), sizeof(header));
+    out.write(RCAST(const char*, start.get()), sizeof(SaveState));
+    out.write(RCAST(const char*, inputs.data()), inputs.size());
+
+    return bool(out);
+}
+
+bool Movie::load(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+
+    MovieHeader header;
+    in.read(RCAST(char*, &header), sizeof(header));
+
+    if (!in || memcmp(header.magic, "GBMV", 4) != 0 || header.version != MOVIE_VERSION || header.state_size != sizeof(SaveState))
+        return false;
+
+    if (!start) start = std::make_unique<SaveState>();
+    in.read(RCAST(char*, start.get()), sizeof(SaveState));
+
+    inputs.resize(header.frames);
+    in.read(RCAST(char*, inputs.data()), header.frames);
+    if (!in) return false;
+
+    hash = header.rom_hash;
+    position = 0;
+    mode = MovieMode::Off;
+    return true;
+}
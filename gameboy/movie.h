@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <savestate.h>
+
+#define MOVIE_VERSION 1
+
+// Written at the start of a movie file, the initial SaveState and then one input byte per frame follow
+struct MovieHeader {
+    char magic[4] = { 'G', 'B', 'M', 'V' };
+    uint32_t version = MOVIE_VERSION;
+    uint64_t rom_hash = 0;
+    uint32_t frames = 0;
+    uint32_t state_size = sizeof(SaveState);
+};
+
+enum class MovieMode {
+    Off,
+    Recording,
+    Playing
+};
+
+class GameBoy;
+
+// Joypad input per frame from a saved starting state. Input only changes between frames, so replaying it
+// from the same state runs exactly the same
+class Movie {
+public:
+    void record(GameBoy& gb); // From the current state
+    bool play(GameBoy& gb); // Back to the initial state, false for another rom
+    void stop() { mode = MovieMode::Off; }
+
+    void on_frame(GameBoy& gb); // GameBoy::tick calls it before each frame
+    void on_rewind(); // The last frame was taken back
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+public:
+    MovieMode mode = MovieMode::Off;
+
+    uint64_t hash = 0; // Of the rom it was recorded on
+    std::unique_ptr<SaveState> start;
+    std::vector<uint8_t> inputs; // Buttons in the high nibble, arrows in the low, 0 is pressed
+    size_t position = 0; // Next frame played
+};
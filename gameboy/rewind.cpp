@@ -0,0 +1,192 @@
+#include "rewind.h"
+#include <gameboy.h>
+#include <cstring>
+
+static_assert(sizeof(SaveState) % 8 == 0, "Deltas are coded in whole words");
+
+static inline uint64_t load_word(const uint8_t* p)
+{
+    uint64_t word;
+    memcpy(&word, p, 8);
+    return word;
+}
+
+static inline uint8_t* put_count(uint8_t* out, size_t count)
+{
+    while (count >= 0x80) {
+        *out++ = TU8(count | 0x80);
+        count >>= 7;
+    }
+
+    *out++ = TU8(count);
+    return out;
+}
+
+static inline const uint8_t* get_count(const uint8_t* in, size_t& count)
+{
+    count = 0;
+    for (int shift = 0;; shift += 7) {
+        uint8_t byte = *in++;
+        count |= size_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return in;
+    }
+}
+
+size_t Rewind::encode(const uint8_t* state, const uint8_t* key, uint8_t* out)
+{
+    const size_t words = sizeof(SaveState) / 8;
+    uint8_t* start = out;
+    size_t i = 0;
+
+    while (i < words) {
+        size_t same = i;
+        while (i < words && load_word(state + i * 8) == load_word(key + i * 8)) i++;
+
+        if (i == words) break; // The rest matches, nothing to record
+
+        size_t differ = i;
+        while (i < words && load_word(state + i * 8) != load_word(key + i * 8)) i++;
+
+        out = put_count(out, differ - same);
+        out = put_count(out, i - differ);
+
+        for (size_t w = differ; w < i; w++) {
+            uint64_t word = load_word(state + w * 8) ^ load_word(key + w * 8);
+            memcpy(out, &word, 8);
+            out += 8;
+        }
+    }
+
+    return out - start;
+}
+
+void Rewind::decode(const uint8_t* delta, size_t size, uint8_t* state)
+{
+    const uint8_t* end = delta + size;
+    uint8_t* word = state;
+
+    while (delta < end) {
+        size_t same, differ;
+        delta = get_count(delta, same);
+        delta = get_count(delta, differ);
+
+        word += same * 8;
+        for (size_t i = 0; i < differ * 8; i++)
+            word[i] ^= delta[i];
+
+        word += differ * 8;
+        delta += differ * 8;
+    }
+}
+
+void Rewind::capture(GameBoy& gb)
+{
+    if (budget != capacity) {
+        clear();
+        ring.reset(budget ? new uint8_t[budget] : nullptr);
+        capacity = budget;
+    }
+
+    if (capacity < sizeof(SaveState)) return; // Not even one keyframe fits
+
+    if (!state) {
+        state = std::make_unique<SaveState>();
+        delta.reset(new uint8_t[MAX_DELTA]);
+    }
+
+    gb.save_state(*state);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(state.get());
+
+    if (!snapshots.empty() && snapshots.size() - newest_key() < keyframe_interval) {
+        size_t size = encode(bytes, ring.get() + snapshots[newest_key()].offset, delta.get());
+
+        if (size < sizeof(SaveState)) {
+            store(delta.get(), size, false);
+            if (!snapshots.empty()) return;
+            // Making room took its keyframe as well, so it is kept whole after all
+        }
+    }
+
+    store(bytes, sizeof(SaveState), true);
+}
+
+bool Rewind::step_back(GameBoy& gb)
+{
+    if (snapshots.empty()) return false;
+
+    Snapshot last = snapshots.back();
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(state.get());
+
+    memcpy(bytes, ring.get() + snapshots[newest_key()].offset, sizeof(SaveState));
+    if (!last.key) decode(ring.get() + last.offset, last.size, bytes);
+
+    snapshots.pop_back();
+    used -= last.size;
+    head = last.offset;
+
+    if (!gb.load_state(*state)) { // Taken from another rom
+        clear();
+        return false;
+    }
+
+    return true;
+}
+
+void Rewind::clear()
+{
+    snapshots.clear();
+    head = used = 0;
+}
+
+size_t Rewind::newest_key() const
+{
+    size_t index = snapshots.size() - 1;
+    while (!snapshots[index].key) index--;
+
+    return index;
+}
+
+void Rewind::store(const uint8_t* data, size_t size, bool key)
+{
+    uint8_t* out = allocate(size);
+    if (!key && snapshots.empty()) return; // Making room took the keyframe it is coded against
+
+    memcpy(out, data, size);
+
+    snapshots.push_back({ head, size, key });
+    head += size;
+    used += size;
+}
+
+uint8_t* Rewind::allocate(size_t size)
+{
+    for (;;) {
+        if (snapshots.empty()) {
+            if (head + size > capacity) head = 0;
+            break;
+        }
+
+        size_t tail = snapshots.front().offset;
+
+        if (tail < head) { // In use: [tail, head)
+            if (head + size <= capacity) break;
+            head = 0; // Snapshots do not wrap, the end of the ring is left unused this time round
+            continue;
+        }
+
+        // In use: [tail, end) and [0, head)
+        if (head + size <= tail) break;
+        drop_oldest();
+    }
+
+    return ring.get() + head;
+}
+
+void Rewind::drop_oldest()
+{
+    // Its deltas are no use without the keyframe, so they go with it
+    do {
+        used -= snapshots.front().size;
+        snapshots.pop_front();
+    } while (!snapshots.empty() && !snapshots.front().key);
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+#include <savestate.h>
+
+class GameBoy;
+
+// Per-frame save states for stepping back through play, kept in one ring of budget bytes. Every keyframe_interval-th
+// state is stored whole, the others as run-length coded XOR deltas against it, as most of memory stays the same.
+class Rewind {
+public:
+    void capture(GameBoy& gb); // The state as of now, GameBoy::tick takes one before each frame
+    bool step_back(GameBoy& gb); // Back to the newest capture, which is then dropped. False once there are none left
+    void clear();
+
+    size_t frames() const { return snapshots.size(); }
+    size_t memory_used() const { return used; } // Bytes of the ring the snapshots take up
+
+    // Delta of state against key, in 8 byte words: (equal words, differing words, their XOR) repeated
+    static size_t encode(const uint8_t* state, const uint8_t* key, uint8_t* out); // out holds MAX_DELTA bytes
+    static void decode(const uint8_t* delta, size_t size, uint8_t* state); // state holds the keyframe
+
+    static constexpr size_t MAX_DELTA = sizeof(SaveState) + sizeof(SaveState) / 2 + 16;
+
+public:
+    size_t budget = 0; // Ring size in bytes, the oldest keyframe and its deltas go first when full. 0 turns capturing off
+    uint32_t keyframe_interval = 60;
+
+private:
+    struct Snapshot {
+        size_t offset, size;
+        bool key;
+    };
+
+    size_t newest_key() const; // Index of the keyframe the newest snapshots are coded against
+    uint8_t* allocate(size_t size); // Room at head, dropping the oldest snapshots it would overwrite
+    void drop_oldest();
+    void store(const uint8_t* data, size_t size, bool key);
+
+private:
+    std::unique_ptr<uint8_t[]> ring;
+    size_t capacity = 0;
+    size_t head = 0; // Where the next snapshot goes, snapshots never wrap around the end
+    size_t used = 0;
+
+    std::deque<Snapshot> snapshots; // Oldest first
+    std::unique_ptr<SaveState> state;
+    std::unique_ptr<uint8_t[]> delta;
+};
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <type_traits>
+
+#include <cpu/cpu.h>
+#include <video/ppu.h>
+#include <cartridge/joypad.h>
+#include <scheduler.h>
+
+#define SAVE_STATE_VERSION 3 // Bump whenever a section changes layout
+
+// Everything a running GameBoy needs to carry on, except the rom, as plain sections in one block.
+// Saving and loading are a copy per section, so a state can also go to disk or be diffed as is.
+struct SaveState {
+	char magic[4] = { 'G', 'B', 'S', 'S' };
+	uint32_t version = SAVE_STATE_VERSION;
+	uint32_t size = sizeof(SaveState);
+	uint64_t rom_hash = 0; // GameBoy::rom_hash of the rom it was taken from
+
+	struct {
+		Register af, bc, de, hl;
+		uint16_t pc, sp, opcode;
+		LazyFlags lazy_flags;
+		uint32_t cycles, divider_counter;
+		bool halted, interupts_enabled;
+	} cpu;
+
+	Timer::State timer;
+	Scheduler::State scheduler;
+	Joypad::State joypad;
+
+	struct {
+		uint64_t line_start;
+		bool lcd_on;
+		LCDMode mode;
+		PPUBackend backend;
+		PixelFifo fifo; // Its memory and frame pointers are set again on load
+		uint8_t frame[SCREEN_WIDTH * SCREEN_HEIGHT];
+	} ppu;
+
+	struct {
+		uint8_t rom_bank, ram_bank;
+		bool memory_enabled, rom_banking;
+		uint8_t ram[0x8000];
+	} cartridge;
+
+	uint64_t frame_count;
+	uint8_t memory[0x10000];
+};
+
+static_assert(std::is_trivially_copyable<SaveState>::value, "SaveState is copied with memcpy");
+
+// FNV-1a over the whole block, equal for equal states as save_state zeroes the padding
+inline uint64_t state_hash(const SaveState& state)
+{
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&state);
+	uint64_t hash = 0xCBF29CE484222325ull;
+
+	for (size_t i = 0; i < sizeof(SaveState); i++) {
+		hash ^= bytes[i];
+		hash *= 0x100000001B3ull;
+	}
+
+	return hash;
+}
@@ -0,0 +1,73 @@
+#include "scheduler.h"
+#include <algorithm>
+
+Scheduler::Scheduler()
+{
+    reset();
+}
+
+void Scheduler::set_handler(Event event, Handler handler)
+{
+    handlers[(int)event] = handler;
+}
+
+void Scheduler::schedule(Event event, uint64_t deadline)
+{
+    deadlines[(int)event] = deadline;
+    update_next();
+}
+
+void Scheduler::cancel(Event event)
+{
+    schedule(event, NEVER);
+}
+
+void Scheduler::run_due()
+{
+    while (now >= next) {
+        int earliest = 0;
+        for (int i = 1; i < (int)Event::Count; i++)
+            if (deadlines[i] < deadlines[earliest]) earliest = i;
+
+        if (deadlines[earliest] > now) return; // Only the limit has passed
+
+        // Handlers reschedule themselves when they need to run again
+        deadlines[earliest] = NEVER;
+        update_next();
+
+        handlers[earliest]();
+    }
+}
+
+void Scheduler::reset()
+{
+    now = previous = 0;
+
+    for (uint64_t& deadline : deadlines)
+        deadline = NEVER;
+    limit = next = NEVER;
+}
+
+Scheduler::State Scheduler::save_state() const
+{
+    State state = { now, previous, {} };
+    std::copy(deadlines, deadlines + (int)Event::Count, state.deadlines);
+
+    return state;
+}
+
+void Scheduler::load_state(const State& state)
+{
+    now = state.now;
+    previous = state.previous;
+
+    std::copy(state.deadlines, state.deadlines + (int)Event::Count, deadlines);
+    update_next();
+}
+
+void Scheduler::update_next()
+{
+    next = limit;
+    for (uint64_t deadline : deadlines)
+        if (deadline < next) next = deadline;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+
+enum class Event : uint8_t {
+    PPU,
+    Timer,
+    Count
+};
+
+// Cycle timestamped deadlines, the CPU runs uninterrupted until the earliest one passes
+class Scheduler {
+public:
+    using Handler = std::function<void()>;
+
+    static constexpr uint64_t NEVER = UINT64_MAX;
+
+    Scheduler();
+
+    void set_handler(Event event, Handler handler);
+
+    void schedule(Event event, uint64_t deadline);
+    void schedule_next(Event event) { schedule(event, now + 1); } // After the running instruction
+    void cancel(Event event);
+    void set_limit(uint64_t cycle) { limit = cycle; update_next(); } // due() from here on without an event, ends a frame
+
+    void advance(uint32_t cycles) { previous = now; now += cycles; }
+    bool due() const { return now >= next; }
+    const uint64_t& next_deadline() const { return next; } // Translated code compares now against it in place
+    void run_due();
+
+    void reset();
+
+    struct State {
+        uint64_t now, previous;
+        uint64_t deadlines[(int)Event::Count];
+    };
+
+    State save_state() const;
+    void load_state(const State& state);
+
+public:
+    uint64_t now = 0;      // M-cycles since power on, always on an instruction boundary
+    uint64_t previous = 0; // Boundary before the last instruction
+
+private:
+    void update_next();
+
+    // Only a handful of event kinds exist, a linear scan is cheaper than keeping a heap
+    Handler handlers[(int)Event::Count];
+    uint64_t deadlines[(int)Event::Count];
+    uint64_t limit = NEVER;
+    uint64_t next = NEVER;
+};
@@ -0,0 +1,297 @@
+// Runs many independent GameBoy instances on a work stealing thread pool and reports the aggregate speed
+// usage: batch [-j threads] [-d mode] [-n copies] bios.gb jobs.txt
+//   -j  worker threads, all cores by default
+//   -d  0 interpreter, 1 dynarec
+//   -n  run every job this many times
+//   jobs.txt has one job per line: rom.gb frames [movie.gbm|-] [out.ppm], # starts a comment.
+//   Frames 0 with a movie plays all of it. Each job prints the hash of its final state
+#include <gameboy.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+// One run, advanced a slice of frames at a time so idle workers can take over what is left
+struct Job {
+    std::string rom, movie, output;
+    int frames = 0;
+    int done = 0;
+
+    std::shared_ptr<RomImage> image;
+    std::unique_ptr<GameBoy> gb; // Only while it runs
+
+    std::function<void(Job&)> on_start; // Sets the new instance up, resetting gb drops the job
+    std::function<void(Job&)> on_frame; // After every frame
+    std::function<void(Job&)> on_finish; // Before the instance is freed
+};
+
+// Per worker deques, a worker takes its own newest job and steals the oldest one from another. Workers with
+// nothing to take sleep until a job is handed back or the last one finishes
+class WorkPool {
+public:
+    static constexpr int SLICE = 60; // Frames run before a job is handed back
+
+    WorkPool(int _threads) : threads(_threads), queues(_threads) {}
+
+    void add(Job* job)
+    {
+        queues[next++ % threads].jobs.push_back(job);
+        pending++;
+    }
+
+    void run()
+    {
+        std::vector<std::thread> workers;
+        for (int i = 1; i < threads; i++)
+            workers.emplace_back(&WorkPool::work, this, i);
+
+        work(0);
+
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    std::atomic<uint64_t> frames{ 0 };
+    std::atomic<uint64_t> steals{ 0 };
+
+private:
+    struct Queue {
+        std::mutex lock;
+        std::deque<Job*> jobs;
+    };
+
+    Job* take(int self)
+    {
+        {
+            Queue& own = queues[self];
+            std::lock_guard<std::mutex> guard(own.lock);
+
+            if (!own.jobs.empty()) {
+                Job* job = own.jobs.back();
+                own.jobs.pop_back();
+                return job;
+            }
+        }
+
+        for (int i = 1; i < threads; i++) {
+            Queue& victim = queues[(self + i) % threads];
+            std::lock_guard<std::mutex> guard(victim.lock);
+
+            if (!victim.jobs.empty()) {
+                Job* job = victim.jobs.front();
+                victim.jobs.pop_front();
+                steals++;
+                return job;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void work(int self)
+    {
+        for (;;) {
+            uint64_t seen;
+            {
+                std::lock_guard<std::mutex> guard(idle_lock);
+                if (!pending) return;
+                seen = handed_back;
+            }
+
+            Job* job = take(self);
+            if (!job) { // The rest is running elsewhere, it may still come back
+                std::unique_lock<std::mutex> guard(idle_lock);
+                idle.wait(guard, [&]() { return !pending || handed_back != seen; });
+                continue;
+            }
+
+            if (run_slice(*job)) {
+                {
+                    std::lock_guard<std::mutex> guard(queues[self].lock);
+                    queues[self].jobs.push_back(job);
+                }
+                {
+                    std::lock_guard<std::mutex> guard(idle_lock);
+                    handed_back++;
+                }
+                idle.notify_one();
+            }
+            else {
+                std::lock_guard<std::mutex> guard(idle_lock);
+                if (--pending == 0) idle.notify_all();
+            }
+        }
+    }
+
+    bool run_slice(Job& job) // False once the job is finished
+    {
+        if (!job.gb) {
+            job.gb = std::make_unique<GameBoy>();
+            if (job.on_start) job.on_start(job);
+            if (!job.gb) return false;
+        }
+
+        int first = job.done, end = std::min(job.done + SLICE, job.frames);
+        for (; job.done < end; job.done++) {
+            job.gb->render_requested = job.done == job.frames - 1 && !job.output.empty();
+            job.gb->tick();
+            if (job.on_frame) job.on_frame(job);
+        }
+
+        frames += job.done - first;
+        if (job.done < job.frames) return true;
+
+        if (job.on_finish) job.on_finish(job);
+        job.gb.reset();
+        return false;
+    }
+
+private:
+    int threads;
+    std::vector<Queue> queues;
+    size_t next = 0;
+
+    std::mutex idle_lock;
+    std::condition_variable idle;
+    int pending = 0; // Jobs not finished yet, under idle_lock
+    uint64_t handed_back = 0; // Slices pushed back so far, under idle_lock
+};
+
+static bool write_ppm(const char* path, const std::vector<uint32_t>& pixels)
+{
+    FILE* out = fopen(path, "wb");
+    if (!out) return false;
+
+    fprintf(out, "P6\n%d %d\n255\n", SCREEN_WIDTH, SCREEN_HEIGHT);
+    for (uint32_t pixel : pixels) {
+        uint8_t rgb[3] = { TU8(pixel), TU8(pixel >> 8), TU8(pixel >> 16) };
+        fwrite(rgb, 1, 3, out);
+    }
+
+    fclose(out);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    int threads = int(std::thread::hardware_concurrency()), mode = 0, copies = 1;
+
+    while (argc > 2 && argv[1][0] == '-' && argv[1][1] && strchr("jdn", argv[1][1]) && !argv[1][2]) {
+        int& value = argv[1][1] == 'j' ? threads : argv[1][1] == 'd' ? mode : copies;
+        value = atoi(argv[2]);
+        argc -= 2; argv += 2;
+    }
+
+    if (argc < 3) {
+        fprintf(stderr, "usage: batch [-j threads] [-d mode] [-n copies] bios.gb jobs.txt\n");
+        return 1;
+    }
+
+    std::ifstream list(argv[2]);
+    if (!list) {
+        fprintf(stderr, "batch: cannot open %s\n", argv[2]);
+        return 1;
+    }
+
+    uint8_t bios[BIOS_SIZE]; // Read once here, workers only copy it
+    if (!GameBoy::read_bios(argv[1], bios)) {
+        fprintf(stderr, "batch: cannot read %s\n", argv[1]);
+        return 1;
+    }
+
+    std::map<std::string, std::shared_ptr<RomImage>> images; // Every instance of a rom reads the same image
+    std::deque<Job> jobs;
+    std::mutex print;
+
+    std::string line;
+    while (std::getline(list, line)) {
+        std::istringstream fields(line.substr(0, line.find('#')));
+        std::string rom, movie, output;
+        int frames = 0;
+
+        if (!(fields >> rom >> frames)) continue;
+        fields >> movie >> output;
+        if (movie == "-") movie.clear();
+
+        auto& image = images[rom];
+        if (!image && !(image = RomImage::load(rom))) {
+            fprintf(stderr, "batch: cannot read %s\n", rom.c_str());
+            return 1;
+        }
+
+        for (int i = 0; i < copies; i++) {
+            Job& job = jobs.emplace_back();
+            job.rom = rom;
+            job.movie = movie;
+            job.output = output;
+            job.frames = frames;
+            job.image = image;
+        }
+    }
+
+    for (Job& entry : jobs) {
+        entry.on_start = [&](Job& job) {
+            GameBoy& gb = *job.gb;
+            gb.boot(bios);
+            gb.load_rom(job.image);
+            gb.render_interval = 0; // Only frames with an output are drawn
+
+            if (mode && gb.cpu.dynarec.supported())
+                gb.cpu.dynarec.set_mode((DynarecMode)mode);
+
+            if (!job.movie.empty()) {
+                if (!gb.movie.load(job.movie) || !gb.movie.play(gb)) {
+                    std::lock_guard<std::mutex> guard(print);
+                    fprintf(stderr, "batch: %s is not a movie of %s\n", job.movie.c_str(), job.rom.c_str());
+                    job.gb.reset();
+                    return;
+                }
+
+                if (!job.frames) job.frames = int(gb.movie.inputs.size());
+            }
+        };
+
+        entry.on_finish = [&](Job& job) {
+            auto state = std::make_unique<SaveState>();
+            job.gb->save_state(*state);
+
+            if (!job.output.empty()) {
+                std::vector<uint32_t> pixels(SCREEN_WIDTH * SCREEN_HEIGHT);
+                job.gb->expand_frame(pixels.data());
+                if (!write_ppm(job.output.c_str(), pixels)) {
+                    std::lock_guard<std::mutex> guard(print);
+                    fprintf(stderr, "batch: cannot create %s\n", job.output.c_str());
+                }
+            }
+
+            std::lock_guard<std::mutex> guard(print);
+            printf("%s %d frames state %016llx\n", job.rom.c_str(), job.frames, (unsigned long long)state_hash(*state));
+        };
+    }
+
+    WorkPool pool(std::max(threads, 1));
+    for (Job& job : jobs)
+        pool.add(&job);
+
+    auto start = std::chrono::steady_clock::now();
+    pool.run();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t frames = pool.frames;
+    printf("%zu jobs, %llu frames in %.3f s on %d threads, %.1f fps (%llu steals)\n", jobs.size(), (unsigned long long)frames,
+        seconds, std::max(threads, 1), frames / seconds, (unsigned long long)pool.steals.load());
+
+    return 0;
+}
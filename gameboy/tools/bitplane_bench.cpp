@@ -0,0 +1,76 @@
+// Checks the tile decoders against a bit-by-bit reference and times them
+// usage: bitplane_bench [tiles]
+#include <video/bitplane.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static void decode_tile_reference(const uint8_t* planes, uint8_t* out, bool flip)
+{
+    for (int y = 0; y < 8; y++) {
+        uint8_t low = planes[y * 2], high = planes[y * 2 + 1];
+
+        for (int x = 0; x < 8; x++) {
+            int bit = flip ? x : 7 - x;
+            out[y * 8 + x] = (((high >> bit) & 1) << 1) | ((low >> bit) & 1);
+        }
+    }
+}
+
+struct Decoder {
+    const char* name;
+    TileDecoder decode;
+    bool available;
+};
+
+int main(int argc, char** argv)
+{
+    int tiles = argc > 1 ? atoi(argv[1]) : 1 << 16;
+    if (tiles <= 0) {
+        fprintf(stderr, "usage: bitplane_bench [tiles]\n");
+        return 1;
+    }
+
+    std::vector<uint8_t> planes(tiles * 16);
+    uint32_t seed = 0x2BB0;
+    for (uint8_t& b : planes) {
+        seed = seed * 1664525 + 1013904223;
+        b = seed >> 24;
+    }
+
+    Decoder decoders[] = {
+        { "reference", decode_tile_reference, true },
+        { "scalar", decode_tile_scalar, true },
+        { "sse2", decode_tile_sse2, has_sse2() },
+        { "avx2", decode_tile_avx2, has_avx2() },
+    };
+
+    std::vector<uint8_t> expected(tiles * 64), out(tiles * 64);
+    printf("runtime pick: %s\n", decode_tile_name);
+
+    for (bool flip : { false, true }) {
+        for (int i = 0; i < tiles; i++)
+            decode_tile_reference(&planes[i * 16], &expected[i * 64], flip);
+
+        for (const Decoder& d : decoders) {
+            if (!d.available) continue;
+
+            double best = 1e9;
+            for (int pass = 0; pass < 5; pass++) {
+                auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < tiles; i++)
+                    d.decode(&planes[i * 16], &out[i * 64], flip);
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                if (seconds < best) best = seconds;
+            }
+
+            bool match = memcmp(out.data(), expected.data(), out.size()) == 0;
+            printf("%-9s %s %6.2f ns/tile %s\n", d.name, flip ? "flip" : "    ", best * 1e9 / tiles, match ? "ok" : "MISMATCH");
+            if (!match) return 1;
+        }
+    }
+
+    return 0;
+}
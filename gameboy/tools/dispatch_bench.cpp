@@ -0,0 +1,121 @@
+// Times opcode dispatch through the flat tables against the std::map lookup they replaced
+// usage: dispatch_bench [instructions]
+#include <gameboy.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+
+// What a lookup entry used to be, copied out of the map on every step
+struct MapInstruction {
+    std::string name;
+    std::function<int()> exec = nullptr;
+    uint32_t cycles = 0;
+};
+
+// ALU and CB heavy loop at 0x150, entered from 0x100
+static std::shared_ptr<RomImage> make_rom()
+{
+    static const uint8_t loop[] = {
+        0x80, 0x89, 0x92, 0xAB, 0x04, 0x0D, // ADD A,B  ADC A,C  SUB D  XOR E  INC B  DEC C
+        0xCB, 0x02, 0xCB, 0x33, 0xCB, 0x5F, 0xCB, 0x3C, // RLC D  SWAP E  BIT 3,A  SRL H
+        0xB5, 0xB8, 0x23, 0x9A, 0xCB, 0x11, 0x2F, 0x3C, // OR L  CP B  INC HL  SBC A,D  RL C  CPL  INC A
+    };
+
+    auto image = std::make_shared<RomImage>();
+    image->size = 0x8000;
+
+    uint8_t* rom = image->data;
+    rom[0x100] = 0xC3; rom[0x101] = 0x50; rom[0x102] = 0x01; // JP 0x150
+
+    uint16_t address = 0x150;
+    for (uint8_t byte : loop)
+        rom[address++] = byte;
+
+    rom[address] = 0x18; // JR 0x150
+    rom[address + 1] = TU8(0x150 - (address + 2));
+
+    return image;
+}
+
+static void start(GameBoy& gb, std::shared_ptr<RomImage> image)
+{
+    gb.mmu.memory[BOOTING] = 1;
+    gb.load_rom(image);
+    gb.cpu.reset();
+
+    gb.cpu.bc = 0x1234; gb.cpu.de = 0x5678; gb.cpu.hl = 0x9ABC;
+}
+
+static uint64_t registers(CPU& cpu)
+{
+    cpu.resolve_flags();
+
+    uint64_t value = 0;
+    for (const Register* reg : { &cpu.af, &cpu.bc, &cpu.de, &cpu.hl })
+        value = (value << 16) | CPU::combine(reg->l, reg->h);
+
+    return value;
+}
+
+int main(int argc, char** argv)
+{
+    long instructions = argc > 1 ? atol(argv[1]) : 20000000;
+    if (instructions <= 0) {
+        fprintf(stderr, "usage: dispatch_bench [instructions]\n");
+        return 1;
+    }
+
+    auto image = make_rom();
+    auto tables = std::make_unique<GameBoy>();
+    auto mapped = std::make_unique<GameBoy>();
+    start(*tables, image);
+    start(*mapped, image);
+
+    // The old lookup, keyed by opcode and 0xCBxx for the prefixed ones
+    std::map<uint16_t, MapInstruction> lookup;
+    CPU& old = mapped->cpu;
+    for (int code = 0; code < 256; code++) {
+        lookup[TU16(code)] = { old.mnemonics[code], std::bind(old.lookup[code].exec, &old), old.lookup[code].cycles };
+        lookup[CPU::combine(TU8(code), 0xCB)] = { old.cb_mnemonics[code], std::bind(old.cb_lookup[code].exec, &old), old.cb_lookup[code].cycles };
+    }
+
+    uint64_t cycles_tables = 0, cycles_map = 0;
+
+    auto begin = std::chrono::steady_clock::now();
+    CPU& cpu = tables->cpu;
+    for (long i = 0; i < instructions; i++) {
+        cpu.opcode = cpu.mmu->read(cpu.pc++);
+        const Instruction* instr = &cpu.lookup[cpu.opcode];
+
+        if (cpu.opcode == 0xCB) {
+            uint8_t code = cpu.mmu->read(cpu.pc++);
+
+            cpu.opcode = CPU::combine(code, 0xCB);
+            instr = &cpu.cb_lookup[code];
+        }
+
+        cycles_tables += instr->cycles + (cpu.*instr->exec)();
+    }
+    double seconds_tables = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    begin = std::chrono::steady_clock::now();
+    for (long i = 0; i < instructions; i++) {
+        old.opcode = old.mmu->read(old.pc++);
+
+        if (old.opcode == 0xCB)
+            old.opcode = CPU::combine(old.mmu->read(old.pc++), 0xCB);
+
+        MapInstruction instr = lookup[old.opcode];
+        cycles_map += instr.cycles + instr.exec();
+    }
+    double seconds_map = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    bool match = cycles_tables == cycles_map && cpu.pc == old.pc && registers(cpu) == registers(old);
+
+    printf("std::map %8.2f M instr/s\n", instructions / seconds_map / 1e6);
+    printf("tables   %8.2f M instr/s  %.1fx %s\n", instructions / seconds_tables / 1e6, seconds_map / seconds_tables, match ? "ok" : "MISMATCH");
+
+    return match ? 0 : 1;
+}
@@ -0,0 +1,371 @@
+// Runs every opcode that sets or reads the flags over operand and incoming flag values, once with the incoming
+// flags still pending from a previous ALU operation and once already materialised in F, and compares both with
+// a model written from the flag rules alone
+// usage: flags_check
+#include <gameboy.h>
+#include <cstdio>
+#include <cstring>
+
+static const uint16_t OPERAND = 0xC000; // (HL)
+static const uint16_t CODE = 0xC100; // Immediate operands are fetched from here
+static const uint16_t STACK = 0xD000;
+
+// What an opcode can read or change
+struct Machine {
+    uint8_t r[8]; // B C D E H L (HL) A, the encoding's operand order
+    uint8_t f;
+    uint16_t sp, pc;
+    uint8_t imm[2];
+    uint8_t stack[4]; // STACK - 2 to STACK + 1
+
+    uint16_t pair(int index) const { return index == 3 ? sp : CPU::combine(r[index * 2 + 1], r[index * 2]); } // BC DE HL SP
+    void set_pair(int index, uint16_t value) { r[index * 2] = TU8(value >> 8); r[index * 2 + 1] = TU8(value); }
+
+    bool operator==(const Machine& other) const { return memcmp(this, &other, sizeof(Machine)) == 0; }
+};
+
+static Machine setup(uint8_t a, uint8_t value, uint8_t f)
+{
+    Machine m = { { 0x5A, 0xA5, 0x0F, 0xF0, TU8(OPERAND >> 8), TU8(OPERAND), value, a }, f, STACK, CODE, { 0x34, 0x12 }, { 0x11, 0x22, 0x33, 0x44 } };
+    return m;
+}
+
+// Incoming flags as a pending record that materialises to f, the way the previous ALU operation leaves them
+static LazyFlags pending(uint8_t f)
+{
+    uint16_t result = ((f >> Z) & 1 ? 0 : 1) | ((f >> C) & 1 ? 0x100 : 0);
+    uint8_t operands = TU8(result ^ (((f >> H) & 1) << 4));
+
+    return { true, bool((f >> N) & 1), operands, result };
+}
+
+static Machine run(GameBoy& gb, uint16_t code, const Machine& in, bool lazy)
+{
+    CPU& cpu = gb.cpu;
+    uint8_t* memory = gb.mmu.memory;
+
+    cpu.bc = in.pair(0); cpu.de = in.pair(1); cpu.hl = in.pair(2);
+    cpu.sp = in.sp;
+    cpu.pc = in.pc;
+    cpu.af.h = in.r[7];
+    cpu.opcode = code;
+
+    memory[OPERAND] = in.r[6];
+    memcpy(memory + CODE, in.imm, 2);
+    memcpy(memory + STACK - 2, in.stack, 4);
+
+    if (lazy) {
+        cpu.af.l = 0;
+        cpu.lazy_flags = pending(in.f);
+    }
+    else {
+        cpu.af.l = in.f;
+        cpu.lazy_flags = LazyFlags();
+    }
+
+    const Instruction& instr = (code >> 8) == 0xCB ? cpu.cb_lookup[code & 0xFF] : cpu.lookup[code];
+    (cpu.*instr.exec)();
+    cpu.resolve_flags();
+
+    Machine out = in;
+    uint8_t regs[] = { cpu.bc.h, cpu.bc.l, cpu.de.h, cpu.de.l, cpu.hl.h, cpu.hl.l };
+    memcpy(out.r, regs, sizeof(regs));
+    out.sp = cpu.sp;
+    out.pc = cpu.pc;
+    out.r[7] = cpu.af.h;
+    out.f = cpu.af.l;
+    out.r[6] = memory[OPERAND];
+    memcpy(out.imm, memory + CODE, 2);
+    memcpy(out.stack, memory + STACK - 2, 4);
+
+    return out;
+}
+
+static uint8_t flags(bool z, bool n, bool h, bool c)
+{
+    return TU8(z << Z | n << N | h << H | c << C);
+}
+
+// ADD ADC SUB SBC AND XOR OR CP
+static void alu(Machine& m, int op, uint8_t value, bool carry)
+{
+    uint8_t a = m.r[7];
+    int result = 0;
+    bool n = false, h = false, c = false;
+
+    switch (op) {
+    case 0: case 1: {
+        int in = op == 1 ? carry : 0;
+        result = a + value + in;
+        h = (a & 0xF) + (value & 0xF) + in > 0xF;
+        c = result > 0xFF;
+        break;
+    }
+    case 2: case 3: case 7: {
+        int in = op == 3 ? carry : 0;
+        result = a - value - in;
+        n = true;
+        h = (a & 0xF) < (value & 0xF) + in;
+        c = result < 0;
+        break;
+    }
+    case 4: result = a & value; h = true; break;
+    case 5: result = a ^ value; break;
+    case 6: result = a | value; break;
+    }
+
+    m.f = flags(TU8(result) == 0, n, h, c);
+    if (op != 7) m.r[7] = TU8(result);
+}
+
+// RLC RRC RL RR SLA SRA SWAP SRL, the carry out is returned
+static uint8_t shift(int op, uint8_t value, bool carry, bool& out)
+{
+    switch (op) {
+    case 0: out = value >> 7; return TU8(value << 1 | value >> 7);
+    case 1: out = value & 1; return TU8(value >> 1 | value << 7);
+    case 2: out = value >> 7; return TU8(value << 1 | carry);
+    case 3: out = value & 1; return TU8(value >> 1 | carry << 7);
+    case 4: out = value >> 7; return TU8(value << 1);
+    case 5: out = value & 1; return TU8((value >> 1) | (value & 0x80));
+    case 6: out = false; return TU8(value << 4 | value >> 4);
+    default: out = value & 1; return TU8(value >> 1);
+    }
+}
+
+static void push(Machine& m, uint16_t value)
+{
+    m.sp -= 2;
+    m.stack[0] = TU8(value);
+    m.stack[1] = TU8(value >> 8);
+}
+
+// What the opcode does to m, from the flag rules alone
+static Machine model(uint16_t code, Machine m)
+{
+    bool z = (m.f >> Z) & 1, n = (m.f >> N) & 1, h = (m.f >> H) & 1, c = (m.f >> C) & 1;
+    m.pc = CODE;
+
+    if ((code >> 8) == 0xCB) {
+        int op = (code >> 3) & 0x07, bit = op;
+        uint8_t& value = m.r[code & 0x07];
+
+        switch ((code >> 6) & 0x03) {
+        case 0: {
+            bool out;
+            value = shift(op, value, c, out);
+            m.f = flags(value == 0, false, false, out);
+            break;
+        }
+        case 1: m.f = flags(!((value >> bit) & 1), false, true, c); break;
+        case 2: value = TU8(value & ~(1 << bit)); break;
+        case 3: value = TU8(value | (1 << bit)); break;
+        }
+        return m;
+    }
+
+    bool conditions[] = { !z, z, !c, c }; // NZ Z NC C
+    bool taken = conditions[(code >> 3) & 0x03];
+    uint8_t& a = m.r[7];
+    int8_t e = T8(m.imm[0]);
+    uint16_t nn = CPU::combine(m.imm[0], m.imm[1]);
+
+    if (code >= 0x80 && code < 0xC0) {
+        alu(m, (code >> 3) & 0x07, m.r[code & 0x07], c);
+    }
+    else if (code >= 0xC0 && (code & 0x07) == 0x06) {
+        alu(m, (code >> 3) & 0x07, m.imm[0], c);
+        m.pc++;
+    }
+    else if (code < 0x40 && (code & 0x07) == 0x04) {
+        uint8_t& value = m.r[code >> 3];
+        m.f = flags(TU8(value + 1) == 0, false, (value & 0xF) == 0xF, c);
+        value++;
+    }
+    else if (code < 0x40 && (code & 0x07) == 0x05) {
+        uint8_t& value = m.r[code >> 3];
+        m.f = flags(TU8(value - 1) == 0, true, (value & 0xF) == 0, c);
+        value--;
+    }
+    else if (code < 0x20 && (code & 0x07) == 0x07) { // RLCA RRCA RLA RRA
+        bool out;
+        a = shift(code >> 3, a, c, out);
+        m.f = flags(false, false, false, out);
+    }
+    else if (code == 0x27) { // DAA
+        int value = a;
+        if (!n) {
+            if (c || value > 0x99) { value += 0x60; c = true; }
+            if (h || (value & 0x0F) > 0x09) value += 0x06;
+        }
+        else {
+            if (c) value -= 0x60;
+            if (h) value -= 0x06;
+        }
+        a = TU8(value);
+        m.f = flags(a == 0, n, false, c);
+    }
+    else if (code == 0x2F) {
+        a = TU8(~a);
+        m.f = flags(z, true, true, c);
+    }
+    else if (code == 0x37 || code == 0x3F) { // SCF CCF
+        m.f = flags(z, false, false, code == 0x37 ? true : !c);
+    }
+    else if (code < 0x40 && (code & 0x0F) == 0x09) { // ADD HL,rr
+        uint16_t hl = m.pair(2), value = m.pair(code >> 4);
+        m.f = flags(z, false, (hl & 0xFFF) + (value & 0xFFF) > 0xFFF, hl + value > 0xFFFF);
+        m.set_pair(2, TU16(hl + value));
+    }
+    else if (code == 0xE8 || code == 0xF8) { // ADD SP,e  LD HL,SP+e
+        uint16_t result = TU16(m.sp + e);
+        m.f = flags(false, false, (m.sp & 0xF) + (m.imm[0] & 0xF) > 0xF, (m.sp & 0xFF) + m.imm[0] > 0xFF);
+        if (code == 0xE8) m.sp = result;
+        else m.set_pair(2, result);
+        m.pc++;
+    }
+    else if (code < 0x40 && (code & 0x07) == 0x00) { // JR cc
+        m.pc = TU16(m.pc + 1 + (taken ? e : 0));
+    }
+    else if ((code & 0x07) == 0x02) { // JP cc
+        m.pc = taken ? nn : TU16(m.pc + 2);
+    }
+    else if ((code & 0x07) == 0x04) { // CALL cc
+        m.pc += 2;
+        if (taken) {
+            push(m, m.pc);
+            m.pc = nn;
+        }
+    }
+    else if ((code & 0x07) == 0x00) { // RET cc
+        if (taken) {
+            m.pc = CPU::combine(m.stack[2], m.stack[3]);
+            m.sp += 2;
+        }
+    }
+    else if (code == 0xF5) {
+        push(m, CPU::combine(m.f, a));
+    }
+    else if (code == 0xF1) {
+        m.f = m.stack[2] & 0xF0;
+        a = m.stack[3];
+        m.sp += 2;
+    }
+
+    return m;
+}
+
+int main()
+{
+    auto gb = std::make_unique<GameBoy>();
+    gb->mmu.memory[BOOTING] = 1;
+    gb->mmu.map_pages();
+
+    int failures = 0;
+    long checked = 0;
+
+    auto check = [&](uint16_t code, const Machine& in) {
+        Machine expected = model(code, in);
+        Machine lazy = run(*gb, code, in, true);
+        Machine eager = run(*gb, code, in, false);
+        checked++;
+
+        if (lazy == expected && eager == expected) return;
+        if (failures++ < 20) {
+            const Machine& wrong = lazy == expected ? eager : lazy;
+            printf("%04X a=%02X value=%02X f=%02X sp=%04X imm=%02X: %s gives a=%02X value=%02X f=%02X hl=%04X sp=%04X pc=%04X,"
+                " model a=%02X value=%02X f=%02X hl=%04X sp=%04X pc=%04X\n", code, in.r[7], in.r[6], in.f, in.sp, in.imm[0],
+                &wrong == &lazy ? "pending" : "materialised", wrong.r[7], wrong.r[6], wrong.f, wrong.pair(2), wrong.sp, wrong.pc,
+                expected.r[7], expected.r[6], expected.f, expected.pair(2), expected.sp, expected.pc);
+        }
+    };
+
+    // 16-bit operands for ADD HL,rr and SP: the carry edges and a spread of others
+    uint16_t words[64] = { 0x0000, 0x0001, 0x000F, 0x0010, 0x00FF, 0x0100, 0x0FFF, 0x1000, 0x7FFF, 0x8000, 0xFFFF, 0xFFF0, 0xF000, 0x0F0F, 0xF0F0, 0xFF00 };
+    uint32_t seed = 0x3F1A;
+    for (int i = 16; i < 64; i++) {
+        seed = seed * 1664525 + 1013904223;
+        words[i] = TU16(seed >> 12);
+    }
+
+    for (int f16 = 0; f16 < 16; f16++) {
+        uint8_t f = TU8(f16 << 4);
+
+        // ADD..CP A,r / A,(HL) / A,n over every A and operand
+        for (int code = 0x80; code < 0x100; code++) {
+            bool immediate = code >= 0xC0;
+            if (immediate && (code & 0x07) != 0x06) continue;
+
+            for (int a = 0; a < 256; a++) {
+                for (int value = 0; value < 256; value++) {
+                    if (!immediate && (code & 0x07) == 7 && value != a) continue; // A,A
+
+                    Machine in = setup(TU8(a), TU8(value), f);
+                    if (immediate) in.imm[0] = TU8(value);
+                    else if ((code & 0x07) != 6) in.r[code & 0x07] = TU8(value);
+                    check(TU16(code), in);
+                }
+            }
+        }
+
+        for (int value = 0; value < 256; value++) {
+            // INC r and DEC r
+            for (int r = 0; r < 8; r++) {
+                Machine in = setup(0x3C, 0x3C, f);
+                in.r[r] = TU8(value);
+                check(TU16(r << 3 | 0x04), in);
+                check(TU16(r << 3 | 0x05), in);
+            }
+
+            // RLCA RRCA RLA RRA DAA CPL SCF CCF
+            for (int code = 0x07; code < 0x40; code += 0x08)
+                check(TU16(code), setup(TU8(value), 0x3C, f));
+
+            // Every CB opcode
+            for (int code = 0; code < 256; code++) {
+                Machine in = setup(0x3C, 0x3C, f);
+                in.r[code & 0x07] = TU8(value);
+                check(CPU::combine(TU8(code), 0xCB), in);
+            }
+
+            // PUSH AF materialises F, POP AF replaces what is pending
+            check(0xF5, setup(TU8(value), 0x3C, f));
+            Machine in = setup(0x3C, 0x3C, f);
+            in.stack[2] = TU8(value);
+            in.stack[3] = TU8(~value);
+            check(0xF1, in);
+
+            // Conditional JR JP CALL RET read Z and C
+            for (int cc = 0; cc < 4; cc++) {
+                Machine jump = setup(0x3C, 0x3C, f);
+                jump.imm[0] = TU8(value);
+                for (int code : { 0x20, 0xC2, 0xC4, 0xC0 })
+                    check(TU16(code | cc << 3), jump);
+            }
+        }
+
+        // ADD HL,rr over pairs of words, ADD SP,e and LD HL,SP+e over every e
+        for (uint16_t first : words) {
+            for (uint16_t second : words) {
+                for (int rr = 0; rr < 4; rr++) {
+                    Machine in = setup(0x3C, 0x3C, f);
+                    in.set_pair(2, first);
+                    if (rr != 2) in.set_pair(rr, second);
+                    if (rr == 3) in.sp = second;
+                    check(TU16(rr << 4 | 0x09), in);
+                }
+            }
+
+            for (int e = 0; e < 256; e++) {
+                Machine in = setup(0x3C, 0x3C, f);
+                in.sp = first;
+                in.imm[0] = TU8(e);
+                check(0xE8, in);
+                check(0xF8, in);
+            }
+        }
+    }
+
+    printf("%ld cases, %d mismatches\n", checked, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,116 @@
+// Runs a rom without a display and reports the emulation speed
+// usage: headless [-d mode] [-s interval] [-r megabytes] [-a frames] [-m movie] [-t] [-f] bios.gb rom.gb frames [out.ppm]
+//   -d  0 interpreter, 1 dynarec, 2 dynarec (differential)
+//   -s  draw every Nth frame, 0 only draws the last one
+//   -r  capture rewind snapshots into a ring of this size
+//   -a  run ahead this many frames
+//   -m  play an input movie from its starting state, frames 0 plays all of it, then prints a hash of the final state
+//   -t  draw on the render thread
+//   -f  pixel FIFO backend
+//   out.ppm receives the last frame
+#include <gameboy.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+static bool write_ppm(const char* path, const std::vector<uint32_t>& pixels)
+{
+    FILE* out = fopen(path, "wb");
+    if (!out) return false;
+
+    fprintf(out, "P6\n%d %d\n255\n", SCREEN_WIDTH, SCREEN_HEIGHT);
+    for (uint32_t pixel : pixels) {
+        uint8_t rgb[3] = { TU8(pixel), TU8(pixel >> 8), TU8(pixel >> 16) };
+        fwrite(rgb, 1, 3, out);
+    }
+
+    fclose(out);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    int mode = 0, interval = 1, rewind = 0, ahead = 0;
+    bool threaded = false, fifo = false;
+    const char* movie = nullptr;
+
+    for (;;) {
+        if (argc > 2 && argv[1][0] == '-' && argv[1][1] && strchr("dsra", argv[1][1]) && !argv[1][2]) {
+            int& value = argv[1][1] == 'd' ? mode : argv[1][1] == 's' ? interval : argv[1][1] == 'r' ? rewind : ahead;
+            value = atoi(argv[2]);
+            argc -= 2; argv += 2;
+        }
+        else if (argc > 2 && strcmp(argv[1], "-m") == 0) {
+            movie = argv[2];
+            argc -= 2; argv += 2;
+        }
+        else if (argc > 1 && (strcmp(argv[1], "-t") == 0 || strcmp(argv[1], "-f") == 0)) {
+            (argv[1][1] == 't' ? threaded : fifo) = true;
+            argc--; argv++;
+        }
+        else break;
+    }
+
+    if (argc < 4) {
+        fprintf(stderr, "usage: headless [-d mode] [-s interval] [-r megabytes] [-a frames] [-m movie] [-t] [-f] bios.gb rom.gb frames [out.ppm]\n");
+        return 1;
+    }
+
+    auto gb = std::make_unique<GameBoy>();
+    gb->on_log = [](const char* message) { fputs(message, stderr); };
+
+    if (!gb->boot(argv[1])) return 1;
+    gb->load_rom(argv[2]);
+
+    if (mode && gb->cpu.dynarec.supported())
+        gb->cpu.dynarec.set_mode((DynarecMode)mode);
+
+    int frames = atoi(argv[3]);
+
+    if (movie) {
+        if (!gb->movie.load(movie) || !gb->movie.play(*gb)) {
+            fprintf(stderr, "headless: %s is not a movie of this rom\n", movie);
+            return 1;
+        }
+
+        if (!frames) frames = int(gb->movie.inputs.size());
+    }
+
+    gb->render_interval = interval;
+    gb->ppu.set_backend(fifo ? PPUBackend::Fifo : PPUBackend::Scanline);
+    gb->ppu.set_threaded(threaded);
+    gb->rewind.budget = size_t(rewind) << 20;
+    gb->run_ahead = ahead;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++) {
+        gb->render_requested = i == frames - 1; // The written frame is always complete
+        gb->tick();
+    }
+    gb->ppu.render_thread.sync(); // Counts the drawing still queued
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%d frames in %.3f s, %.1f fps\n", frames, seconds, frames / seconds);
+    if (rewind)
+        printf("rewind: %zu frames in %zu KB\n", gb->rewind.frames(), gb->rewind.memory_used() >> 10);
+
+    if (movie) { // Equal for equal runs, so regressions in emulation show up as a different hash
+        auto state = std::make_unique<SaveState>();
+        gb->save_state(*state);
+
+        printf("movie: %zu of %zu frames played, state %016llx\n", gb->movie.position, gb->movie.inputs.size(), (unsigned long long)state_hash(*state));
+    }
+
+    std::vector<uint32_t> pixels(SCREEN_WIDTH * SCREEN_HEIGHT);
+    gb->expand_frame(pixels.data());
+
+    if (argc > 4 && !write_ppm(argv[4], pixels)) {
+        fprintf(stderr, "headless: cannot create %s\n", argv[4]);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,145 @@
+// Save state round trip: runs a generated rom for some frames, saves, runs on, then restores and runs the same
+// frames again, on this instance and on a fresh one. The state hash after every frame and the last frame must
+// come out the same, on the interpreter, on the dynarec and with the render thread drawing
+// usage: savestate_check bios.gb [frames] [after]
+#include <gameboy.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Past the boot rom after about 330 frames: timer interrupts, WRAM code rewritten by itself and by the interrupt,
+// a stream of VRAM writes and scroll changes
+static std::shared_ptr<RomImage> make_rom()
+{
+    static const uint8_t logo[] = {
+        0xCE, 0xED, 0x66, 0x66, 0xCC, 0x0D, 0x00, 0x0B, 0x03, 0x73, 0x00, 0x83, 0x00, 0x0C, 0x00, 0x0D,
+        0x00, 0x08, 0x11, 0x1F, 0x88, 0x89, 0x00, 0x0E, 0xDC, 0xCC, 0x6E, 0xE6, 0xDD, 0xDD, 0xD9, 0x99,
+        0xBB, 0xBB, 0x67, 0x63, 0x6E, 0x0E, 0xEC, 0xCC, 0xDD, 0xDC, 0x99, 0x9F, 0xBB, 0xB9, 0x33, 0x3E,
+    };
+
+    static const uint8_t timer[] = { // Counts timer interrupts at 0xC000 and flips the code at 0xC200 between INC A and DEC A
+        0xF5, 0xFA, 0x00, 0xC0, 0x3C, 0xEA, 0x00, 0xC0, // PUSH AF  LD A,(C000)  INC A  LD (C000),A
+        0xFA, 0x00, 0xC2, 0xEE, 0x01, 0xEA, 0x00, 0xC2, 0xF1, 0xD9, // LD A,(C200)  XOR 1  LD (C200),A  POP AF  RETI
+    };
+
+    static const uint8_t routine[] = { // Copied to 0xC100, rewrites its own ADD operand on every call
+        0xFA, 0x01, 0xC0, 0xC6, 0x07, 0xEA, 0x01, 0xC0, // LD A,(C001)  ADD A,7  LD (C001),A
+        0xE0, 0x43, 0xF0, 0x04, 0xEA, 0x04, 0xC1, 0xC9, // LDH (SCX),A  LDH A,(DIV)  LD (C104),A  RET
+    };
+
+    static const uint8_t program[] = {
+        0x31, 0xFE, 0xFF, 0x21, 0x00, 0xC1, 0x11, 0x00, 0x02, 0x06, sizeof(routine), // LD SP,FFFE  LD HL,C100  LD DE,0200  LD B,n
+        0x1A, 0x22, 0x13, 0x05, 0x20, 0xFA, // copy: LD A,(DE)  LD (HL+),A  INC DE  DEC B  JR NZ,copy
+        0x3E, 0x3C, 0xEA, 0x00, 0xC2, 0x3E, 0xC9, 0xEA, 0x01, 0xC2, // C200: INC A  RET, only changed by interrupts
+        0x3E, 0x05, 0xE0, 0x07, 0x3E, 0x04, 0xE0, 0xFF, 0xFB, // TAC 262 KHz, IE timer, EI
+        0x21, 0x00, 0x80, // LD HL,8000
+        0xCD, 0x00, 0xC1, 0xCD, 0x00, 0xC2, 0x22, // loop: CALL C100  CALL C200  LD (HL+),A
+        0x7C, 0xFE, 0x98, 0x20, 0x03, 0x21, 0x00, 0x80, 0x18, 0xEF, // LD A,H  CP 98  JR NZ,+3  LD HL,8000  JR loop
+    };
+
+    auto image = std::make_shared<RomImage>();
+    image->size = 0x8000;
+
+    uint8_t* rom = image->data;
+    rom[0x50] = 0xC3; rom[0x51] = 0xC0; rom[0x52] = 0x01; // JP 01C0
+    memcpy(rom + 0x1C0, timer, sizeof(timer));
+    rom[0x100] = 0x00; rom[0x101] = 0xC3; rom[0x102] = 0x50; rom[0x103] = 0x01; // NOP  JP 0150
+    memcpy(rom + 0x104, logo, sizeof(logo));
+    memcpy(rom + 0x150, program, sizeof(program));
+    memcpy(rom + 0x200, routine, sizeof(routine));
+
+    return image;
+}
+
+struct Result {
+    std::vector<uint64_t> hashes; // State after every frame
+    std::vector<uint32_t> pixels; // Last frame
+
+    bool operator==(const Result& other) const { return hashes == other.hashes && pixels == other.pixels; }
+};
+
+static Result run(GameBoy& gb, int frames)
+{
+    Result result;
+    auto state = std::make_unique<SaveState>();
+
+    for (int i = 0; i < frames; i++) {
+        gb.tick();
+        gb.save_state(*state);
+        result.hashes.push_back(state_hash(*state));
+    }
+
+    result.pixels.resize(SCREEN_WIDTH * SCREEN_HEIGHT);
+    gb.expand_frame(result.pixels.data());
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: savestate_check bios.gb [frames] [after]\n");
+        return 1;
+    }
+
+    int frames = argc > 2 ? atoi(argv[2]) : 420, after = argc > 3 ? atoi(argv[3]) : 120;
+    auto image = make_rom();
+
+    uint8_t bios[BIOS_SIZE];
+    if (!GameBoy::read_bios(argv[1], bios)) {
+        fprintf(stderr, "savestate_check: cannot read %s\n", argv[1]);
+        return 1;
+    }
+
+    struct Setup {
+        const char* name;
+        DynarecMode mode;
+        bool threaded;
+    };
+
+    int failures = 0;
+    for (const Setup& setup : { Setup{ "interpreter", DynarecMode::Off, false }, Setup{ "dynarec", DynarecMode::On, false },
+        Setup{ "thread", DynarecMode::Off, true } }) {
+        const char* name = setup.name;
+        DynarecMode mode = setup.mode;
+
+        auto start = [&]() {
+            auto gb = std::make_unique<GameBoy>();
+            gb->boot(bios);
+            gb->load_rom(image);
+            gb->cpu.dynarec.set_mode(mode);
+            gb->ppu.set_threaded(setup.threaded);
+            return gb;
+        };
+
+        auto gb = start();
+        if (mode != DynarecMode::Off && gb->cpu.dynarec.mode == DynarecMode::Off) {
+            printf("%-11s not supported here, skipped\n", name);
+            continue;
+        }
+
+        run(*gb, frames);
+        auto state = std::make_unique<SaveState>();
+        gb->save_state(*state);
+
+        Result straight = run(*gb, after);
+
+        bool loaded = gb->load_state(*state);
+        Result restored = run(*gb, after);
+
+        auto fresh = start();
+        loaded = fresh->load_state(*state) && loaded;
+        Result elsewhere = run(*fresh, after);
+
+        bool same = loaded && restored == straight;
+        bool same_fresh = loaded && elsewhere == straight;
+
+        printf("%-11s state %016llx  restored %s  fresh instance %s\n", name, (unsigned long long)straight.hashes.back(),
+            same ? "same" : "DIFFERENT", same_fresh ? "same" : "DIFFERENT");
+
+        if (!same || !same_fresh) failures++;
+    }
+
+    return failures ? 1 : 0;
+}
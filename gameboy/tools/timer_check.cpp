@@ -0,0 +1,133 @@
+// Drives the scheduled timer and a per-tick loop timer through the same random register traffic and compares
+// DIV, TIMA and the timer interrupt request after every step
+// usage: timer_check [steps] [seed]
+#include <gameboy.h>
+#include <cstdio>
+#include <cstdlib>
+
+// The timer as it was before it was scheduled, stepped after every instruction
+class LoopTimer {
+public:
+    uint8_t read(uint16_t address) const { return registers[address - DIV]; }
+
+    void write(uint16_t address, uint8_t data)
+    {
+        if (address == DIV) {
+            registers[0] = 0;
+            div_clock = 0;
+            base_clock = 0;
+        }
+        else {
+            registers[address - DIV] = data;
+        }
+    }
+
+    void update(uint32_t machine_cycles)
+    {
+        t_clock += machine_cycles * 4;
+
+        while (t_clock >= 16) {
+            t_clock -= 16;
+            tick();
+        }
+    }
+
+    bool interrupt = false;
+
+private:
+    void tick()
+    {
+        static constexpr uint32_t freqs[] = { 64, 1, 4, 16 };
+        uint8_t& divider = registers[0];
+        uint8_t& counter = registers[1];
+        uint8_t modulo = registers[2], controller = registers[3];
+
+        base_clock++;
+        if (++div_clock == 16) {
+            divider++;
+            div_clock = 0;
+        }
+
+        if (!(controller & 0x04)) return;
+
+        uint32_t freq = freqs[controller & 0x03];
+        while (base_clock >= freq) {
+            base_clock -= freq;
+
+            if (counter == 0xFF) {
+                counter = modulo;
+                interrupt = true;
+            }
+            else {
+                counter++;
+            }
+        }
+    }
+
+    uint8_t registers[4] = {}; // DIV TIMA TMA TAC
+    uint32_t t_clock = 0, base_clock = 0, div_clock = 0;
+};
+
+int main(int argc, char** argv)
+{
+    long steps = argc > 1 ? atol(argv[1]) : 2000000;
+    uint32_t seed = argc > 2 ? uint32_t(atol(argv[2])) : 0x7113;
+    if (steps <= 0) {
+        fprintf(stderr, "usage: timer_check [steps] [seed]\n");
+        return 1;
+    }
+
+    auto random = [&seed](uint32_t range) {
+        seed = seed * 1664525 + 1013904223;
+        return (seed >> 8) % range;
+    };
+
+    auto gb = std::make_unique<GameBoy>();
+    MMU& mmu = gb->mmu;
+    Scheduler& scheduler = gb->scheduler;
+    LoopTimer reference;
+
+    int failures = 0;
+    for (long step = 0; step < steps && failures < 20; step++) {
+        // Register access during the instruction, then its cycles
+        uint32_t action = random(16);
+        if (action < 2) {
+            uint16_t address = TU16(DIV + random(4));
+            uint8_t data = TU8(random(256));
+            if (address == TAC && random(4)) data |= 0x04; // Mostly running
+
+            mmu.write(address, data);
+            reference.write(address, data);
+        }
+        else if (action < 6) {
+            uint16_t address = random(2) ? DIV : TIMA;
+            uint8_t value = mmu.read(address), expected = reference.read(address);
+
+            if (value != expected && failures++ < 20)
+                printf("step %ld: %s read %02X, loop timer %02X\n", step, address == DIV ? "DIV" : "TIMA", value, expected);
+        }
+
+        uint32_t cycles = random(64) ? 1 + random(6) : 1 + random(5000); // Instructions, now and then a HALT
+        scheduler.advance(cycles);
+        if (scheduler.due()) scheduler.run_due();
+        reference.update(cycles);
+
+        bool requested = mmu.memory[INTERUPT_FLAG] & (1 << TIMER_INTERUPT);
+        if (requested != reference.interrupt && failures++ < 20)
+            printf("step %ld: timer interrupt %d, loop timer %d\n", step, requested, reference.interrupt);
+
+        if (random(4) == 0) { // Taken
+            mmu.memory[INTERUPT_FLAG] &= ~(1 << TIMER_INTERUPT);
+            reference.interrupt = false;
+        }
+    }
+
+    gb->cpu.cpu_timer.sync();
+    for (uint16_t address = DIV; address <= TAC; address++) {
+        if (mmu.memory[address] != reference.read(address) && failures++ < 20)
+            printf("end: %04X is %02X, loop timer %02X\n", address, mmu.memory[address], reference.read(address));
+    }
+
+    printf("%ld steps, %d mismatches\n", steps, failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,66 @@
+// Converts a binary trace written by Tracer into the text trace format
+// usage: trace2txt [-v] trace.bin [out.txt]
+//   -v  also prints SP, the opcode and the full cycle count of every record
+#include <cpu/tracer.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    bool verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+    if (verbose) { argc--; argv++; }
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: trace2txt [-v] trace.bin [out.txt]\n");
+        return 1;
+    }
+
+    FILE* in = fopen(argv[1], "rb");
+    if (!in) {
+        fprintf(stderr, "trace2txt: cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    FILE* out = argc > 2 ? fopen(argv[2], "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "trace2txt: cannot create %s\n", argv[2]);
+        return 1;
+    }
+
+    TraceHeader header, expected;
+    if (fread(&header, sizeof(header), 1, in) != 1 || memcmp(header.magic, expected.magic, 4) || header.version != expected.version) {
+        fprintf(stderr, "trace2txt: %s is not a trace file\n", argv[1]);
+        return 1;
+    }
+
+    std::vector<TraceRecord> records(Tracer::CHUNK);
+    uint64_t cycle = header.cycle;
+
+    while (size_t count = fread(records.data(), sizeof(TraceRecord), records.size(), in)) {
+        for (size_t i = 0; i < count; i++) {
+            const TraceRecord& r = records[i];
+
+            // Rebuild the full clock from the low bits, records are never 0x8000 cycles apart
+            cycle += (r.cycle - cycle) & 0x7FFF;
+
+            if (r.cycle & TRACE_INTERRUPT) {
+                fprintf(out, "Interput!: 0x%04x\n", r.pc);
+                continue;
+            }
+
+            uint8_t f = r.af & 0xFF;
+            fprintf(out, "0x%04x | %d %d %d %d AF: 0x%04x BC: 0x%04x DE: 0x%04x HL: 0x%04x %d",
+                r.pc, (f >> 7) & 1, (f >> 6) & 1, (f >> 5) & 1, (f >> 4) & 1, r.af, r.bc, r.de, r.hl, r.ly);
+
+            if (verbose)
+                fprintf(out, " SP: 0x%04x OP: 0x%02x CY: %llu", r.sp, r.opcode, (unsigned long long)cycle);
+
+            fputc('\n', out);
+        }
+    }
+
+    fclose(in);
+    if (out != stdout) fclose(out);
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include "bitplane.h"
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define BITPLANE_X64 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define BITPLANE_X64 0
+#endif
+
+// Spreads the bits of a plane into one byte each, leftmost pixel (bit 7) in the lowest byte unless flipped
+static inline uint64_t spread(uint8_t plane, bool flip)
+{
+	uint64_t select = flip ? 0x8040201008040201ull : 0x0102040810204080ull;
+	uint64_t bits = (plane * 0x0101010101010101ull) & select;
+
+	return ((bits + 0x7F7F7F7F7F7F7F7Full) >> 7) & 0x0101010101010101ull;
+}
+
+void decode_tile_scalar(const uint8_t* planes, uint8_t* out, bool flip)
+{
+	for (int y = 0; y < 8; y++) {
+		uint64_t row = spread(planes[y * 2], flip) | (spread(planes[y * 2 + 1], flip) << 1);
+		memcpy(out + y * 8, &row, 8); // Byte order matches on little endian hosts
+	}
+}
+
+#if BITPLANE_X64
+
+// Bit of every output byte, in pixel order
+static inline __m128i pixel_bits(bool flip)
+{
+	return flip ? _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128)
+	            : _mm_setr_epi8(-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1);
+}
+
+void decode_tile_sse2(const uint8_t* planes, uint8_t* out, bool flip)
+{
+	const __m128i bits = pixel_bits(flip), one = _mm_set1_epi8(1), two = _mm_set1_epi8(2);
+	const __m128i low_byte = _mm_set1_epi16(0xFF);
+
+	// Separate the planes, then repeat every byte 8 times so each lane tests one pixel
+	__m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planes));
+	__m128i lohi = _mm_packus_epi16(_mm_and_si128(data, low_byte), _mm_srli_epi16(data, 8));
+
+	__m128i lo2 = _mm_unpacklo_epi8(lohi, lohi), hi2 = _mm_unpackhi_epi8(lohi, lohi);
+	__m128i lo4[2] = { _mm_unpacklo_epi16(lo2, lo2), _mm_unpackhi_epi16(lo2, lo2) };
+	__m128i hi4[2] = { _mm_unpacklo_epi16(hi2, hi2), _mm_unpackhi_epi16(hi2, hi2) };
+
+	for (int i = 0; i < 4; i++) { // Two rows per vector
+		__m128i lo = (i & 1) ? _mm_unpackhi_epi32(lo4[i >> 1], lo4[i >> 1]) : _mm_unpacklo_epi32(lo4[i >> 1], lo4[i >> 1]);
+		__m128i hi = (i & 1) ? _mm_unpackhi_epi32(hi4[i >> 1], hi4[i >> 1]) : _mm_unpacklo_epi32(hi4[i >> 1], hi4[i >> 1]);
+
+		__m128i lo_set = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(lo, bits), bits), one);
+		__m128i hi_set = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(hi, bits), bits), two);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 16), _mm_or_si128(lo_set, hi_set));
+	}
+}
+
+TARGET_AVX2 void decode_tile_avx2(const uint8_t* planes, uint8_t* out, bool flip)
+{
+	const __m256i bits = _mm256_broadcastsi128_si256(pixel_bits(flip));
+	const __m256i one = _mm256_set1_epi8(1), two = _mm256_set1_epi8(2);
+
+	// Four rows per vector, the shuffle repeats each row's plane byte across its 8 pixels
+	const __m256i lo_rows[2] = {
+		_mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 2, 2, 2, 2, 2, 2, 4, 4, 4, 4, 4, 4, 4, 4, 6, 6, 6, 6, 6, 6, 6, 6),
+		_mm256_setr_epi8(8, 8, 8, 8, 8, 8, 8, 8, 10, 10, 10, 10, 10, 10, 10, 10, 12, 12, 12, 12, 12, 12, 12, 12, 14, 14, 14, 14, 14, 14, 14, 14)
+	};
+
+	__m256i data = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(planes)));
+
+	for (int i = 0; i < 2; i++) {
+		__m256i lo = _mm256_shuffle_epi8(data, lo_rows[i]);
+		__m256i hi = _mm256_shuffle_epi8(data, _mm256_add_epi8(lo_rows[i], one));
+
+		__m256i lo_set = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(lo, bits), bits), one);
+		__m256i hi_set = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(hi, bits), bits), two);
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 32), _mm256_or_si256(lo_set, hi_set));
+	}
+}
+
+bool has_sse2()
+{
+	return true; // Part of x86-64
+}
+
+bool has_avx2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) return false;
+
+	__cpuid(info, 1);
+	bool osxsave = info[2] & (1 << 27);
+	if (!osxsave || (_xgetbv(0) & 6) != 6) return false; // The OS must save the YMM registers
+
+	__cpuidex(info, 7, 0);
+	return info[1] & (1 << 5);
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#else
+
+void decode_tile_sse2(const uint8_t* planes, uint8_t* out, bool flip) { decode_tile_scalar(planes, out, flip); }
+void decode_tile_avx2(const uint8_t* planes, uint8_t* out, bool flip) { decode_tile_scalar(planes, out, flip); }
+
+bool has_sse2() { return false; }
+bool has_avx2() { return false; }
+
+#endif
+
+static TileDecoder select_decoder(const char** name)
+{
+	if (has_avx2()) { *name = "avx2"; return decode_tile_avx2; }
+	if (has_sse2()) { *name = "sse2"; return decode_tile_sse2; }
+
+	*name = "scalar";
+	return decode_tile_scalar;
+}
+
+static const char* selected_name = nullptr;
+const TileDecoder decode_tile = select_decoder(&selected_name);
+const char* const decode_tile_name = selected_name;
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+
+// Expands the 16 bytes of a tile (low then high plane per row) into 8x8 colour indices, flip mirrors every row
+using TileDecoder = void (*)(const uint8_t* planes, uint8_t* out, bool flip);
+
+void decode_tile_scalar(const uint8_t* planes, uint8_t* out, bool flip);
+void decode_tile_sse2(const uint8_t* planes, uint8_t* out, bool flip);
+void decode_tile_avx2(const uint8_t* planes, uint8_t* out, bool flip);
+
+bool has_sse2();
+bool has_avx2();
+
+extern const TileDecoder decode_tile; // Fastest decoder the host supports, picked at startup
+extern const char* const decode_tile_name;
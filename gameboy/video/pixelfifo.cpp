@@ -0,0 +1,263 @@
+#include "pixelfifo.h"
+#include <video/ppu.h>
+#include <cpu/mmu.h>
+#include <algorithm>
+
+#define SPRITE_FETCH_DOTS 6
+
+void PixelFifo::init(const uint8_t* _memory, uint8_t* _frame)
+{
+	memory = _memory;
+	frame = _frame;
+}
+
+void PixelFifo::start_line()
+{
+	uint8_t ly = memory[LY];
+
+	if (ly == 0) {
+		window_y = false;
+		window_line = 0;
+	}
+	else if (window_drawn) {
+		window_line++;
+	}
+
+	dot = 0;
+	x = 0;
+	end_dot = LINE_DOTS;
+	transfer = false;
+	window = false;
+	window_drawn = false;
+}
+
+void PixelFifo::advance(int target)
+{
+	target = std::min(target, LINE_DOTS);
+
+	while (dot < target) {
+		if (dot < OAM_DOTS) {
+			dot = std::min(target, OAM_DOTS);
+			continue;
+		}
+
+		if (!transfer) begin_transfer();
+
+		if (x == SCREEN_WIDTH) {
+			dot = target;
+			break;
+		}
+
+		tick();
+		dot++;
+	}
+}
+
+int PixelFifo::earliest_end() const
+{
+	if (x == SCREEN_WIDTH) return end_dot;
+
+	return std::max(dot, OAM_DOTS) + (SCREEN_WIDTH - x);
+}
+
+void PixelFifo::begin_transfer()
+{
+	uint8_t lcd_control = memory[LCD_CONTROL];
+	uint8_t ly = memory[LY];
+
+	if (ly == memory[WINDOW_Y]) window_y = true;
+
+	sprite_count = select_sprites(memory + SPRITE_ATTR, ly, CPU::get_bit(lcd_control, 2), sprites);
+	next_sprite = 0;
+	sprite_dots = 0;
+	sprite_tile = -1;
+
+	stall = 6; // The first tile fetch of a line is thrown away
+	discard = memory[SCROLL_X] & 7;
+
+	fetch_step = GetTile;
+	fetch_dots = 0;
+	fetch_x = 0;
+
+	bg_count = 0;
+	for (int i = 0; i < 8; i++) obj_color[i] = 0;
+	obj_head = 0;
+
+	transfer = true;
+}
+
+void PixelFifo::tick()
+{
+	if (stall) {
+		stall--;
+		return;
+	}
+
+	// A sprite holds the pipeline for its fetch, plus the rest of the background tile fetch for the first one on a tile
+	if (!sprite_dots && sprite_due()) {
+		if (!bg_count) {
+			fetch();
+			if (!bg_count) return;
+		}
+
+		int position = x + memory[SCROLL_X];
+		sprite_dots = SPRITE_FETCH_DOTS;
+
+		if ((position >> 3) != sprite_tile) {
+			sprite_dots += std::max(0, 5 - (position & 7));
+			sprite_tile = position >> 3;
+		}
+	}
+
+	if (sprite_dots) {
+		if (--sprite_dots == 0)
+			fetch_sprite(sprites[next_sprite++]);
+		return;
+	}
+
+	// The window restarts the fetcher on its own map, what the FIFO held is dropped
+	uint8_t lcd_control = memory[LCD_CONTROL];
+	if (!window && CPU::get_bit(lcd_control, 5) && window_y && !discard && x + 7 >= memory[WINDOW_X]) {
+		window = true;
+		window_drawn = true;
+		window_x = 0;
+
+		bg_count = 0;
+		fetch_step = GetTile;
+		fetch_dots = 0;
+		return;
+	}
+
+	fetch();
+	shift();
+}
+
+void PixelFifo::fetch()
+{
+	if (fetch_step == Push) {
+		if (bg_count) return; // Only an empty FIFO takes a tile
+
+		for (int i = 0; i < 8; i++) {
+			int bit = 7 - i;
+			bg[i] = (((high >> bit) & 1) << 1) | ((low >> bit) & 1);
+		}
+		bg_count = 8;
+
+		if (window) window_x++;
+		else fetch_x++;
+
+		fetch_step = GetTile;
+		return;
+	}
+
+	if (++fetch_dots < 2) return; // Every other step takes two dots
+	fetch_dots = 0;
+
+	uint8_t lcd_control = memory[LCD_CONTROL];
+
+	if (fetch_step == GetTile) {
+		uint16_t tile_map;
+		uint8_t column, y;
+
+		if (window) {
+			tile_map = CPU::get_bit(lcd_control, 6) ? 0x9C00 : 0x9800;
+			column = window_x & 31;
+			y = window_line;
+		}
+		else {
+			tile_map = CPU::get_bit(lcd_control, 3) ? 0x9C00 : 0x9800;
+			column = ((memory[SCROLL_X] >> 3) + fetch_x) & 31;
+			y = memory[LY] + memory[SCROLL_Y];
+		}
+
+		tile = memory[tile_map + (y >> 3) * 32 + column];
+		fine_y = y & 7;
+		fetch_step = GetLow;
+		return;
+	}
+
+	// 0x8800 addressing is signed around 0x9000
+	uint16_t address = CPU::get_bit(lcd_control, 4) ? 0x8000 + tile * 16 : 0x9000 + T8(tile) * 16;
+	address += fine_y * 2;
+
+	if (fetch_step == GetLow) {
+		low = memory[address];
+		fetch_step = GetHigh;
+	}
+	else {
+		high = memory[address + 1];
+		fetch_step = Push;
+	}
+}
+
+void PixelFifo::shift()
+{
+	if (!bg_count) return;
+
+	uint8_t color = bg[8 - bg_count--];
+
+	if (discard) {
+		discard--;
+		return;
+	}
+
+	uint8_t sprite_color = obj_color[obj_head], sprite_attr = obj_attr[obj_head];
+	obj_color[obj_head] = 0;
+	obj_head = (obj_head + 1) & 7;
+
+	// Palettes are applied on the way out, so palette writes take effect at this pixel
+	uint8_t lcd_control = memory[LCD_CONTROL];
+	if (!CPU::get_bit(lcd_control, 0)) color = 0;
+
+	uint8_t shade = Renderer::get_shade(color, memory[BG_PALETTE_DATA]);
+
+	bool behind = CPU::get_bit(sprite_attr, 7) && color; // Background colours 1-3 cover the sprite
+	if (sprite_color && CPU::get_bit(lcd_control, 1) && !behind)
+		shade = Renderer::get_shade(sprite_color, memory[CPU::get_bit(sprite_attr, 4) ? SPRITE_PALETTE1 : SPRITE_PALETTE0]);
+
+	if (render) frame[memory[LY] * SCREEN_WIDTH + x] = shade;
+
+	if (++x == SCREEN_WIDTH)
+		end_dot = dot + 1;
+}
+
+bool PixelFifo::sprite_due() const
+{
+	uint8_t lcd_control = memory[LCD_CONTROL];
+	if (!CPU::get_bit(lcd_control, 1) || next_sprite == sprite_count) return false;
+
+	return memory[SPRITE_ATTR + sprites[next_sprite] * 4 + 1] <= x + 8;
+}
+
+void PixelFifo::fetch_sprite(uint8_t sprite)
+{
+	const uint8_t* entry = memory + SPRITE_ATTR + sprite * 4;
+	uint8_t lcd_control = memory[LCD_CONTROL];
+	bool tall = CPU::get_bit(lcd_control, 2);
+
+	int y = memory[LY] - (entry[0] - 16);
+	uint8_t tile_num = tall ? entry[2] & 0xFE : entry[2];
+	uint8_t attr = entry[3];
+
+	if (CPU::get_bit(attr, 6))
+		y = (tall ? 15 : 7) - y;
+
+	uint16_t address = 0x8000 + tile_num * 16 + y * 2;
+	uint8_t lo = memory[address], hi = memory[address + 1];
+	bool x_flip = CPU::get_bit(attr, 5);
+
+	// Sprites partly off the left edge start part way in
+	int skip = x - (entry[1] - 8);
+
+	for (int i = std::max(skip, 0); i < 8; i++) {
+		int bit = x_flip ? i : 7 - i;
+		uint8_t color = (((hi >> bit) & 1) << 1) | ((lo >> bit) & 1);
+
+		// Earlier sprites keep their pixels, they won on X or OAM order
+		int slot = (obj_head + i - skip) & 7;
+		if (color && !obj_color[slot]) {
+			obj_color[slot] = color;
+			obj_attr[slot] = attr;
+		}
+	}
+}
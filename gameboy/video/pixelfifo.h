@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <video/renderer.h>
+
+#define LINE_DOTS 456
+#define OAM_DOTS 80
+
+// Background fetcher and pixel FIFOs for one scanline, run dot by dot up to wherever the PPU has got to.
+// Registers, VRAM and OAM are read live, so writes made during mode 3 show up mid-line.
+class PixelFifo {
+public:
+	void init(const uint8_t* _memory, uint8_t* _frame);
+
+	void start_line();
+	void advance(int target); // Runs the line up to this dot
+
+	bool done_by(int at) const { return x == SCREEN_WIDTH && at >= end_dot; } // Mode 3 over at this dot
+	int earliest_end() const; // No sooner than this dot, one pixel per dot at best
+
+public:
+	bool render = true; // Pixels are only written while set, the timing is the same
+
+private:
+	enum FetchStep { GetTile, GetLow, GetHigh, Push };
+
+	void begin_transfer(); // Start of mode 3
+	void tick(); // One dot of mode 3
+
+	void fetch();
+	void shift();
+
+	bool sprite_due() const;
+	void fetch_sprite(uint8_t sprite);
+
+private:
+	const uint8_t* memory = nullptr; // The 64K address space
+	uint8_t* frame = nullptr;
+
+	int dot = 0;
+	int x = 0; // Pixels out so far
+	int end_dot = LINE_DOTS;
+	bool transfer = false;
+
+	int stall = 0; // Dots the pipeline does nothing for
+	int discard = 0; // SCX fine scroll, dropped from the first tile
+
+	FetchStep fetch_step = GetTile;
+	int fetch_dots = 0;
+	uint8_t fetch_x = 0; // Tile column
+	uint8_t tile = 0, fine_y = 0, low = 0, high = 0;
+
+	uint8_t bg[8] = {}; // Colour indices, the next pixel at 8 - bg_count
+	int bg_count = 0;
+
+	// Sprite pixels for the next 8 positions, obj_head is the next one, colour 0 is empty
+	uint8_t obj_color[8] = {}, obj_attr[8] = {};
+	int obj_head = 0;
+
+	uint8_t sprites[MAX_LINE_SPRITES] = {};
+	int sprite_count = 0, next_sprite = 0;
+	int sprite_dots = 0;
+	int sprite_tile = -1; // Background tile the last sprite fetch waited on
+
+	bool window = false;
+	bool window_drawn = false; // On this line, moves the window line on
+	bool window_y = false; // WY matched LY earlier in the frame
+	uint8_t window_line = 0, window_x = 0;
+};
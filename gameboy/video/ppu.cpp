@@ -1,284 +1,317 @@
 #include "ppu.h"
 #include <gameboy.h>
-#include <video/window.h>
 #include <cpu/mmu.h>
-#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PPU_SSE2 1
+#else
+#define PPU_SSE2 0
+#endif
+
+#if PPU_SSE2
+// One colour channel for 16 pixels, lut holds shade 0, 0 ^ 1, shade 2 and 2 ^ 3
+static inline __m128i select_channel(__m128i bit0, __m128i bit1, const __m128i lut[4])
+{
+	__m128i low = _mm_xor_si128(lut[0], _mm_and_si128(bit0, lut[1]));
+	__m128i high = _mm_xor_si128(lut[2], _mm_and_si128(bit0, lut[3]));
+
+	return _mm_xor_si128(low, _mm_and_si128(bit1, _mm_xor_si128(low, high)));
+}
+#endif
 
 void PPU::init(MMU* _mmu)
 {
 	mmu = _mmu;
 
-	pixels.create(256, 256, sf::Color::White);
-	frame_buffer.loadFromImage(pixels);
+	// Let the PPU see the new value after the writing instruction, LY keeps what was written
+	auto write = [this](uint16_t address, uint8_t data) {
+		catch_up();
+		mmu->memory[address] = data;
+		mmu->gb->scheduler.schedule_next(Event::PPU);
+	};
+
+	mmu->register_io(LCD_CONTROL, nullptr, write);
+	mmu->register_io(LCD_STATUS, nullptr, write);
+	mmu->register_io(LY, nullptr, write);
+	mmu->register_io(LYC, nullptr, write);
+
+	// Registers the FIFO reads mid-line
+	auto write_drawn = [this](uint16_t address, uint8_t data) {
+		catch_up();
+		mmu->memory[address] = data;
+	};
+
+	for (uint16_t address : { SCROLL_Y, SCROLL_X, BG_PALETTE_DATA, SPRITE_PALETTE0, SPRITE_PALETTE1, WINDOW_Y, WINDOW_X })
+		mmu->register_io(address, nullptr, write_drawn);
+
+	renderer.init(mmu->memory + VRAM, mmu->memory + SPRITE_ATTR);
+
+	// Zero padding too, save states copy it byte for byte and are hashed that way
+	memset(static_cast<void*>(&fifo), 0, sizeof(fifo));
+	new (&fifo) PixelFifo();
+	fifo.init(mmu->memory, frame);
 }
 
-void PPU::tick(uint32_t cycles)
+// Same result as evaluating the PPU after every instruction, but only runs where that could change anything
+void PPU::step()
 {
-	uint8_t status = mmu->read(LCD_STATUS);
-	
+	Scheduler& scheduler = mmu->gb->scheduler;
+	uint8_t status = mmu->memory[LCD_STATUS];
+
 	if (!lcd_enabled()) {
-		scanline_counter = 114;
-		mmu->write(LY, 0);
-		
+		line_start = scheduler.now;
+		lcd_on = false;
+
+		mmu->memory[LY] = 0;
+
 		status &= 252;
 		CPU::set_bit(status, 0, 1);
-		
-		mmu->write(LCD_STATUS, status);
-		return;
+
+		mmu->memory[LCD_STATUS] = status;
+		return; // Nothing changes until LCDC is written
+	}
+
+	if (!lcd_on) { // The line starts with the instruction that switched the LCD on
+		line_start = scheduler.previous;
+		lcd_on = true;
+
+		if (backend == PPUBackend::Fifo) start_fifo_line();
 	}
 
-	uint8_t scanline = mmu->read(LY);
+	catch_up();
+
+	// The mode follows the line position before the last instruction
+	uint8_t scanline = mmu->memory[LY];
 	LCDMode currentmode = (LCDMode)(status & 0x3);
 
-	LCDMode mode = HBlank;
+	mode = mode_at(scanline, scheduler.previous - line_start);
 	bool should_interupt = false;
 
-	if (scanline >= 144) {
-		mode = VBlank;
+	if (mode == VBlank) {
 		CPU::set_bit(status, 0, 1);
 		CPU::set_bit(status, 1, 0);
 		should_interupt = CPU::get_bit(status, 4);
 	}
+	else if (mode == OAMSearch) {
+		CPU::set_bit(status, 1, 1);
+		CPU::set_bit(status, 0, 0);
+		should_interupt = CPU::get_bit(status, 5);
+	}
+	else if (mode == DataTrans) {
+		CPU::set_bit(status, 1, 1);
+		CPU::set_bit(status, 0, 1);
+	}
 	else {
-		if (scanline_counter >= 94) {
-			mode = OAMSearch;
-			CPU::set_bit(status, 1, 1);
-			CPU::set_bit(status, 0, 0);
-			should_interupt = CPU::get_bit(status, 5);
-		}
-		else if (scanline_counter >= 51) {
-			mode = DataTrans;
-			CPU::set_bit(status, 1, 1);
-			CPU::set_bit(status, 0, 1);
-		}
-		else {
-			mode = HBlank;
-			CPU::set_bit(status, 1, 0);
-			CPU::set_bit(status, 0, 0);
-			should_interupt = CPU::get_bit(status, 3);
-		}
+		CPU::set_bit(status, 1, 0);
+		CPU::set_bit(status, 0, 0);
+		should_interupt = CPU::get_bit(status, 3);
 	}
 
 	if (should_interupt && (mode != currentmode))
 		mmu->gb->cpu.interupt(LCD_INTERUPT);
 
-	if (scanline == mmu->read(LYC)) {
+	bool coincidence = scanline == mmu->memory[LYC];
+	if (coincidence) {
 		CPU::set_bit(status, 2, 1);
-		
+
 		if (CPU::get_bit(status, 6))
 			mmu->gb->cpu.interupt(LCD_INTERUPT);
 	}
 	else
 		CPU::set_bit(status, 2, 0);
 
-	mmu->write(0xFF41, status);
-
-	if (lcd_enabled())
-		scanline_counter -= cycles;
-	else
-		return;
+	mmu->memory[LCD_STATUS] = status;
 
-	if (scanline_counter <= 0) {
-		mmu->get(LY)++;
-		uint8_t scanline = mmu->read(LY);
+	if (scheduler.now - line_start >= 114) {
+		mmu->memory[LY]++;
+		uint8_t scanline = mmu->memory[LY];
 
-		scanline_counter = 114;
+		line_start = scheduler.now;
 
-		if (scanline == 144 && lcd_enabled())
+		if (scanline == 144) {
 			mmu->gb->cpu.interupt(VBLANK_INTERUPT);
+			if (render && render_thread.running()) render_thread.frame_done();
+		}
 		else if (scanline > 153)
-			mmu->write(LY, 0);
-		else if (scanline < 144)
+			mmu->memory[LY] = 0;
+		else if (scanline < 144 && render && backend == PPUBackend::Scanline)
 			draw_line();
+
+		if (mmu->memory[LY] < 144 && backend == PPUBackend::Fifo) start_fifo_line();
 	}
-}
 
-bool PPU::lcd_enabled()
-{
-	uint8_t lcd = mmu->read(LCD_CONTROL);
-	return CPU::get_bit(lcd, 7);
+	// The LYC interupt is requested again after every instruction while it holds
+	if (coincidence && CPU::get_bit(status, 6)) {
+		scheduler.schedule_next(Event::PPU);
+		return;
+	}
+
+	// Next boundary where the mode, taken from this one, differs
+	uint64_t elapsed = scheduler.now - line_start;
+	if (mode_at(mmu->memory[LY], elapsed) != mode) {
+		scheduler.schedule_next(Event::PPU);
+		return;
+	}
+
+	scheduler.schedule(Event::PPU, line_start + mode_end(mode));
 }
 
-void PPU::draw_tiles()
+LCDMode PPU::mode_at(uint8_t scanline, uint64_t elapsed)
 {
-	uint8_t view_x = mmu->read(SCROLL_X);
-	uint8_t view_y = mmu->read(SCROLL_Y);
+	if (backend == PPUBackend::Scanline || scanline >= 144)
+		return line_mode(scanline, elapsed);
 
-	uint8_t win_x = mmu->read(WINDOW_X) - 7;
-	uint8_t win_y = mmu->read(WINDOW_Y);
+	if (elapsed * 4 < OAM_DOTS) return OAMSearch;
+	return fifo.done_by(int(elapsed * 4)) ? HBlank : DataTrans;
+}
 
-	uint8_t lcd_control = mmu->read(LCD_CONTROL);
-	uint8_t scanline = mmu->read(LY);
-	
-	bool signed_data = false;
-	bool window = false;
+uint64_t PPU::mode_end(LCDMode mode)
+{
+	if (backend == PPUBackend::Fifo) {
+		if (mode == OAMSearch) return OAM_DOTS / 4;
+		if (mode == DataTrans) return (fifo.earliest_end() + 3) / 4; // Checked again there if the FIFO was held up
+	}
+	else {
+		if (mode == OAMSearch) return 21;
+		if (mode == DataTrans) return 64;
+	}
 
-	bool tiledata_select = CPU::get_bit(lcd_control, 4);
-	uint16_t tile_data = tiledata_select ? 0x8000 : 0x8800;
-	signed_data = !tiledata_select;
+	return 114;
+}
 
-	uint16_t tile_map = 0;
+void PPU::start_fifo_line()
+{
+	fifo.render = render;
+	fifo.start_line();
+}
 
-	uint8_t palette = mmu->read(BG_PALETTE_DATA);
-	uint8_t offx = 0, offy = 0;
+void PPU::catch_up()
+{
+	if (backend != PPUBackend::Fifo || !lcd_on || mmu->memory[LY] >= 144) return;
 
-	for (int x = 0; x < 256; x++) {
-		
-		if (CPU::get_bit(lcd_control, 5)) {
-			if (x >= win_x && scanline >= win_y)
-				window = true;
-		}
-		
-		if (!window) {
-			if (CPU::get_bit(lcd_control, 3))
-				tile_map = 0x9C00;
-			else
-				tile_map = 0x9800;
-		}
-		else {
-			if (CPU::get_bit(lcd_control, 6))
-				tile_map = 0x9C00;
-			else
-				tile_map = 0x9800;
-		}
+	uint64_t elapsed = mmu->gb->scheduler.now - line_start;
+	fifo.advance(int(std::min<uint64_t>(elapsed * 4, LINE_DOTS)));
+}
 
-		if (window) {
-			offx = x - win_x;
-			offy = scanline - win_y;
-		}
-		else {
-			offx = x + view_x;
-			offy = view_y + scanline;
-		}
+void PPU::set_backend(PPUBackend _backend)
+{
+	if (_backend == backend) return;
 
-		uint8_t tilex = offx / 8, tiley = offy / 8;
-		uint8_t tilexc = offx % 8, tileyc = offy % 8;
-		
-		uint16_t offset = (tiley * 32) + tilex;
+	if (_backend == PPUBackend::Fifo) set_threaded(false);
+	backend = _backend;
 
-		uint8_t tilen = mmu->read(tile_map + offset);
-		uint8_t colorval = 0;
-		
-		if (tile_data == 0x8800) {
-			int8_t tile_num = T8(tilen);
-			uint16_t tileaddr = tile_data + 0x800 + (tile_num * 16);
-			uint16_t tile_line = tileaddr + (tileyc * 2);
+	// Picks up at the current line, drawn from the start of it
+	if (backend == PPUBackend::Fifo && lcd_on && mmu->memory[LY] < 144) {
+		start_fifo_line();
+		catch_up();
+	}
 
-			uint8_t byte1 = mmu->read(tile_line);
-			uint8_t byte2 = mmu->read(tile_line + 1);
+	mmu->gb->scheduler.schedule_next(Event::PPU);
+}
 
-			uint8_t bit1 = (byte1 >> (7 - tilexc) & 0x1);
-			uint8_t bit2 = (byte2 >> (7 - tilexc) & 0x1);
+LCDMode PPU::line_mode(uint8_t scanline, uint64_t elapsed)
+{
+	if (scanline >= 144) return VBlank;
+	if (elapsed <= 20) return OAMSearch;
+	if (elapsed <= 63) return DataTrans;
 
-			colorval = (bit2 << 1) | bit1;
-		}
-		else {
-			uint16_t tileaddr = tile_data + (tilen * 16);
-			uint16_t tile_line = tileaddr + (tileyc * 2);
+	return HBlank;
+}
 
-			uint8_t byte1 = mmu->read(tile_line);
-			uint8_t byte2 = mmu->read(tile_line + 1);
+bool PPU::lcd_enabled()
+{
+	uint8_t lcd = mmu->read(LCD_CONTROL);
+	return CPU::get_bit(lcd, 7);
+}
 
-			uint8_t bit1 = (byte1 >> (7 - tilexc)) & 0x1;
-			uint8_t bit2 = (byte2 >> (7 - tilexc)) & 0x1;
-			
-			colorval = (bit2 << 1) | bit1;
-		}
+ScanlineState PPU::scanline_state()
+{
+	uint8_t* memory = mmu->memory;
 
-		sf::Color color = get_color(colorval, palette, Background);
-		pixels.setPixel(x, scanline, color);
-	}
+	return { memory[LY], memory[LCD_CONTROL], memory[SCROLL_X], memory[SCROLL_Y], memory[WINDOW_X], memory[WINDOW_Y],
+		memory[BG_PALETTE_DATA], memory[SPRITE_PALETTE0], memory[SPRITE_PALETTE1] };
 }
 
-void PPU::draw_sprites()
+void PPU::draw_line()
 {
-	uint8_t lcd_control = mmu->read(LCD_CONTROL);
-	uint8_t scanline = mmu->read(LY);
-	uint16_t sprite_data = 0x8000;
-
-	for (int sprite = 0; sprite < 40; sprite++) {
-		uint8_t index = sprite * 4;
-		uint8_t y_pos = mmu->read(SPRITE_ATTR + index) - 16;
-		uint8_t x_pos = mmu->read(SPRITE_ATTR + index + 1) - 8;
-		
-		uint8_t tile_num = mmu->read(SPRITE_ATTR + index + 2);
-		uint8_t attr = mmu->read(SPRITE_ATTR + index + 3);
-
-		uint8_t sprite_height = CPU::get_bit(lcd_control, 2) ? 16 : 8;
-		uint16_t palette_addr = CPU::get_bit(attr, 4) ? SPRITE_PALETTE1 : SPRITE_PALETTE0;
-		uint8_t palette = mmu->read(palette_addr);
-
-		bool x_flip = CPU::get_bit(attr, 5);
-		bool y_flip = CPU::get_bit(attr, 6);
-
-		if (scanline >= y_pos && scanline < (y_pos + sprite_height)) {
-			int line = scanline - y_pos;
-
-			if (y_flip) {
-				line -= sprite_height;
-				line *= -1;
-			}
-
-			line *= 2;
-			uint16_t tile_addr = (0x8000 + (tile_num * 16)) + line;
-			
-			uint8_t byte1 = mmu->read(tile_addr);
-			uint8_t byte2 = mmu->read(tile_addr + 1);
-
-			for (int row_pixel = 7; row_pixel >= 0; row_pixel--) {
-				
-				int colourbit = row_pixel;
-				if (x_flip) {
-					colourbit -= 7;
-					colourbit *= -1;
-				}
-
-				uint8_t bit2 = CPU::get_bit(byte2, colourbit);
-				uint8_t bit1 = CPU::get_bit(byte1, colourbit);
-
-				int colorval = (bit2 << 1) | bit1;
-				sf::Color color = get_color(colorval, palette, Sprite);
-
-				if (colorval == 0)
-					continue;
-
-				int pixel = x_pos + (7 - row_pixel);
-
-				if ((scanline < 0) || (scanline > 143) || (pixel < 0) || (pixel > 159)) {
-					continue;
-				}
-
-				pixels.setPixel(pixel, scanline, color);
-			}
-		}
-	}
+	if (render_thread.running())
+		render_thread.line(scanline_state());
+	else
+		renderer.draw_line(scanline_state(), frame);
 }
 
-void PPU::draw_line()
+void PPU::set_threaded(bool enabled)
 {
-	uint8_t lcd_control = mmu->read(LCD_CONTROL);
+	if (enabled == render_thread.running() || (enabled && backend == PPUBackend::Fifo)) return;
+
+	if (enabled) {
+		render_thread.start(mmu->memory, frame);
+	}
+	else {
+		render_thread.stop();
+		memcpy(frame, render_thread.work_frame(), sizeof(frame));
+		renderer.tile_cache.invalidate(); // Missed the writes made meanwhile
+	}
 
-	if (CPU::get_bit(lcd_control, 0))
-		draw_tiles();
-	if (CPU::get_bit(lcd_control, 1))
-		draw_sprites();
+	mmu->map_pages(); // VRAM and OAM writes have to reach the queue
 }
 
-void PPU::blit_pixels()
+void PPU::set_color_scheme(ColorScheme scheme)
 {
-	frame_buffer.loadFromImage(pixels);
+	static const uint32_t schemes[][4] = {
+		{ RGBA(255, 255, 255), RGBA(192, 192, 192), RGBA(96, 96, 96), RGBA(0, 0, 0) },
+		{ RGBA(155, 188, 15), RGBA(139, 172, 15), RGBA(48, 98, 48), RGBA(15, 56, 15) }, // The original DMG screen
+	};
+
+	if (scheme != ColorScheme::Custom)
+		memcpy(colors, schemes[(int)scheme], sizeof(colors));
+
+	color_scheme = scheme;
 }
 
-sf::Color PPU::get_color(uint8_t value, uint8_t palette, Object obj)
+void PPU::expand(uint32_t* pixels, const uint8_t* shades)
 {
-	uint8_t colorfrompal = (palette >> (2 * value)) & 3;
-	
-	if (colorfrompal == 0)
-		return sf::Color::White;
-	else if (colorfrompal == 1)
-		return sf::Color(192, 192, 192, 255);
-	else if (colorfrompal == 2)
-		return sf::Color(96, 96, 96, 255);
-	else if (colorfrompal == 3)
-		return sf::Color::Black;
+	if (!shades) shades = render_thread.running() ? render_thread.latest() : frame;
+	int i = 0;
+
+#if PPU_SSE2
+	// 16 pixels at a time, every channel picks its byte with the two shade bits as blend masks
+	const __m128i one = _mm_set1_epi8(1), two = _mm_set1_epi8(2);
+	__m128i lut[4][4];
+
+	for (int c = 0; c < 4; c++) {
+		uint8_t channel[4];
+		for (int s = 0; s < 4; s++) channel[s] = TU8(colors[s] >> (c * 8));
+
+		lut[c][0] = _mm_set1_epi8(channel[0]);
+		lut[c][1] = _mm_set1_epi8(channel[0] ^ channel[1]);
+		lut[c][2] = _mm_set1_epi8(channel[2]);
+		lut[c][3] = _mm_set1_epi8(channel[2] ^ channel[3]);
+	}
+
+	for (; i + 16 <= SCREEN_WIDTH * SCREEN_HEIGHT; i += 16) {
+		__m128i shade = _mm_loadu_si128(reinterpret_cast<const __m128i*>(shades + i));
+		__m128i bit0 = _mm_cmpeq_epi8(_mm_and_si128(shade, one), one);
+		__m128i bit1 = _mm_cmpeq_epi8(_mm_and_si128(shade, two), two);
+
+		__m128i r = select_channel(bit0, bit1, lut[0]), g = select_channel(bit0, bit1, lut[1]);
+		__m128i b = select_channel(bit0, bit1, lut[2]), a = select_channel(bit0, bit1, lut[3]);
+
+		__m128i rg_lo = _mm_unpacklo_epi8(r, g), rg_hi = _mm_unpackhi_epi8(r, g);
+		__m128i ba_lo = _mm_unpacklo_epi8(b, a), ba_hi = _mm_unpackhi_epi8(b, a);
+
+		__m128i* out = reinterpret_cast<__m128i*>(pixels + i);
+		_mm_storeu_si128(out + 0, _mm_unpacklo_epi16(rg_lo, ba_lo));
+		_mm_storeu_si128(out + 1, _mm_unpackhi_epi16(rg_lo, ba_lo));
+		_mm_storeu_si128(out + 2, _mm_unpacklo_epi16(rg_hi, ba_hi));
+		_mm_storeu_si128(out + 3, _mm_unpackhi_epi16(rg_hi, ba_hi));
+	}
+#endif
+
+	for (; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++)
+		pixels[i] = colors[shades[i]];
 }
@@ -1,9 +1,10 @@
 #pragma once
-#include <SFML/Graphics.hpp>
 #include <cstdint>
+#include <video/renderer.h>
+#include <video/renderthread.h>
+#include <video/pixelfifo.h>
 #include <string>
 #include <vector>
-#include <fstream>
 
 #define S(x) std::to_string(x)
 
@@ -31,7 +32,20 @@ enum LCDMode {
 #define WINDOW_X 0xFF4B
 #define WINDOW_Y 0xFF4A
 
-#define SPRITE_ATTR 0xFE00
+#define RGBA(r, g, b) (0xFF000000u | ((b) << 16) | ((g) << 8) | (r)) // Bytes in R, G, B, A order
+
+// Scanline draws each line whole from the registers at its start, Fifo runs the pixel pipeline alongside the CPU
+enum class PPUBackend {
+	Scanline,
+	Fifo
+};
+
+// RGBA values expand() gives the four shades, Custom keeps whatever was written to PPU::colors
+enum class ColorScheme {
+	Greyscale,
+	Green,
+	Custom
+};
 
 class MMU;
 class PPU {
@@ -41,25 +55,41 @@ public:
 
 	void init(MMU* mmu);
 
-	void tick(uint32_t cycles);
+	void step(); // Scheduled through Event::PPU
 	bool lcd_enabled();
 
-	void draw_tiles();
-	void draw_sprites();
+	static LCDMode line_mode(uint8_t scanline, uint64_t elapsed);
+	LCDMode mode_at(uint8_t scanline, uint64_t elapsed); // line_mode, with mode 3 as long as the FIFO took
+	uint64_t mode_end(LCDMode mode); // Earliest line position the mode can change at
 
+	void set_backend(PPUBackend backend);
+	void start_fifo_line();
+	void catch_up(); // FIFO pixels up to now, before a register it reads changes
+
+	ScanlineState scanline_state();
 	void draw_line();
-	void blit_pixels();
 
-	sf::Color get_color(uint8_t value, uint8_t palette, Object obj);
+	void set_threaded(bool enabled); // Moves drawing to render_thread, the frame then follows with up to a frame of latency. Scanline backend only
+
+	void expand(uint32_t* pixels, const uint8_t* shades = nullptr); // RGBA copy of the frame for frontends, or of these shades
+	void set_color_scheme(ColorScheme scheme);
 
 public:
 	MMU* mmu;
 
 public:
-	int scanline_counter = 0;
-	LCDMode mode;
+	uint64_t line_start = 0; // Scheduler time the current line began
+	bool lcd_on = false;
+	LCDMode mode = HBlank;
+	bool render = true; // Lines are only drawn while set
+
+	PPUBackend backend = PPUBackend::Scanline;
+
+	Renderer renderer;
+	RenderThread render_thread;
+	PixelFifo fifo;
 
-	sf::Texture frame_buffer;
-	
-	sf::Image pixels;
+	uint8_t frame[SCREEN_WIDTH * SCREEN_HEIGHT] = {}; // Shade index (0-3) per visible pixel
+	uint32_t colors[4] = { RGBA(255, 255, 255), RGBA(192, 192, 192), RGBA(96, 96, 96), RGBA(0, 0, 0) };
+	ColorScheme color_scheme = ColorScheme::Greyscale;
 };
\ No newline at end of file
@@ -0,0 +1,165 @@
+#include "renderer.h"
+#include <cpu/cpu.h>
+
+void Renderer::init(const uint8_t* _vram, const uint8_t* _oam)
+{
+	vram = _vram;
+	oam = _oam;
+
+	tile_cache.init(vram + (TILE_DATA - VRAM));
+}
+
+void Renderer::draw_line(const ScanlineState& state, uint8_t* frame)
+{
+	uint8_t lcd_control = state.lcdc;
+	uint8_t* line = frame + state.ly * SCREEN_WIDTH;
+
+	update_palettes(state);
+
+	if (CPU::get_bit(lcd_control, 0))
+		draw_tiles(state, line);
+	if (CPU::get_bit(lcd_control, 1)) {
+		sprite_count = select_sprites(oam, state.ly, CPU::get_bit(lcd_control, 2), line_sprites);
+		draw_sprites(state, line);
+	}
+}
+
+void Renderer::update_palettes(const ScanlineState& state)
+{
+	uint8_t values[3] = { state.bgp, state.obp0, state.obp1 };
+
+	for (int palette = BGP; palette <= OBP1; palette++) {
+		if (values[palette] == palette_values[palette]) continue;
+
+		palette_values[palette] = values[palette];
+		for (int index = 0; index < 4; index++)
+			shades[palette][index] = get_shade(index, values[palette]);
+	}
+}
+
+void Renderer::draw_tiles(const ScanlineState& state, uint8_t* line)
+{
+	uint8_t view_x = state.scx;
+	uint8_t view_y = state.scy;
+
+	uint8_t win_x = state.wx - 7;
+	uint8_t win_y = state.wy;
+
+	uint8_t lcd_control = state.lcdc;
+	uint8_t scanline = state.ly;
+	
+	bool signed_data = false;
+	bool window = false;
+
+	bool tiledata_select = CPU::get_bit(lcd_control, 4);
+	signed_data = !tiledata_select;
+
+	uint16_t tile_map = 0;
+
+	const uint8_t* palette = shades[BGP];
+	uint8_t offx = 0, offy = 0;
+
+	const uint8_t* row = nullptr;
+	uint32_t current_row = UINT32_MAX;
+
+	for (int x = 0; x < SCREEN_WIDTH; x++) {
+		
+		if (CPU::get_bit(lcd_control, 5)) {
+			if (x >= win_x && scanline >= win_y)
+				window = true;
+		}
+		
+		if (!window) {
+			if (CPU::get_bit(lcd_control, 3))
+				tile_map = 0x9C00;
+			else
+				tile_map = 0x9800;
+		}
+		else {
+			if (CPU::get_bit(lcd_control, 6))
+				tile_map = 0x9C00;
+			else
+				tile_map = 0x9800;
+		}
+
+		if (window) {
+			offx = x - win_x;
+			offy = scanline - win_y;
+		}
+		else {
+			offx = x + view_x;
+			offy = view_y + scanline;
+		}
+
+		uint8_t tilex = offx / 8, tiley = offy / 8;
+		uint8_t tilexc = offx % 8, tileyc = offy % 8;
+		
+		uint16_t offset = (tiley * 32) + tilex;
+
+		// Only a new tile or the switch to the window needs another row
+		uint32_t row_key = ((tile_map + offset) << 3) | tileyc;
+		if (row_key != current_row) {
+			uint8_t tilen = vram[tile_map + offset - VRAM];
+			uint16_t tile = signed_data ? 256 + T8(tilen) : tilen; // 0x8800 addressing is signed around 0x9000
+
+			row = tile_cache.row(tile, tileyc);
+			current_row = row_key;
+		}
+
+		uint8_t colorval = row[tilexc];
+		line[x] = palette[colorval];
+	}
+}
+
+int select_sprites(const uint8_t* oam, uint8_t scanline, bool tall, uint8_t* sprites)
+{
+	int height = tall ? 16 : 8;
+	int count = 0;
+
+	for (uint8_t sprite = 0; sprite < 40 && count < MAX_LINE_SPRITES; sprite++) {
+		int top = oam[sprite * 4] - 16;
+		if (scanline < top || scanline >= top + height)
+			continue;
+
+		// The smaller X wins, OAM order breaks ties
+		int i = count++;
+		for (; i > 0 && oam[sprites[i - 1] * 4 + 1] > oam[sprite * 4 + 1]; i--)
+			sprites[i] = sprites[i - 1];
+
+		sprites[i] = sprite;
+	}
+
+	return count;
+}
+
+void Renderer::draw_sprites(const ScanlineState& state, uint8_t* line)
+{
+	uint8_t lcd_control = state.lcdc;
+	uint8_t scanline = state.ly;
+	bool tall = CPU::get_bit(lcd_control, 2);
+
+	// Back to front, so pixels of the winning sprite are written last
+	for (int i = sprite_count - 1; i >= 0; i--) {
+		const uint8_t* sprite = oam + line_sprites[i] * 4;
+
+		int y = scanline - (sprite[0] - 16);
+		int x_pos = sprite[1] - 8;
+
+		uint8_t tile_num = tall ? sprite[2] & 0xFE : sprite[2];
+		uint8_t attr = sprite[3];
+
+		if (CPU::get_bit(attr, 6))
+			y = (tall ? 15 : 7) - y;
+
+		const uint8_t* row = tile_cache.row(tile_num + (y >> 3), y & 7, CPU::get_bit(attr, 5));
+		const uint8_t* palette = shades[CPU::get_bit(attr, 4) ? OBP1 : OBP0];
+
+		for (int x = 0; x < 8; x++) {
+			int pixel = x_pos + x;
+			if (row[x] == 0 || pixel < 0 || pixel >= SCREEN_WIDTH)
+				continue;
+
+			line[pixel] = palette[row[x]];
+		}
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <video/tilecache.h>
+
+#define VRAM 0x8000
+#define VRAM_SIZE 0x2000
+#define SPRITE_ATTR 0xFE00
+#define OAM_SIZE 0xA0
+
+#define MAX_LINE_SPRITES 10
+
+#define SCREEN_WIDTH 160
+#define SCREEN_HEIGHT 144
+
+// Registers a scanline is drawn from
+struct ScanlineState {
+	uint8_t ly, lcdc, scx, scy, wx, wy, bgp, obp0, obp1;
+};
+
+// OAM search for one line, the first 10 sprites on it in OAM order, sorted so the winning sprite comes first
+int select_sprites(const uint8_t* oam, uint8_t scanline, bool tall, uint8_t* sprites);
+
+enum Palette {
+	BGP,
+	OBP0,
+	OBP1
+};
+
+// Draws scanlines into a frame of shade indices from a VRAM and OAM image, the PPU's own or a render thread copy
+class Renderer {
+public:
+	void init(const uint8_t* _vram, const uint8_t* _oam);
+
+	void draw_line(const ScanlineState& state, uint8_t* frame);
+
+	static uint8_t get_shade(uint8_t value, uint8_t palette) { return (palette >> (2 * value)) & 3; }
+
+private:
+	void update_palettes(const ScanlineState& state);
+	void draw_tiles(const ScanlineState& state, uint8_t* line);
+	void draw_sprites(const ScanlineState& state, uint8_t* line); // Sprites picked by select_sprites
+
+public:
+	TileCache tile_cache;
+
+	uint8_t line_sprites[MAX_LINE_SPRITES] = {}; // OAM indices, highest priority first
+	int sprite_count = 0;
+
+	// Shade for each colour index, rebuilt when the register value changes, 0 maps everything to shade 0
+	uint8_t palette_values[3] = {};
+	uint8_t shades[3][4] = {};
+
+private:
+	const uint8_t* vram = nullptr; // 0x8000-0x9FFF
+	const uint8_t* oam = nullptr; // 0xFE00-0xFE9F
+};
@@ -0,0 +1,122 @@
+#include "renderthread.h"
+#include <chrono>
+#include <cstring>
+
+RenderThread::~RenderThread()
+{
+	stop();
+}
+
+void RenderThread::start(const uint8_t* memory, const uint8_t* frame)
+{
+	if (running()) return;
+
+	memcpy(vram, memory + VRAM, VRAM_SIZE);
+	memcpy(oam, memory + SPRITE_ATTR, OAM_SIZE);
+	renderer.init(vram, oam);
+
+	if (!queue) queue.reset(new RenderCommand[QUEUE_SIZE]);
+	if (!frames) frames.reset(new uint8_t[FRAME_SIZE * 4]);
+	for (int i = 0; i < 4; i++)
+		memcpy(frames.get() + i * FRAME_SIZE, frame, FRAME_SIZE);
+
+	head = tail = 0;
+	shared = 1;
+	back = 0; front = 2;
+	stopping = false;
+
+	thread = std::thread(&RenderThread::run, this);
+}
+
+void RenderThread::restore(const uint8_t* memory, const uint8_t* frame)
+{
+	sync(); // Sits idle once the queue is drawn, so its copies can be set in place
+
+	renderer.tile_cache.invalidate_changed(memory + TILE_DATA);
+	memcpy(vram, memory + VRAM, VRAM_SIZE);
+	memcpy(oam, memory + SPRITE_ATTR, OAM_SIZE);
+
+	// Only the work frame, latest() may be handing a triple buffer slot to the display right now
+	memcpy(frames.get(), frame, FRAME_SIZE);
+}
+
+void RenderThread::stop()
+{
+	if (!thread.joinable()) return;
+
+	sync();
+	stopping = true;
+	thread.join();
+}
+
+void RenderThread::sync()
+{
+	while (tail.load(std::memory_order_acquire) != head.load(std::memory_order_relaxed))
+		std::this_thread::yield();
+}
+
+const uint8_t* RenderThread::latest()
+{
+	if (shared.load(std::memory_order_relaxed) & FRESH)
+		front = shared.exchange(front, std::memory_order_acq_rel) & ~FRESH;
+
+	return slot(front);
+}
+
+void RenderThread::push(const RenderCommand& command)
+{
+	uint32_t index = head.load(std::memory_order_relaxed);
+
+	// Full, the render thread is a whole queue behind
+	while (index - tail.load(std::memory_order_acquire) == QUEUE_SIZE)
+		std::this_thread::yield();
+
+	queue[index & (QUEUE_SIZE - 1)] = command;
+	head.store(index + 1, std::memory_order_release);
+}
+
+void RenderThread::run()
+{
+	uint8_t* work = frames.get();
+	int idle = 0;
+
+	for (;;) {
+		uint32_t index = tail.load(std::memory_order_relaxed);
+		uint32_t end = head.load(std::memory_order_acquire);
+
+		if (index == end) {
+			if (stopping) return;
+
+			// Stay responsive while the emulation runs, back off while it is paused
+			if (++idle < 1024) std::this_thread::yield();
+			else std::this_thread::sleep_for(std::chrono::microseconds(500));
+			continue;
+		}
+
+		idle = 0;
+
+		for (; index != end; index++) {
+			const RenderCommand& command = queue[index & (QUEUE_SIZE - 1)];
+
+			if (command.type == RenderCommand::Write) {
+				if (command.address >= SPRITE_ATTR) {
+					oam[command.address - SPRITE_ATTR] = command.data;
+				}
+				else {
+					vram[command.address - VRAM] = command.data;
+					if (TileCache::covers(command.address)) renderer.tile_cache.on_write(command.address);
+				}
+			}
+			else if (command.type == RenderCommand::Line) {
+				renderer.draw_line(command.state, work);
+			}
+			else {
+				// Lines the LCD skipped keep what the last frame had, like the PPU's own frame
+				memcpy(slot(back), work, FRAME_SIZE);
+				back = shared.exchange(back | FRESH, std::memory_order_acq_rel) & ~FRESH;
+			}
+		}
+
+		tail.store(index, std::memory_order_release);
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <video/renderer.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+// One entry of the emulation to render thread queue
+struct RenderCommand {
+	enum Type : uint8_t { Write, Line, Frame };
+
+	Type type;
+	uint8_t data; // Write
+	uint16_t address; // Write, VRAM or OAM
+	ScanlineState state; // Line
+};
+
+// Draws scanlines on its own thread from register snapshots and VRAM/OAM writes the emulation thread queues,
+// finished frames are handed back through a triple buffer
+class RenderThread {
+public:
+	~RenderThread();
+
+	void start(const uint8_t* memory, const uint8_t* frame); // Copies VRAM and OAM out of the 64K address space, drawing carries on over frame
+	void restore(const uint8_t* memory, const uint8_t* frame); // Same for a running thread after a state load, finished frames stay until it draws the next
+	void stop(); // Draws everything queued first
+	bool running() const { return thread.joinable(); }
+
+	// Emulation thread
+	void write(uint16_t address, uint8_t data) { push({ RenderCommand::Write, data, address, {} }); }
+	void line(const ScanlineState& state) { push({ RenderCommand::Line, 0, 0, state }); }
+	void frame_done() { push({ RenderCommand::Frame, 0, 0, {} }); }
+	void sync(); // Waits until every queued command is drawn
+
+	// Frontend thread, the newest finished frame, stays valid until the next call
+	const uint8_t* latest();
+
+	const uint8_t* work_frame() const { return frames.get(); } // The frame being drawn, only safe while stopped
+
+	static constexpr uint32_t QUEUE_SIZE = 1 << 14; // Power of two
+	static constexpr int FRAME_SIZE = SCREEN_WIDTH * SCREEN_HEIGHT;
+
+private:
+	void push(const RenderCommand& command);
+	void run();
+
+	uint8_t* slot(int index) { return frames.get() + (index + 1) * FRAME_SIZE; }
+
+private:
+	std::unique_ptr<RenderCommand[]> queue;
+	alignas(64) std::atomic<uint32_t> head{ 0 }; // Next free entry, only moved by the emulation thread
+	alignas(64) std::atomic<uint32_t> tail{ 0 }; // Next entry to draw, only moved by the render thread
+	std::atomic<bool> stopping{ false };
+
+	uint8_t vram[VRAM_SIZE] = {};
+	uint8_t oam[OAM_SIZE] = {};
+	Renderer renderer;
+
+	// Work frame, then the three triple buffer slots
+	std::unique_ptr<uint8_t[]> frames;
+	static constexpr uint8_t FRESH = 4; // Set on the shared slot when it holds a frame latest() has not taken
+	std::atomic<uint8_t> shared{ 1 };
+	uint8_t back = 0, front = 2;
+
+	std::thread thread;
+};
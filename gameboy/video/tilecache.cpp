@@ -0,0 +1,32 @@
+#include "tilecache.h"
+#include "bitplane.h"
+#include <cstring>
+
+void TileCache::init(const uint8_t* _vram)
+{
+	vram = _vram;
+	invalidate();
+}
+
+void TileCache::invalidate()
+{
+	memset(dirty, true, sizeof(dirty));
+}
+
+void TileCache::invalidate_changed(const uint8_t* data)
+{
+	for (int tile = 0; tile < TILE_COUNT; tile++) {
+		if (memcmp(vram + tile * 16, data + tile * 16, 16) != 0)
+			dirty[tile] = true;
+	}
+}
+
+void TileCache::decode(uint16_t tile)
+{
+	const uint8_t* data = vram + tile * 16;
+
+	decode_tile(data, pixels[0][tile][0], false);
+	decode_tile(data, pixels[1][tile][0], true);
+
+	dirty[tile] = false;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+
+#define TILE_DATA 0x8000
+#define TILE_DATA_END 0x9800
+#define TILE_COUNT 384
+
+// Tile data decoded to one colour index (0-3) per pixel, tiles are decoded again on first use after a VRAM write
+class TileCache {
+public:
+	void init(const uint8_t* _vram);
+	void invalidate(); // Everything is decoded again, for changes that bypass on_write
+	void invalidate_changed(const uint8_t* data); // Only tiles that differ from data, before it replaces the tile data
+
+	static bool covers(uint16_t addr) { return addr >= TILE_DATA && addr < TILE_DATA_END; }
+	void on_write(uint16_t addr) { dirty[(addr - TILE_DATA) >> 4] = true; }
+
+	// 8 colour indices, leftmost pixel first, or rightmost first when flipped
+	const uint8_t* row(uint16_t tile, uint8_t y, bool flip = false)
+	{
+		if (dirty[tile]) decode(tile);
+		return pixels[flip][tile][y];
+	}
+
+private:
+	void decode(uint16_t tile);
+
+private:
+	const uint8_t* vram = nullptr; // Tile data at 0x8000
+	uint8_t pixels[2][TILE_COUNT][8][8] = {}; // Plain and horizontally flipped
+	bool dirty[TILE_COUNT] = {};
+};
@@ -1,7 +1,10 @@
 #include "window.h"
+#include <imgui/imgui_textcolor.h>
 
 using sf::Keyboard;
 
+std::vector<std::string> Window::hex_str;
+
 Window::Window(int _width, int _height, const std::string& name, GameBoy* _gb)
 {
 	width = _width; height = _height;
@@ -17,6 +20,16 @@ Window::Window(int _width, int _height, const std::string& name, GameBoy* _gb)
 
 	window->setIcon(icon.getSize().x, icon.getSize().y, icon.getPixelsPtr());
 
+	pixels.resize(SCREEN_WIDTH * SCREEN_HEIGHT);
+
+	frame_buffer.create(SCREEN_WIDTH, SCREEN_HEIGHT);
+	viewport = sf::Sprite(frame_buffer);
+	viewport.setScale(3.5, 3.5);
+
+	gb->on_log = [this](const char* message) { logger.log("%s", message); };
+
+	for (int i = 0; i <= 0xFFFF; i++) hex_str.push_back(to_hex_string(i));
+
 	/*ImGui::SFML::Init(*window, false);
 
 	ImGuiIO& io = ImGui::GetIO();
@@ -52,6 +65,40 @@ void Window::update()
 				code == Keyboard::Left || code == Keyboard::Right) {
 				gb->joypad.key_pressed(map_key(code));
 			}
+			else if (code == Keyboard::L) {
+				gb->cpu.set_tracing(!gb->cpu.tracing);
+			}
+			else if (code == Keyboard::F5) {
+				quick_save();
+			}
+			else if (code == Keyboard::F8) {
+				quick_load();
+			}
+			else if (code == Keyboard::BackSpace) {
+				gb->rewinding = true;
+			}
+			else {
+				if (code == Keyboard::F1)
+					next_cpu_mode();
+				else if (code == Keyboard::F2)
+					gb->ppu.set_backend(gb->ppu.backend == PPUBackend::Scanline ? PPUBackend::Fifo : PPUBackend::Scanline);
+				else if (code == Keyboard::F3)
+					gb->ppu.set_threaded(!gb->ppu.render_thread.running());
+				else if (code == Keyboard::F4)
+					next_color_scheme();
+				else if (code == Keyboard::F6)
+					record_movie();
+				else if (code == Keyboard::F7)
+					play_movie();
+				else if (code == Keyboard::F9)
+					gb->rewind.budget = gb->rewind.budget ? 0 : REWIND_BUDGET;
+				else if (code == Keyboard::PageUp && gb->run_ahead < MAX_RUN_AHEAD)
+					gb->run_ahead++;
+				else if (code == Keyboard::PageDown && gb->run_ahead)
+					gb->run_ahead--;
+
+				interval = 100; // Shows the change in the title right away
+			}
 		}
 		else if (event.type == sf::Event::KeyReleased) {
 			Keyboard::Key code = event.key.code;
@@ -61,6 +108,9 @@ void Window::update()
 				code == Keyboard::Left || code == Keyboard::Right) {
 				gb->joypad.key_released(map_key(code));
 			}
+			else if (code == Keyboard::BackSpace) {
+				gb->rewinding = false;
+			}
 		}
 	}
 
@@ -75,7 +125,7 @@ void Window::update()
 	ImGui::PopFont();*/
 
 	if (interval >= 100) {
-		std::string title = "Gameboy Emualator FPS: " + std::to_string((int)(1000.0f / get_deltatime()));
+		std::string title = "Gameboy Emualator FPS: " + std::to_string((int)(1000.0f / get_deltatime())) + " | " + status();
 		window->setTitle(title);
 		interval = 0;
 	}
@@ -86,12 +136,167 @@ void Window::update()
 
 void Window::render()
 {
+	gb->expand_frame(pixels.data());
+	frame_buffer.update(reinterpret_cast<const sf::Uint8*>(pixels.data()));
+
 	window->clear(sf::Color::Black);
-	window->draw(gb->viewport);
+	window->draw(viewport);
 	//ImGui::SFML::Render(*window);
 	window->display();
 }
 
+void Window::cpu_stats()
+{
+	gb->cpu.resolve_flags();
+
+	bool n = gb->cpu.get_flag(N), z = gb->cpu.get_flag(Z), 
+		 h = gb->cpu.get_flag(H), c = gb->cpu.get_flag(C);
+	
+	ImGui::Begin("CPU-Info");
+	
+	ImVec2 size = ImGui::GetWindowSize();
+
+	NEWLINE;
+	std::string dashes = std::string(12, '-');
+	ImGui::Text("    %s %s %s", dashes.c_str(), "Flags", dashes.c_str());
+
+	NEWLINE;
+	ImGui::Text("       N:"); NO_NEWLINE;
+	ImGui::TextAnsiColored(n ? YELLOW : WHITE, "%d", n); NO_NEWLINE;
+	ImGui::Text("   Z:"); NO_NEWLINE;
+	ImGui::TextAnsiColored(z ? YELLOW : WHITE, "%d", z); NO_NEWLINE;
+	ImGui::Text("   H:"); NO_NEWLINE;
+	ImGui::TextAnsiColored(h ? YELLOW : WHITE, "%d", h); NO_NEWLINE;
+	ImGui::Text("   C:"); NO_NEWLINE;
+	ImGui::TextAnsiColored(c ? YELLOW : WHITE, "%d", c); NEWLINE;
+	
+	ImGui::Text("   %s %s %s", dashes.c_str(), "Registers", dashes.c_str());
+
+	NEWLINE;
+	ImGui::Text("       B: %s      C: %s", hex_str[gb->cpu.bc.h].c_str(), hex_str[gb->cpu.bc.l].c_str());
+	ImGui::Text("       D: %s      E: %s", hex_str[gb->cpu.de.h].c_str(), hex_str[gb->cpu.de.l].c_str());
+	ImGui::Text("       H: %s      L: %s", hex_str[gb->cpu.hl.h].c_str(), hex_str[gb->cpu.hl.l].c_str());
+	ImGui::Text("       A: %s      F: %s", hex_str[gb->cpu.af.h].c_str(), hex_str[gb->cpu.af.l].c_str());
+	
+	NEWLINE;
+	ImGui::Text("       Program Counter: %s", hex_str[gb->cpu.pc].c_str());
+	ImGui::Text("       Stack Pointer:   %s", hex_str[gb->cpu.sp].c_str());
+
+	NEWLINE;
+	ImGui::Text("       Opcode:   %s ", hex_str[gb->cpu.opcode].c_str());
+	ImGui::Text("       Mnemonic: %s", gb->cpu.mnemonic(gb->cpu.opcode));
+	
+	ImGui::End();
+}
+
+void Window::memory_map(uint16_t from, uint16_t to, uint8_t step)
+{
+	ImGui::Begin("Memory");
+
+	ImVec2 size = ImGui::GetWindowSize();
+
+	if (gb->mmu.read(BOOTING)) {
+		ImGui::Text("Address");
+		ImGui::Text("%s", std::string(40, '-').c_str());
+		
+		std::string line = "";
+		for (int i = from; i <= to; i++) {
+			if (i == 0) {
+				line += "0x0000 | ";
+			}
+			else if ((i - from) % step == 0) {
+				ImGui::Text(line.c_str());
+				line.clear();
+				line += hex_str[i] + " | ";
+			}
+
+			line += hex_str[gb->mmu.read(i)] + ' ';
+		}
+	}
+
+	ImGui::End();
+}
+
+void Window::display_viewport()
+{
+	ImGui::Begin("Viewport");
+
+	ImVec2 pos = ImGui::GetCursorScreenPos();
+	uint32_t tex = viewport.getTexture()->getNativeHandle();
+
+	ImVec2 size = ImGui::GetWindowSize();
+	size.y -= 46;
+
+	ImGui::Image(tex, size, ImVec2(0, 0), ImVec2(1, 1));
+	ImGui::End();
+}
+
+void Window::dockspace(std::function<void()> menu_func)
+{
+	ImGuiDockNodeFlags dockspace_flags = ImGuiDockNodeFlags_None;
+
+	ImGuiWindowFlags window_flags = ImGuiWindowFlags_MenuBar | ImGuiWindowFlags_NoDocking;
+	ImGuiViewport* viewport = ImGui::GetMainViewport();
+	ImGui::SetNextWindowPos(viewport->Pos);
+	ImGui::SetNextWindowSize(viewport->Size);
+	ImGui::SetNextWindowViewport(viewport->ID);
+	ImGui::PushStyleVar(ImGuiStyleVar_WindowRounding, 0.0f);
+	ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.0f);
+	window_flags |= ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove;
+	window_flags |= ImGuiWindowFlags_NoBringToFrontOnFocus | ImGuiWindowFlags_NoNavFocus;
+
+	if (dockspace_flags & ImGuiDockNodeFlags_PassthruCentralNode)
+		window_flags |= ImGuiWindowFlags_NoBackground;
+
+	ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0f, 0.0f));
+	ImGui::Begin("DockSpace Demo", &bool_ptr, window_flags);
+	ImGui::PopStyleVar();
+	ImGui::PopStyleVar(2);
+
+	// DockSpace
+	ImGuiID dockspace_id = ImGui::GetID("MyDockSpace");
+	ImGui::DockSpace(dockspace_id, ImVec2(0.0f, 0.0f), dockspace_flags);
+
+	menu_func();
+
+	ImGui::End();
+}
+
+void Window::log()
+{
+	logger.draw();
+}
+
+void Window::menu_function()
+{
+	ImGuiDockNodeFlags dockspace_flags = ImGuiDockNodeFlags_None;
+	
+	if (ImGui::BeginMenuBar()) {
+		if (ImGui::BeginMenu("File")) {
+			if (ImGui::MenuItem("Load Rom", "  Loads rom file")) {
+				file_dialog_opened = true;
+			}
+			ImGui::EndMenu();
+		}
+		ImGui::EndMenuBar();
+	}
+
+	if (file_dialog_opened) {
+		file.open_dialog();
+		bool done = file.draw();
+
+		file_dialog_opened = !done;
+		if (file_dialog_opened == false) {
+			if (!file.selected().empty()) {
+				gb->load_rom(file.selected()[0]);
+
+				gb->rom_loaded = true;
+				if (gb->mmu.read(BOOTING)) gb->cpu.reset();
+			}
+		}
+	}
+}
+
 double Window::get_deltatime()
 {
 	return delta_time.count();
@@ -102,6 +307,81 @@ bool Window::should_close()
 	return !window->isOpen();
 }
 
+void Window::quick_save()
+{
+	if (!gb->rom_loaded) return;
+
+	if (!quick_state) quick_state = std::make_unique<SaveState>();
+	gb->save_state(*quick_state);
+}
+
+void Window::quick_load()
+{
+	if (quick_state && !gb->load_state(*quick_state))
+		gb->log("Quick save is from another rom\n");
+}
+
+void Window::record_movie()
+{
+	Movie& movie = gb->movie;
+	if (!gb->rom_loaded) return;
+
+	if (movie.mode != MovieMode::Recording) {
+		movie.record(*gb);
+		return;
+	}
+
+	movie.stop();
+	if (!movie.save(MOVIE_FILE)) gb->log("Cannot write %s\n", MOVIE_FILE);
+}
+
+void Window::play_movie(const std::string& path)
+{
+	if (!gb->rom_loaded) return;
+
+	if (!gb->movie.load(path) || !gb->movie.play(*gb))
+		gb->log("%s is not a movie of this rom\n", path.c_str());
+}
+
+void Window::next_cpu_mode()
+{
+	if (!gb->cpu.dynarec.supported()) return;
+
+	int mode = ((int)gb->cpu.dynarec.mode + 1) % 3;
+	gb->cpu.dynarec.set_mode((DynarecMode)mode);
+}
+
+void Window::next_color_scheme()
+{
+	ColorScheme scheme = ColorScheme::Greyscale;
+	if (gb->ppu.color_scheme == ColorScheme::Greyscale)
+		scheme = ColorScheme::Green;
+	else if (gb->ppu.color_scheme == ColorScheme::Green && custom_colors.size() == 4)
+		scheme = ColorScheme::Custom;
+
+	if (scheme == ColorScheme::Custom)
+		std::copy(custom_colors.begin(), custom_colors.end(), gb->ppu.colors);
+
+	gb->ppu.set_color_scheme(scheme);
+}
+
+std::string Window::status()
+{
+	static const char* cpu_modes[] = { "Interpreter", "Dynarec", "Dynarec (differential)" };
+	static const char* schemes[] = { "Greyscale", "DMG Green", "Custom" };
+
+	std::string text = cpu_modes[(int)gb->cpu.dynarec.mode];
+	text += gb->ppu.backend == PPUBackend::Fifo ? ", Pixel FIFO" : gb->ppu.render_thread.running() ? ", Render Thread" : ", Scanline";
+	text += std::string(", ") + schemes[(int)gb->ppu.color_scheme];
+
+	if (gb->run_ahead) text += ", Run Ahead " + S(gb->run_ahead);
+	if (gb->rewind.budget) text += ", Rewind";
+	if (gb->movie.mode == MovieMode::Recording) text += ", Recording";
+	else if (gb->movie.mode == MovieMode::Playing) text += ", Playing";
+
+	return text;
+}
+
 Key Window::map_key(sf::Keyboard::Key key)
 {
 	if (key == sf::Keyboard::A)
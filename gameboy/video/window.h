@@ -4,6 +4,8 @@
 
 #include <imgui.h>
 #include <imgui-SFML.h>
+#include <imgui_file.h>
+#include <logger.h>
 
 #include <string>
 #include <iostream>
@@ -14,7 +16,21 @@ using std::unique_ptr;
 using namespace std::chrono;
 using dmilliseconds = duration<double, std::milli>;
 
+#define NO_NEWLINE ImGui::SameLine()
+#define NEWLINE ImGui::NewLine()
+
+#define RED ImVec4(255, 0, 0, 255)
+#define YELLOW ImVec4(255, 255, 0, 255)
+#define WHITE ImVec4(255, 255, 255, 255)
+#define BLACK ImVec4(0, 0, 0, 255)
+
+#define REWIND_BUDGET (size_t(64) << 20) // Bytes, a minute or more of play at typical delta sizes
+#define MOVIE_FILE "movie.gbm"
+#define MAX_RUN_AHEAD 4
+
 class GameBoy;
+
+// SFML and ImGui frontend on top of the emulation core
 class Window {
 public:
 	Window(int width, int height, const std::string& name, GameBoy* _gb);
@@ -28,10 +44,42 @@ public:
 
 	Key map_key(sf::Keyboard::Key key);
 
+	void cpu_stats();
+	void memory_map(uint16_t from, uint16_t to, uint8_t step);
+	void dockspace(std::function<void()> menu_func);
+
+	void log();
+	void menu_function();
+
+	void display_viewport();
+
+	void quick_save(); // F5
+	void quick_load(); // F8, back to the last quick save
+	void record_movie(); // F6, again stops and writes MOVIE_FILE
+	void play_movie(const std::string& path = MOVIE_FILE); // F7
+	void next_cpu_mode(); // F1, interpreter, dynarec, differential dynarec
+	void next_color_scheme(); // F4, greyscale, DMG green, then custom_colors when given
+
+	std::string status(); // The settings the keys change, shown in the title
+
 public:
 	unique_ptr<sf::RenderWindow> window;
 	GameBoy* gb;
 
+	std::vector<uint32_t> pixels; // RGBA copy of the frame, uploaded to frame_buffer
+	sf::Texture frame_buffer;
+	sf::Sprite viewport;
+
+	unique_ptr<SaveState> quick_state;
+	std::vector<uint32_t> custom_colors; // Four RGBA shades, lightest first, or none
+
+	FileDialog file;
+	Logger logger;
+
+	static std::vector<std::string> hex_str;
+	bool bool_ptr = true;
+	bool file_dialog_opened = false;
+
 	system_clock clock;
 	system_clock::time_point previous, now;
 	dmilliseconds delta_time;